@@ -0,0 +1,384 @@
+#include "APU.h"
+
+#include <algorithm>
+#include <initializer_list>
+
+#include "Memory.h"
+
+namespace gb {
+
+namespace {
+
+// Bits read back as set in FF10-FF2F, write-only and unused ones included
+const Byte read_masks[0x20] = {
+    0x80, 0x3F, 0x00, 0xFF, 0xBF, 0xFF, 0x3F, 0x00, 0xFF, 0xBF, 0x7F,
+    0xFF, 0x9F, 0xFF, 0xBF, 0xFF, 0xFF, 0x00, 0x00, 0xBF, 0x00, 0x00,
+    0x70, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+const Byte duties[4] = {0x01, 0x81, 0x87, 0x7E};
+
+const int noise_divisors[8] = {8, 16, 32, 48, 64, 80, 96, 112};
+
+// Square and wave tones above this many clocks per step are well past the
+// output Nyquist frequency and are left silent
+const int min_periods[4] = {24, 24, 8, 0};
+
+}  // namespace
+
+APU::APU(Memory& memory) : memory_(memory), state_(memory.machine().apu) {
+  memory_.registerHandler(this);
+}
+
+APU::~APU() { memory_.unregisterHandler(this); }
+
+void APU::resync() {
+  time_ = memory_.cycles();
+  frame_start_ = time_;
+}
+
+void APU::setSampleRate(int rate) {
+  // The channels keep their timing up to the switch
+  run(memory_.cycles());
+  sample_rate_ = rate;
+  left_.clear();
+  right_.clear();
+  left_.setRates(clock_rate, rate);
+  right_.setRates(clock_rate, rate);
+  left_levels_.fill(0);
+  right_levels_.fill(0);
+  frame_start_ = time_;
+}
+
+void APU::tuneSampleRate(double rate) {
+  left_.setRates(clock_rate, rate);
+  right_.setRates(clock_rate, rate);
+}
+
+void APU::endFrame() {
+  uint64_t now = memory_.cycles();
+  run(now);
+  if (sample_rate_ && synthesis_) {
+    uint32_t duration = static_cast<uint32_t>(now - frame_start_);
+    left_.endFrame(duration);
+    right_.endFrame(duration);
+  }
+  frame_start_ = now;
+}
+
+std::size_t APU::readSamples(int16_t* out, std::size_t count) {
+  right_.readSamples(out + 1, count, 2);
+  return left_.readSamples(out, count, 2);
+}
+
+bool APU::handlesAddress(Word address) const {
+  return address >= Register::Nr10 && address < Register::End;
+}
+
+Byte APU::read(Word address) {
+  if (address >= Register::WaveRam) {
+    return reg(address);
+  }
+
+  Byte byte = reg(address) | read_masks[address - Register::Nr10];
+  if (address == Register::Nr52) {
+    byte &= 0xF0;
+    for (int i = 0; i < 4; i++) {
+      byte |= state_.channels[i].enabled << i;
+    }
+  }
+  return byte;
+}
+
+void APU::write(Word address, Byte byte) {
+  // Only the wave RAM and the power switch work while powered off
+  if (!powered() && address != Register::Nr52 &&
+      address < Register::WaveRam) {
+    return;
+  }
+
+  run(memory_.cycles());
+  memory_.io()[address - 0xFF00] = byte;
+
+  if (address == Register::Nr52) {
+    if (!(byte & 0x80)) {
+      powerOff();
+    }
+    return;
+  } else if (address >= Register::Nr50) {
+    // Panning and master volume changes show up in the next output
+    return;
+  }
+
+  int channel = (address - Register::Nr10) / 5;
+  switch ((address - Register::Nr10) % 5) {
+    case 1:
+      state_.channels[channel].length =
+          (channel == 2 ? 256 : 64) - (channel == 2 ? byte : byte & 0x3F);
+      break;
+    case 0:
+    case 2:
+      if (!dacEnabled(channel)) {
+        state_.channels[channel].enabled = 0;
+      }
+      break;
+    case 4:
+      if (byte & 0x80) {
+        trigger(channel);
+      }
+      break;
+  }
+}
+
+Byte APU::reg(Word address) const {
+  return memory_.io()[address - 0xFF00];
+}
+
+bool APU::dacEnabled(int channel) const {
+  if (channel == 2) {
+    return reg(Register::Nr30) & 0x80;
+  }
+  return channelReg(channel, 2) & 0xF8;
+}
+
+int APU::frequency(int channel) const {
+  return channelReg(channel, 3) | ((channelReg(channel, 4) & 0x07) << 8);
+}
+
+int APU::period(int channel) const {
+  switch (channel) {
+    case 0:
+    case 1:
+      return (2048 - frequency(channel)) * 4;
+    case 2:
+      return (2048 - frequency(channel)) * 2;
+    default: {
+      Byte nr43 = reg(Register::Nr43);
+      return noise_divisors[nr43 & 0x07] << (nr43 >> 4);
+    }
+  }
+}
+
+int APU::level(int channel) const {
+  const Channel& state = state_.channels[channel];
+  if (!state.enabled) {
+    return 0;
+  }
+
+  switch (channel) {
+    case 0:
+    case 1: {
+      Byte duty = duties[channelReg(channel, 1) >> 6];
+      return (duty >> state.position) & 1 ? state.volume : 0;
+    }
+    case 2: {
+      int code = (reg(Register::Nr32) >> 5) & 0x03;
+      if (code == 0) {
+        return 0;
+      }
+      Byte sample = reg(Register::WaveRam + state.position / 2);
+      sample = state.position % 2 ? sample & 0x0F : sample >> 4;
+      return sample >> (code - 1);
+    }
+    default:
+      return state.lfsr & 1 ? 0 : state.volume;
+  }
+}
+
+void APU::sequence() {
+  state_.sequencer_timing -= sequencer_period;
+  if (!powered()) {
+    return;
+  }
+  run(memory_.cycles() - state_.sequencer_timing);
+
+  // Length counters at 256Hz
+  if (state_.sequencer_step % 2 == 0) {
+    for (int i = 0; i < 4; i++) {
+      Channel& channel = state_.channels[i];
+      if ((channelReg(i, 4) & 0x40) && channel.length > 0 &&
+          --channel.length == 0) {
+        channel.enabled = 0;
+      }
+    }
+  }
+
+  // Frequency sweep at 128Hz
+  if (state_.sequencer_step == 2 || state_.sequencer_step == 6) {
+    Channel& channel = state_.channels[0];
+    if (channel.sweep_timer > 0 && --channel.sweep_timer == 0) {
+      Byte nr10 = reg(Register::Nr10);
+      int sweep_period = (nr10 >> 4) & 0x07;
+      channel.sweep_timer = sweep_period ? sweep_period : 8;
+      if (channel.sweep_enabled && sweep_period) {
+        int frequency = sweepFrequency();
+        if (frequency <= 2047 && (nr10 & 0x07)) {
+          channel.shadow_frequency = frequency;
+          memory_.io()[Register::Nr13 - 0xFF00] = frequency & 0xFF;
+          Byte& nr14 = memory_.io()[Register::Nr14 - 0xFF00];
+          nr14 = (nr14 & 0xF8) | (frequency >> 8);
+          sweepFrequency();
+        }
+      }
+    }
+  }
+
+  // Volume envelopes at 64Hz
+  if (state_.sequencer_step == 7) {
+    for (int i : {0, 1, 3}) {
+      Channel& channel = state_.channels[i];
+      Byte envelope = channelReg(i, 2);
+      if (!(envelope & 0x07) || --channel.envelope_timer > 0) {
+        continue;
+      }
+      channel.envelope_timer = envelope & 0x07;
+      if (envelope & 0x08) {
+        channel.volume = std::min(channel.volume + 1, 15);
+      } else {
+        channel.volume = std::max(channel.volume - 1, 0);
+      }
+    }
+  }
+
+  state_.sequencer_step = (state_.sequencer_step + 1) % 8;
+}
+
+void APU::trigger(int channel) {
+  Channel& state = state_.channels[channel];
+  state.enabled = dacEnabled(channel);
+  if (state.length == 0) {
+    state.length = channel == 2 ? 256 : 64;
+  }
+  state.timer = period(channel);
+  state.position = 0;
+  state.lfsr = 0x7FFF;
+
+  Byte envelope = channelReg(channel, 2);
+  state.volume = envelope >> 4;
+  state.envelope_timer = envelope & 0x07;
+
+  if (channel == 0) {
+    Byte nr10 = reg(Register::Nr10);
+    int sweep_period = (nr10 >> 4) & 0x07;
+    state.shadow_frequency = frequency(0);
+    state.sweep_timer = sweep_period ? sweep_period : 8;
+    state.sweep_enabled = sweep_period || (nr10 & 0x07);
+    if (nr10 & 0x07) {
+      sweepFrequency();
+    }
+  }
+}
+
+void APU::powerOff() {
+  for (Word address = Register::Nr10; address < Register::Nr52; address++) {
+    memory_.io()[address - 0xFF00] = 0;
+  }
+  state_.channels.fill(Channel{});
+  state_.sequencer_step = 0;
+}
+
+// The next swept frequency, disabling the channel once it overflows
+int APU::sweepFrequency() {
+  Channel& channel = state_.channels[0];
+  Byte nr10 = reg(Register::Nr10);
+  int delta = channel.shadow_frequency >> (nr10 & 0x07);
+  int frequency = nr10 & 0x08 ? channel.shadow_frequency - delta
+                              : channel.shadow_frequency + delta;
+  if (frequency > 2047) {
+    channel.enabled = 0;
+  }
+  return frequency;
+}
+
+void APU::run(uint64_t now) {
+  if (now <= time_) {
+    return;
+  }
+  // The channels advance the same whether anyone listens or not, so the
+  // machine state does not depend on the host's audio settings
+  bool synthesise = sample_rate_ && synthesis_;
+  for (int i = 0; i < 4; i++) {
+    runChannel(i, time_, now, synthesise);
+  }
+  time_ = now;
+}
+
+void APU::runChannel(int channel, uint64_t from, uint64_t to,
+                     bool synthesise) {
+  Channel& state = state_.channels[channel];
+  int clocks = period(channel);
+  uint64_t time = from + state.timer;
+
+  if (synthesise) {
+    output(channel, from);
+  }
+  bool audible = state.enabled && clocks >= min_periods[channel] &&
+                 (channel == 2 || state.volume > 0);
+  // Only the noise channel's LFSR has to be stepped one by one
+  if (!audible || (!synthesise && channel != 3)) {
+    // Keep the waveform phase without synthesising the steps
+    if (time < to) {
+      // As many steps as the loop below takes while time < to
+      uint64_t steps = (to - time + clocks - 1) / clocks;
+      if (channel != 3) {
+        int length = channel == 2 ? 32 : 8;
+        state.position = (state.position + steps) % length;
+      }
+      time += steps * clocks;
+    }
+    state.timer = static_cast<int>(time - to);
+    return;
+  }
+
+  while (time < to) {
+    step(channel);
+    if (synthesise) {
+      output(channel, time);
+    }
+    time += clocks;
+  }
+  state.timer = static_cast<int>(time - to);
+}
+
+void APU::step(int channel) {
+  Channel& state = state_.channels[channel];
+  switch (channel) {
+    case 0:
+    case 1:
+      state.position = (state.position + 1) % 8;
+      break;
+    case 2:
+      state.position = (state.position + 1) % 32;
+      break;
+    default: {
+      int bit = (state.lfsr ^ (state.lfsr >> 1)) & 1;
+      state.lfsr = (state.lfsr >> 1) | (bit << 14);
+      if (reg(Register::Nr43) & 0x08) {
+        state.lfsr = (state.lfsr & ~0x40) | (bit << 6);
+      }
+      break;
+    }
+  }
+}
+
+void APU::output(int channel, uint64_t time) {
+  int value = level(channel);
+  Byte panning = reg(Register::Nr51);
+  Byte volume = reg(Register::Nr50);
+  int left = panning & (0x10 << channel)
+                 ? value * (((volume >> 4) & 0x07) + 1) * gain
+                 : 0;
+  int right =
+      panning & (0x01 << channel) ? value * ((volume & 0x07) + 1) * gain : 0;
+
+  uint32_t offset = static_cast<uint32_t>(time - frame_start_);
+  if (left != left_levels_[channel]) {
+    left_.addDelta(offset, left - left_levels_[channel]);
+    left_levels_[channel] = left;
+  }
+  if (right != right_levels_[channel]) {
+    right_.addDelta(offset, right - right_levels_[channel]);
+    right_levels_[channel] = right;
+  }
+}
+
+}  // namespace gb
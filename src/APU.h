@@ -0,0 +1,137 @@
+#ifndef GEEBEE_SRC_APU_H
+#define GEEBEE_SRC_APU_H
+
+#include <array>
+
+#include "BlipBuffer.h"
+#include "IOHandler.h"
+#include "MachineState.h"
+#include "types.h"
+
+namespace gb {
+
+class Memory;
+
+// The DMG sound hardware: two square channels (the first with a frequency
+// sweep), a wave channel and a noise channel. Channels are only updated on
+// register writes and frame sequencer events. In between, their output is
+// synthesised lazily, one amplitude change at a time, into band-limited
+// stereo buffers.
+class APU : public IOHandler {
+ public:
+  using Channel = MachineState::Channel;
+
+  static const int clock_rate = 4194304;
+
+  explicit APU(Memory& memory);
+  APU(const APU& apu) = delete;
+  APU(APU&& apu) = delete;
+  ~APU() override;
+  APU& operator=(const APU& apu) = delete;
+  APU& operator=(const APU&& apu) = delete;
+
+  // Restarts synthesis at the current clock, after the machine state was
+  // replaced under it.
+  void resync();
+
+  // Synthesises stereo samples at `rate` Hz, or nothing if it is 0, which
+  // is the default.
+  void setSampleRate(int rate);
+  int sampleRate() const { return sample_rate_; }
+  // Stretches the output to `rate` samples per emulated second without
+  // dropping anything buffered, for rate control against a sound card.
+  void tuneSampleRate(double rate);
+  // Frames run without synthesis only keep the channels' timing, for
+  // speculative frames whose sound must not be heard.
+  void setSynthesis(bool synthesis) { synthesis_ = synthesis; }
+
+  void advance(int timing) {
+    state_.sequencer_timing += timing;
+    if (state_.sequencer_timing >= sequencer_period) {
+      sequence();
+    }
+  }
+  // Makes the samples synthesised so far readable.
+  void endFrame();
+  // Stereo sample pairs ready to be read.
+  std::size_t samplesAvailable() const { return left_.samplesAvailable(); }
+  // Reads up to `count` interleaved left/right sample pairs.
+  std::size_t readSamples(int16_t* out, std::size_t count);
+  // Bytes of sample buffers held
+  std::size_t footprint() const {
+    return left_.footprint() + right_.footprint();
+  }
+
+  bool handlesAddress(Word address) const override;
+  Byte read(Word address) override;
+  void write(Word address, Byte byte) override;
+
+ private:
+  enum Register : Word {
+    Nr10 = 0xFF10,
+    Nr11 = 0xFF11,
+    Nr12 = 0xFF12,
+    Nr13 = 0xFF13,
+    Nr14 = 0xFF14,
+    Nr21 = 0xFF16,
+    Nr22 = 0xFF17,
+    Nr23 = 0xFF18,
+    Nr24 = 0xFF19,
+    Nr30 = 0xFF1A,
+    Nr31 = 0xFF1B,
+    Nr32 = 0xFF1C,
+    Nr33 = 0xFF1D,
+    Nr34 = 0xFF1E,
+    Nr41 = 0xFF20,
+    Nr42 = 0xFF21,
+    Nr43 = 0xFF22,
+    Nr44 = 0xFF23,
+    Nr50 = 0xFF24,
+    Nr51 = 0xFF25,
+    Nr52 = 0xFF26,
+    WaveRam = 0xFF30,
+    End = 0xFF40
+  };
+  static const int sequencer_period = 8192;
+  // Output level of one channel at full volume in both master volumes
+  static const int gain = 60;
+
+  Byte reg(Word address) const;
+  // Register `offset` (0-4) of `channel`, NRx0-NRx4
+  Byte channelReg(int channel, int offset) const {
+    return reg(Nr10 + channel * 5 + offset);
+  }
+  bool powered() const { return reg(Nr52) & 0x80; }
+  bool dacEnabled(int channel) const;
+  int frequency(int channel) const;
+  int period(int channel) const;
+  int level(int channel) const;
+
+  void sequence();
+  void trigger(int channel);
+  void powerOff();
+  int sweepFrequency();
+
+  // Synthesises every channel up to `now` clocks
+  void run(uint64_t now);
+  void runChannel(int channel, uint64_t from, uint64_t to, bool synthesise);
+  void step(int channel);
+  void output(int channel, uint64_t time);
+
+  Memory& memory_;
+
+  MachineState::Apu& state_;
+
+  int sample_rate_{0};
+  bool synthesis_{true};
+  uint64_t time_{0};
+  uint64_t frame_start_{0};
+  std::array<int, 4> left_levels_{};
+  std::array<int, 4> right_levels_{};
+  BlipBuffer left_;
+  BlipBuffer right_;
+};
+
+}  // namespace gb
+
+#endif
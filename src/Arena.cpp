@@ -0,0 +1,74 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace gb {
+
+namespace {
+
+thread_local Arena* current_arena = nullptr;
+
+// Every block is preceded by the heap allocation it lives in, or nullptr if
+// it belongs to an arena
+const std::size_t header = sizeof(void*);
+
+std::uintptr_t alignUp(std::uintptr_t address, std::size_t alignment) {
+  return (address + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+const std::size_t Arena::chunk_size;
+
+Arena::~Arena() = default;
+
+Arena* Arena::current() { return current_arena; }
+
+void* Arena::allocate(std::size_t size, std::size_t alignment) {
+  if (current_arena) {
+    void* block = current_arena->take(size, alignment);
+    static_cast<void**>(block)[-1] = nullptr;
+    return block;
+  }
+
+  void* memory = ::operator new(size + alignment + header);
+  std::uintptr_t block =
+      alignUp(reinterpret_cast<std::uintptr_t>(memory) + header, alignment);
+  reinterpret_cast<void**>(block)[-1] = memory;
+  return reinterpret_cast<void*>(block);
+}
+
+void Arena::deallocate(void* block) {
+  if (block) {
+    ::operator delete(static_cast<void**>(block)[-1]);
+  }
+}
+
+void* Arena::take(std::size_t size, std::size_t alignment) {
+  std::uintptr_t base =
+      chunks_.empty() ? 0
+                      : reinterpret_cast<std::uintptr_t>(chunks_.back().get());
+  std::uintptr_t block = alignUp(base + offset_ + header, alignment);
+  if (block + size > base + capacity_) {
+    // The chunk is left untouched here, its pages get placed by whoever
+    // writes to them first
+    capacity_ = std::max(chunk_size, size + alignment + header);
+    chunks_.emplace_back(new char[capacity_]);
+    reserved_ += capacity_;
+    base = reinterpret_cast<std::uintptr_t>(chunks_.back().get());
+    block = alignUp(base + header, alignment);
+  }
+  offset_ = block + size - base;
+  used_ += size;
+  return reinterpret_cast<void*>(block);
+}
+
+Arena::Scope::Scope(Arena* arena) : previous_(current_arena) {
+  current_arena = arena;
+}
+
+Arena::Scope::~Scope() { current_arena = previous_; }
+
+}  // namespace gb
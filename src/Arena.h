@@ -0,0 +1,69 @@
+#ifndef GEEBEE_SRC_ARENA_H
+#define GEEBEE_SRC_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace gb {
+
+// Hands out the memory of machines in large chunks. While a thread has an
+// arena installed, the big blocks of every machine it creates come out of
+// it back to back: a CPU sits next to its state block, thousands of machines
+// do not fragment the heap, and the pages are first touched, so placed by
+// the kernel, on the NUMA node of that thread.
+//
+// Freeing a block does not return it to the arena. Everything is released
+// at once when the arena goes away, so it has to outlive its machines.
+class Arena {
+ public:
+  static const std::size_t chunk_size = 1 << 20;
+
+  Arena() = default;
+  Arena(const Arena& arena) = delete;
+  Arena(Arena&& arena) = delete;
+  ~Arena();
+  Arena& operator=(const Arena& arena) = delete;
+  Arena& operator=(const Arena&& arena) = delete;
+
+  // Bytes handed out and bytes taken from the heap for them
+  std::size_t used() const { return used_; }
+  std::size_t reserved() const { return reserved_; }
+
+  // The arena installed on the calling thread, if any
+  static Arena* current();
+
+  // Allocates from the arena of the calling thread, or from the heap if it
+  // has none. Blocks start on an `alignment` boundary and are freed with
+  // deallocate().
+  static void* allocate(std::size_t size, std::size_t alignment);
+  static void deallocate(void* block);
+
+  // Installs an arena on the calling thread while it exists
+  class Scope {
+   public:
+    explicit Scope(Arena* arena);
+    Scope(const Scope& scope) = delete;
+    Scope(Scope&& scope) = delete;
+    ~Scope();
+    Scope& operator=(const Scope& scope) = delete;
+    Scope& operator=(const Scope&& scope) = delete;
+
+   private:
+    Arena* previous_;
+  };
+
+ private:
+  void* take(std::size_t size, std::size_t alignment);
+
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  // Size of the newest chunk and how much of it is taken
+  std::size_t capacity_{0};
+  std::size_t offset_{0};
+  std::size_t used_{0};
+  std::size_t reserved_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,52 @@
+#include "AudioRing.h"
+
+#include <algorithm>
+
+namespace gb {
+
+AudioRing::AudioRing(std::size_t frames) {
+  std::size_t capacity = 1;
+  while (capacity < frames) {
+    capacity <<= 1;
+  }
+  samples_.assign(capacity * 2, 0);
+  mask_ = capacity - 1;
+}
+
+std::size_t AudioRing::size() const {
+  return write_.load(std::memory_order_acquire) -
+         read_.load(std::memory_order_acquire);
+}
+
+std::size_t AudioRing::write(const int16_t* samples, std::size_t frames) {
+  std::size_t write = write_.load(std::memory_order_relaxed);
+  std::size_t read = read_.load(std::memory_order_acquire);
+  frames = std::min(frames, capacity() - (write - read));
+
+  // Copy in at most two pieces, before and after the wrap
+  std::size_t start = write & mask_;
+  std::size_t first = std::min(frames, capacity() - start);
+  std::copy(samples, samples + first * 2, samples_.begin() + start * 2);
+  std::copy(samples + first * 2, samples + frames * 2, samples_.begin());
+
+  write_.store(write + frames, std::memory_order_release);
+  return frames;
+}
+
+std::size_t AudioRing::read(int16_t* samples, std::size_t frames) {
+  std::size_t read = read_.load(std::memory_order_relaxed);
+  std::size_t write = write_.load(std::memory_order_acquire);
+  frames = std::min(frames, write - read);
+
+  std::size_t start = read & mask_;
+  std::size_t first = std::min(frames, capacity() - start);
+  std::copy(samples_.begin() + start * 2,
+            samples_.begin() + (start + first) * 2, samples);
+  std::copy(samples_.begin(), samples_.begin() + (frames - first) * 2,
+            samples + first * 2);
+
+  read_.store(read + frames, std::memory_order_release);
+  return frames;
+}
+
+}  // namespace gb
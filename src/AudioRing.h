@@ -0,0 +1,49 @@
+#ifndef GEEBEE_SRC_AUDIORING_H
+#define GEEBEE_SRC_AUDIORING_H
+
+#include <atomic>
+#include <vector>
+
+#include "types.h"
+
+namespace gb {
+
+// Lock-free ring of interleaved stereo samples between exactly one producer
+// (the emulation thread) and one consumer (the audio callback). Neither side
+// ever blocks or allocates.
+class AudioRing {
+ public:
+  // Holds at least `frames` stereo frames, rounded up to a power of two.
+  explicit AudioRing(std::size_t frames);
+  AudioRing(const AudioRing& ring) = delete;
+  AudioRing(AudioRing&& ring) = delete;
+  ~AudioRing() = default;
+  AudioRing& operator=(const AudioRing& ring) = delete;
+  AudioRing& operator=(const AudioRing&& ring) = delete;
+
+  std::size_t capacity() const { return mask_ + 1; }
+  // Frames ready to be read.
+  std::size_t size() const;
+
+  // Both return the number of frames actually copied.
+  std::size_t write(const int16_t* samples, std::size_t frames);
+  std::size_t read(int16_t* samples, std::size_t frames);
+
+ private:
+  static const std::size_t cache_line = 64;
+
+  std::vector<int16_t> samples_;
+  std::size_t mask_;
+
+  // The indices only ever grow, each one written by a single side. Padding
+  // keeps them off each other's cache line.
+  char padding0_[cache_line];
+  std::atomic<std::size_t> write_{0};
+  char padding1_[cache_line];
+  std::atomic<std::size_t> read_{0};
+  char padding2_[cache_line];
+};
+
+}  // namespace gb
+
+#endif
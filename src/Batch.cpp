@@ -0,0 +1,193 @@
+#include "Batch.h"
+
+#include <chrono>
+#include <exception>
+
+#include "Arena.h"
+#include "CPU.h"
+#include "Capture.h"
+#include "Profiler.h"
+#include "Timeline.h"
+#include "Program.h"
+
+namespace gb {
+
+struct Batch::Session {
+  Session(std::shared_ptr<const Program> program, Job job, Capture* capture,
+          Profiler* profiler)
+      : program(std::move(program)),
+        job(std::move(job)),
+        capture(capture),
+        profiler(profiler) {}
+
+  std::shared_ptr<const Program> program;
+  Job job;
+  Capture* capture{nullptr};
+  Profiler* profiler{nullptr};
+  Window window;
+  std::unique_ptr<CPU> cpu;
+  StateHasher hasher;
+  Result result;
+};
+
+Batch::Job Batch::Job::runFrames(long frames) {
+  Job job;
+  job.kind = Kind::Frames;
+  job.frames = frames;
+  return job;
+}
+
+Batch::Job Batch::Job::runUntilSerial(const std::string& until,
+                                      const std::string& fail,
+                                      long max_frames) {
+  Job job;
+  job.kind = Kind::UntilSerial;
+  job.frames = max_frames;
+  job.until = until;
+  job.fail = fail;
+  return job;
+}
+
+Batch::Job Batch::Job::replay(std::shared_ptr<const Movie> movie) {
+  Job job;
+  job.kind = Kind::Replay;
+  job.frames = static_cast<long>(movie->size());
+  job.movie = std::move(movie);
+  return job;
+}
+
+Batch::Batch(int threads, int slice_frames, bool pin)
+    : slice_frames_(slice_frames), pool_(threads, pin) {
+  for (int i = 0; i < pool_.size(); i++) {
+    arenas_.emplace_back(new Arena);
+  }
+}
+
+Batch::~Batch() { pool_.wait(); }
+
+std::size_t Batch::add(std::shared_ptr<const Program> program, Job job,
+                       Capture* capture, Profiler* profiler) {
+  sessions_.emplace_back(
+      new Session{std::move(program), std::move(job), capture, profiler});
+  return sessions_.size() - 1;
+}
+
+void Batch::run() {
+  for (auto& session : sessions_) {
+    if (session->result.status == Result::Status::Pending) {
+      Session* current = session.get();
+      pool_.submit([this, current]() { step(*current); });
+    }
+  }
+  pool_.wait();
+}
+
+const Batch::Result& Batch::result(std::size_t index) const {
+  return sessions_[index]->result;
+}
+
+long Batch::totalFrames() const {
+  long frames = 0;
+  for (const auto& session : sessions_) {
+    frames += session->result.frames;
+  }
+  return frames;
+}
+
+void Batch::step(Session& session) {
+  // Nothing may escape onto a worker, that would take down every other
+  // session. A machine that fails stops, the rest of the batch goes on.
+  try {
+    runSlice(session);
+  } catch (const std::exception& error) {
+    Result& result = session.result;
+    result.status = Result::Status::Error;
+    result.error = error.what();
+    if (session.cpu) {
+      result.serial = session.cpu->memory().serial_data();
+    }
+  }
+}
+
+void Batch::runSlice(Session& session) {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+
+  // Machines are built by the worker that first runs them, out of its arena,
+  // so their pages are first touched on that worker's core.
+  if (!session.cpu) {
+    Arena::Scope scope{arenas_[pool_.currentWorker()].get()};
+    session.cpu.reset(new CPU{session.window, *session.program});
+    if (session.capture) {
+      session.cpu->apu().setSampleRate(session.capture->sampleRate());
+    }
+  }
+
+  CPU& cpu = *session.cpu;
+  Result& result = session.result;
+  Timeline& timeline = Timeline::global();
+  for (int i = 0; i < slice_frames_ && !finished(session); i++) {
+    uint64_t begin = Timeline::compiled ? Timeline::ticks() : 0;
+    if (session.job.kind == Job::Kind::Replay) {
+      cpu.joypad().set((*session.job.movie)[result.frames]);
+    }
+    if (session.profiler) {
+      session.profiler->cycle(cpu);
+    } else {
+      cpu.cycle();
+    }
+    if (session.capture) {
+      session.capture->addFrame(cpu);
+    }
+    if (session.job.hash_frames) {
+      FrameHashes::Entry entry;
+      entry.frame = FrameHashes::frame(cpu.lcd());
+      if (session.job.hash_states) {
+        entry.state = session.hasher.hash(cpu);
+      }
+      result.hashes.add(entry);
+    }
+    if (Timeline::compiled && timeline.recording()) {
+      timeline.span("frame", begin);
+    }
+    result.frames++;
+  }
+
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  result.seconds += elapsed.count();
+
+  if (!finished(session)) {
+    pool_.submit([this, &session]() { step(session); });
+    return;
+  }
+
+  const std::string& serial = cpu.memory().serial_data();
+  result.serial = serial;
+  result.footprint = cpu.footprint();
+  if (session.job.kind != Job::Kind::UntilSerial) {
+    result.status = Result::Status::Done;
+  } else if (serial.find(session.job.until) != std::string::npos) {
+    result.status = Result::Status::Passed;
+  } else if (!session.job.fail.empty() &&
+             serial.find(session.job.fail) != std::string::npos) {
+    result.status = Result::Status::Failed;
+  } else {
+    result.status = Result::Status::TimedOut;
+  }
+}
+
+bool Batch::finished(const Session& session) const {
+  if (session.result.frames >= session.job.frames) {
+    return true;
+  }
+  if (session.job.kind != Job::Kind::UntilSerial) {
+    return false;
+  }
+
+  const std::string& serial = session.cpu->memory().serial_data();
+  return serial.find(session.job.until) != std::string::npos ||
+         (!session.job.fail.empty() &&
+          serial.find(session.job.fail) != std::string::npos);
+}
+
+}  // namespace gb
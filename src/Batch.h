@@ -0,0 +1,103 @@
+#ifndef GEEBEE_SRC_BATCH_H
+#define GEEBEE_SRC_BATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameHashes.h"
+#include "Movie.h"
+#include "ThreadPool.h"
+#include "Window.h"
+
+namespace gb {
+
+class Arena;
+class Capture;
+class CPU;
+class Profiler;
+class Program;
+
+// Runs many independent machines in one process. Every machine advances in
+// slices of a few frames on a shared work-stealing pool, so long and short
+// sessions balance out over all cores.
+class Batch {
+ public:
+  struct Job {
+    enum class Kind { Frames, UntilSerial, Replay };
+
+    // Runs exactly `frames` frames.
+    static Job runFrames(long frames);
+    // Runs until the serial output contains `until` or `fail`, or gives up
+    // after `max_frames` frames.
+    static Job runUntilSerial(const std::string& until,
+                              const std::string& fail = "",
+                              long max_frames = 60 * 60 * 10);
+    // Plays back the input of `movie`, one frame per recorded byte.
+    static Job replay(std::shared_ptr<const Movie> movie);
+
+    Kind kind{Kind::Frames};
+    long frames{0};
+    std::string until;
+    std::string fail;
+    std::shared_ptr<const Movie> movie;
+    // Records a hash of every frame, and of the machine state after it.
+    bool hash_frames{false};
+    bool hash_states{false};
+  };
+
+  struct Result {
+    enum class Status { Pending, Done, Passed, Failed, TimedOut, Error };
+
+    Status status{Status::Pending};
+    // Why the machine stopped early, such as an invalid opcode or an
+    // unsupported cartridge, with status Error
+    std::string error;
+    long frames{0};
+    double seconds{0.0};
+    std::string serial;
+    FrameHashes hashes;
+    // Private memory of the machine, see CPU::footprint()
+    std::size_t footprint{0};
+  };
+
+  // Every worker builds its machines out of an arena of its own. Pinning the
+  // workers to cores keeps their machines in memory local to that core.
+  explicit Batch(int threads = 0, int slice_frames = 30, bool pin = false);
+  Batch(const Batch& batch) = delete;
+  Batch(Batch&& batch) = delete;
+  ~Batch();
+  Batch& operator=(const Batch& batch) = delete;
+  Batch& operator=(const Batch&& batch) = delete;
+
+  int threads() const { return pool_.size(); }
+  std::size_t size() const { return sessions_.size(); }
+
+  // Adds a machine running `program`, returning its index in results().
+  // Every frame it runs is handed to `capture` and every instruction to
+  // `profiler`, if there are any.
+  std::size_t add(std::shared_ptr<const Program> program, Job job,
+                  Capture* capture = nullptr, Profiler* profiler = nullptr);
+  // Runs every session that has not finished yet and waits for them.
+  void run();
+
+  const Result& result(std::size_t index) const;
+  long totalFrames() const;
+
+ private:
+  struct Session;
+
+  void step(Session& session);
+  void runSlice(Session& session);
+  bool finished(const Session& session) const;
+
+  int slice_frames_{30};
+  // Indexed by worker, outliving the machines built out of them
+  std::vector<std::unique_ptr<Arena>> arenas_;
+  std::vector<std::unique_ptr<Session>> sessions_;
+  ThreadPool pool_;
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,112 @@
+#include "BlipBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gb {
+
+BlipBuffer::BlipBuffer(std::size_t capacity) : capacity_(capacity) {}
+
+const std::vector<int32_t>& BlipBuffer::kernel() {
+  static const std::vector<int32_t> kernel = []() {
+    const double pi = 3.14159265358979323846;
+    // Cut off a little below the output Nyquist frequency
+    const double cutoff = 0.9;
+    std::vector<int32_t> table(phases * taps);
+    for (int phase = 0; phase < phases; phase++) {
+      double row[taps];
+      double sum = 0;
+      for (int tap = 0; tap < taps; tap++) {
+        double x = tap - taps / 2 + 1 - static_cast<double>(phase) / phases;
+        double sinc = x == 0 ? 1 : std::sin(pi * x * cutoff) / (pi * x * cutoff);
+        double window =
+            0.42 + 0.5 * std::cos(pi * x / (taps / 2)) +
+            0.08 * std::cos(2 * pi * x / (taps / 2));
+        row[tap] = std::abs(x) < taps / 2 ? sinc * window : 0;
+        sum += row[tap];
+      }
+
+      // Normalise with the rounding error going to the centre tap, so every
+      // step integrates to exactly its height
+      int32_t total = 0;
+      for (int tap = 0; tap < taps; tap++) {
+        int32_t value = std::lround(row[tap] / sum * (1 << kernel_bits));
+        table[phase * taps + tap] = value;
+        total += value;
+      }
+      table[phase * taps + taps / 2 - 1] += (1 << kernel_bits) - total;
+    }
+    return table;
+  }();
+  return kernel;
+}
+
+void BlipBuffer::setRates(double clock_rate, double sample_rate) {
+  // Machines that never make a sound don't carry the buffer around
+  if (sample_rate > 0 && buffer_.empty()) {
+    buffer_.assign(capacity_ + taps, 0);
+  }
+  factor_ = static_cast<uint64_t>(
+      std::ceil(sample_rate / clock_rate * (uint64_t{1} << time_bits)));
+}
+
+void BlipBuffer::clear() {
+  offset_ = 0;
+  available_ = 0;
+  integrator_ = 0;
+  std::fill(buffer_.begin(), buffer_.end(), 0);
+}
+
+void BlipBuffer::addDelta(uint32_t time, int delta) {
+  uint64_t position = offset_ + time * factor_;
+  std::size_t index = available_ + (position >> time_bits);
+  if (index + taps > buffer_.size()) {
+    return;
+  }
+
+  int phase = (position >> (time_bits - phase_bits)) & (phases - 1);
+  const int32_t* coefficients = kernel().data() + phase * taps;
+  int32_t* out = buffer_.data() + index;
+  for (int tap = 0; tap < taps; tap++) {
+    out[tap] += coefficients[tap] * delta;
+  }
+}
+
+void BlipBuffer::endFrame(uint32_t duration) {
+  offset_ += duration * factor_;
+  available_ += offset_ >> time_bits;
+  offset_ &= (uint64_t{1} << time_bits) - 1;
+  // Nobody is reading, so start over rather than keep stale samples
+  if (available_ > capacity_) {
+    clear();
+  }
+}
+
+std::size_t BlipBuffer::readSamples(int16_t* out, std::size_t count,
+                                    int stride) {
+  count = std::min(count, available_);
+  int32_t sum = integrator_;
+  for (std::size_t i = 0; i < count; i++) {
+    sum += buffer_[i];
+    int32_t sample = sum >> kernel_bits;
+    sample = std::max<int32_t>(std::min<int32_t>(sample, 32767), -32768);
+    out[i * stride] = static_cast<int16_t>(sample);
+    // Slowly pulls the output back to zero to remove DC offsets
+    sum -= sample << (kernel_bits - bass_shift);
+  }
+  integrator_ = sum;
+  removeSamples(count);
+  return count;
+}
+
+void BlipBuffer::removeSamples(std::size_t count) {
+  count = std::min(count, available_);
+  std::size_t remaining = available_ + taps - count;
+  std::copy(buffer_.begin() + count, buffer_.begin() + count + remaining,
+            buffer_.begin());
+  std::fill(buffer_.begin() + remaining, buffer_.begin() + remaining + count,
+            0);
+  available_ -= count;
+}
+
+}  // namespace gb
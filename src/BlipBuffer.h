@@ -0,0 +1,64 @@
+#ifndef GEEBEE_SRC_BLIPBUFFER_H
+#define GEEBEE_SRC_BLIPBUFFER_H
+
+#include <vector>
+
+#include "types.h"
+
+namespace gb {
+
+// Band-limited step synthesis: a waveform is described only by the clock
+// times at which its amplitude changes, each change is spread over a few
+// output samples with a windowed sinc kernel, and reading integrates the
+// steps back into samples. The cost follows the number of amplitude
+// changes, not the clock rate.
+class BlipBuffer {
+ public:
+  explicit BlipBuffer(std::size_t capacity = 8192);
+  BlipBuffer(const BlipBuffer& buffer) = delete;
+  BlipBuffer(BlipBuffer&& buffer) = delete;
+  ~BlipBuffer() = default;
+  BlipBuffer& operator=(const BlipBuffer& buffer) = delete;
+  BlipBuffer& operator=(const BlipBuffer&& buffer) = delete;
+
+  void setRates(double clock_rate, double sample_rate);
+  void clear();
+
+  // Adds a step of `delta` at `time` clocks into the current frame.
+  void addDelta(uint32_t time, int delta);
+  // Ends the current frame after `duration` clocks, making its samples
+  // readable. Everything is dropped once the capacity is exceeded.
+  void endFrame(uint32_t duration);
+
+  std::size_t capacity() const { return capacity_; }
+  // Bytes held, nothing until there is a sample rate
+  std::size_t footprint() const { return buffer_.capacity() * sizeof(int32_t); }
+  std::size_t samplesAvailable() const { return available_; }
+  // Reads up to `count` samples into every `stride`th element of `out`.
+  std::size_t readSamples(int16_t* out, std::size_t count, int stride = 1);
+
+ private:
+  static const int phase_bits = 5;
+  static const int phases = 1 << phase_bits;
+  static const int taps = 16;
+  static const int kernel_bits = 15;
+  static const int bass_shift = 9;
+  static const int time_bits = 32;
+
+  // `taps` coefficients for each sub-sample phase, each row summing to
+  // 1 << kernel_bits
+  static const std::vector<int32_t>& kernel();
+
+  void removeSamples(std::size_t count);
+
+  std::size_t capacity_;
+  uint64_t factor_{0};
+  uint64_t offset_{0};
+  std::size_t available_{0};
+  int32_t integrator_{0};
+  std::vector<int32_t> buffer_;
+};
+
+}  // namespace gb
+
+#endif
@@ -1,123 +1,169 @@
 #include "CPU.h"
 
 #include <algorithm>
-#include <iostream>
 #include <stdexcept>
 #include <string>
 
 #include <boost/convert.hpp>
 #include <boost/convert/stream.hpp>
 
+#include "Arena.h"
 #include "Program.h"
+#include "Timeline.h"
 #include "bits.h"
 
 namespace gb {
 
+const int CPU::max_frame_timing_ = 2 * 70224;
+const long CPU::max_boot_timing_ = 10L * 4194304;
+
 CPU::CPU(Window& window, const Program& program)
     : program_(program),
       memory_(program_),
+      regs_(memory_.machine().cpu),
       joypad_(memory_),
       timer_(memory_),
+      apu_(memory_),
       lcd_(window, memory_) {
-  setupOpcodes();
-  setupCbOpcodes();
   reset();
 }
 
-void CPU::reset() {
-  memory_.reset();
+CPU::CPU(const CPU& cpu, Window& window)
+    : program_(cpu.program_),
+      memory_(cpu.memory_),
+      regs_(memory_.machine().cpu),
+      joypad_(memory_),
+      timer_(memory_),
+      apu_(memory_),
+      lcd_(window, memory_) {
+  apu_.resync();
+}
 
-  a_ = 0;
-  f_ = 0;
-  b_ = 0;
-  c_ = 0;
-  d_ = 0;
-  e_ = 0;
-  h_ = 0;
-  l_ = 0;
-  sp_ = 0;
-  pc_ = 0;
+std::unique_ptr<CPU> CPU::clone(Window& window) const {
+  return std::unique_ptr<CPU>(new CPU(*this, window));
+}
 
-  interrupts_ = true;
-  halt_ = false;
+void* CPU::operator new(std::size_t size) {
+  return Arena::allocate(size, MachineState::cache_line);
+}
 
-  clearFlags();
+void CPU::operator delete(void* block) { Arena::deallocate(block); }
+
+std::size_t CPU::footprint() const {
+  return sizeof(CPU) + memory_.footprint() + apu_.footprint() +
+         tracer_.footprint();
+}
+
+void CPU::reset() {
+  memory_.reset(program_.bootState([this](MachineState& state) {
+    boot();
+    state = memory_.machine();
+  }));
+  apu_.resync();
+}
+
+void CPU::boot() {
+  memory_.reset();
+  apu_.resync();
+  regs_.interrupts = true;
 
   if (program_.bootrom().empty()) {
     initNoboot();
+    return;
   }
+
+  // Nobody gets to see the boot ROM's frames, and a cartridge it refuses
+  // to start is left where the boot ROM locked up
+  lcd_.setRendering(false);
+  long timing = 0;
+  while (memory_.booting() && timing < max_boot_timing_) {
+    timing += step();
+  }
+  lcd_.setRendering(true);
+}
+
+CPU::Registers CPU::registers() const {
+  Registers registers;
+  registers.a = regs_.a;
+  registers.f = regs_.f;
+  registers.b = regs_.b;
+  registers.c = regs_.c;
+  registers.d = regs_.d;
+  registers.e = regs_.e;
+  registers.h = regs_.h;
+  registers.l = regs_.l;
+  registers.sp = regs_.sp;
+  registers.pc = regs_.pc;
+  registers.interrupts = regs_.interrupts;
+  registers.halt = regs_.halt;
+  return registers;
+}
+
+void CPU::save(State& state) const { memory_.save(state); }
+
+void CPU::load(const State& state) {
+  memory_.load(state);
+  apu_.resync();
 }
 
 void CPU::cycle() {
-  do {
-    step();
-  } while (!lcd_.doneFrame());
+  cycle([this]() { return step(); });
 }
 
-void CPU::step() {
+int CPU::step() {
   int timing = 4;
   Byte iEnable = memory_.read(Memory::Register::InterruptEnable);
   Byte iFlag = memory_.read(Memory::Register::InterruptFlag);
   bool hasInterrupt = iEnable & iFlag;
 
   // Manage interrupts if we have any
-  if (interrupts_ && hasInterrupt) {
+  if (regs_.interrupts && hasInterrupt) {
     for (int i = 0; i <= 4; i++) {
       if (bits::bit(iEnable & iFlag, i)) {
         bits::setBit(iFlag, i, false);
         memory_.write(Memory::Register::InterruptFlag, iFlag);
 
-        interrupts_ = false;
-        push(bits::high(pc_), bits::low(pc_));
-        pc_ = 0x40 + i * 0x08;
+        regs_.interrupts = false;
+        push(bits::high(regs_.pc), bits::low(regs_.pc));
+        regs_.pc = 0x40 + i * 0x08;
 
-        halt_ = false;
+        regs_.halt = false;
         timing = 12;
         break;
       }
     }
-  } else if (!interrupts_ && iFlag && halt_) {
-    halt_ = false;
-  } else if (!halt_) {
+  } else if (!regs_.interrupts && iFlag && regs_.halt) {
+    regs_.halt = false;
+  } else if (!regs_.halt) {
     timing = readInstruction();
   }
 
+  memory_.advance(timing);
   timer_.advance(timing);
+  apu_.advance(timing);
   lcd_.advance(timing);
-}
 
-void CPU::printState() {
-  std::cout << std::hex << "AF: " << static_cast<int>(a_) << " "
-            << static_cast<int>(f_) << " "
-            << "BC: " << static_cast<int>(b_) << " " << static_cast<int>(c_)
-            << " "
-            << "DE: " << static_cast<int>(d_) << " " << static_cast<int>(e_)
-            << " "
-            << "HL: " << static_cast<int>(h_) << " " << static_cast<int>(l_)
-            << " "
-            << "SP: " << static_cast<int>(sp_) << " "
-            << "PC: " << static_cast<int>(pc_) << " " << std::dec
-            << " F: " << (zero_ ? "Zero " : "") << (add_ ? "Add " : "")
-            << (half_carry_ ? "Half " : "") << (carry_ ? "Carry " : "")
-            << std::endl;
+  return timing;
 }
 
 void CPU::initNoboot() {
-  a_ = 0x01;
-  f_ = 0xB0;
-  b_ = 0x00;
-  c_ = 0x13;
-  d_ = 0x00;
-  e_ = 0xD8;
-  h_ = 0x01;
-  l_ = 0x4D;
-  sp_ = 0xFFFE;
-  pc_ = 0x0100;
+  regs_.a = 0x01;
+  regs_.f = 0xB0;
+  regs_.b = 0x00;
+  regs_.c = 0x13;
+  regs_.d = 0x00;
+  regs_.e = 0xD8;
+  regs_.h = 0x01;
+  regs_.l = 0x4D;
+  regs_.sp = 0xFFFE;
+  regs_.pc = 0x0100;
   clearFlags();
 
   memory_.write(0xFF05, 0x00);
   memory_.write(0xFF06, 0x00);
   memory_.write(0xFF07, 0x00);
+  // Sound has to be powered on before its registers take writes
+  memory_.write(0xFF26, 0xF1);
   memory_.write(0xFF10, 0x80);
   memory_.write(0xFF11, 0xBF);
   memory_.write(0xFF12, 0xF3);
@@ -135,7 +181,6 @@ void CPU::initNoboot() {
   memory_.write(0xFF23, 0xBF);
   memory_.write(0xFF24, 0x77);
   memory_.write(0xFF25, 0xF3);
-  memory_.write(0xFF26, 0xF1);
   memory_.write(0xFF40, 0x91);
   memory_.write(0xFF42, 0x00);
   memory_.write(0xFF43, 0x00);
@@ -151,43 +196,66 @@ void CPU::initNoboot() {
 }
 
 int CPU::readInstruction() {
-  Byte op = memory_.read(pc_++);
-
-  int timing = handleOpcode(op);
-  serializeFlags();
+  Byte op = memory_.read(regs_.pc++);
+  if (Tracer::enabled && tracer_.active()) {
+    trace(op);
+  }
 
-  if (output_) {
-    printState();
+  int timing;
+  {
+    Timeline::Scope scope{Timeline::Dispatch};
+    timing = handleOpcode(op);
   }
+  serializeFlags();
 
   return timing;
 }
 
-int CPU::handleOpcode(Byte op) { return opcodes_[op](); }
+void CPU::trace(Byte op) {
+  Word pc = regs_.pc - 1;
+  TraceRecord record;
+  record.cycle = memory_.cycles();
+  record.pc = pc;
+  record.bank = pc < 0x8000 ? memory_.mbc().romBank(pc) : 0;
+  record.sp = regs_.sp;
+  record.opcode = op;
+  record.operand = memory_.peek(regs_.pc);
+  record.a = regs_.a;
+  record.f = regs_.f;
+  record.b = regs_.b;
+  record.c = regs_.c;
+  record.d = regs_.d;
+  record.e = regs_.e;
+  record.h = regs_.h;
+  record.l = regs_.l;
+  tracer_.record(record);
+}
+
+int CPU::handleOpcode(Byte op) { return opcodes_[op](*this, op); }
 
 void CPU::clearFlags() {
-  zero_ = false;
-  add_ = false;
-  half_carry_ = false;
-  carry_ = false;
+  regs_.zero = false;
+  regs_.add = false;
+  regs_.half_carry = false;
+  regs_.carry = false;
 }
 
 void CPU::serializeFlags() {
-  bits::setBit(f_, 7, zero_);
-  bits::setBit(f_, 6, add_);
-  bits::setBit(f_, 5, half_carry_);
-  bits::setBit(f_, 4, carry_);
+  bits::setBit(regs_.f, 7, regs_.zero);
+  bits::setBit(regs_.f, 6, regs_.add);
+  bits::setBit(regs_.f, 5, regs_.half_carry);
+  bits::setBit(regs_.f, 4, regs_.carry);
 
-  f_ &= 0xF0;
+  regs_.f &= 0xF0;
 }
 
 void CPU::deserializeFlags() {
-  zero_ = bits::bit(f_, 7);
-  add_ = bits::bit(f_, 6);
-  half_carry_ = bits::bit(f_, 5);
-  carry_ = bits::bit(f_, 4);
+  regs_.zero = bits::bit(regs_.f, 7);
+  regs_.add = bits::bit(regs_.f, 6);
+  regs_.half_carry = bits::bit(regs_.f, 5);
+  regs_.carry = bits::bit(regs_.f, 4);
 
-  f_ &= 0xF0;
+  regs_.f &= 0xF0;
 }
 
 }  // namespace gb
@@ -2,12 +2,15 @@
 #define GEEBEE_SRC_CPU_H
 
 #include <array>
-#include <functional>
+#include <memory>
+#include <string>
 
+#include "APU.h"
 #include "Joypad.h"
 #include "LCD.h"
 #include "Memory.h"
 #include "Timer.h"
+#include "Trace.h"
 #include "types.h"
 
 namespace gb {
@@ -18,30 +21,124 @@ class Window;
 
 class CPU {
  public:
+  // Instruction tracing only exists in builds configured with GEEBEE_TRACE
+#ifdef GEEBEE_TRACE
+  using Tracer = TraceRing;
+#else
+  using Tracer = NullTracer;
+#endif
+
+  // The register file, cheap to take after every instruction
+  struct Registers {
+    Byte a{0};
+    Byte f{0};
+    Byte b{0};
+    Byte c{0};
+    Byte d{0};
+    Byte e{0};
+    Byte h{0};
+    Byte l{0};
+    Word sp{0};
+    Word pc{0};
+    bool interrupts{false};
+    bool halt{false};
+  };
+
+  // Snapshots hold the machine's state block, so taking or restoring one
+  // is a single copy
+  using State = Memory::State;
+
   CPU(Window& window, const Program& program);
+  CPU(const CPU& cpu) = delete;
+  CPU(CPU&& cpu) = delete;
   ~CPU() = default;
-
+  CPU& operator=(const CPU& cpu) = delete;
+  CPU& operator=(const CPU&& cpu) = delete;
+
+  // Creates an independent machine in the current state of this one. The ROM
+  // and cartridge RAM are shared until either side writes to them, the state
+  // block with everything else is copied. The clone can run on another
+  // thread than the original, but has to be created on the thread running
+  // the original.
+  std::unique_ptr<CPU> clone(Window& window) const;
+
+  // Machines created with new come from the arena of the thread if it has
+  // one, next to their state block.
+  static void* operator new(std::size_t size);
+  static void operator delete(void* block);
+
+  // Bytes of memory private to this machine. The ROM and the cartridge RAM
+  // still shared with clones are not counted.
+  std::size_t footprint() const;
+
+  const Memory& memory() const { return memory_; }
+  const LCD& lcd() const { return lcd_; }
   Memory& memory() { return memory_; }
   Joypad& joypad() { return joypad_; }
+  APU& apu() { return apu_; }
+  LCD& lcd() { return lcd_; }
+  Tracer& tracer() { return tracer_; }
+  const Tracer& tracer() const { return tracer_; }
+  Registers registers() const;
+
+  // Mnemonic of `opcode`, or of the CB prefixed `operand` after it.
+  static const std::string& describe(Byte opcode, Byte operand);
+
+  // Snapshots the whole machine. Reusing the same state object keeps the
+  // serial output and cartridge RAM allocated, so repeated snapshots only
+  // copy bytes.
+  void save(State& state) const;
+  void load(const State& state);
+  void setRendering(bool rendering) { lcd_.setRendering(rendering); }
+
+  // Starts over from the state right after boot, which is worked out once
+  // per program and then only copied.
   void reset();
+  // Runs until the next VBlank, or for two frames worth of clocks if the LCD
+  // is off and never gets there.
   void cycle();
-  void step();
-
-  void printState();
+  // Runs a frame like cycle(), calling `step` for every instruction instead
+  // of step(), for observers that need to see each one.
+  template <typename Step>
+  void cycle(Step step) {
+    int timing = 0;
+    do {
+      timing += step();
+    } while (!lcd_.doneFrame() && timing < max_frame_timing_);
+    apu_.endFrame();
+  }
+  int step();
 
  private:
-  using Opcodes = std::array<std::function<int()>, 0x100>;
+  // Opcode handlers are plain functions shared by every machine, taking the
+  // opcode they were dispatched for
+  using Opcode = int (*)(CPU& cpu, Byte op);
+  using Opcodes = std::array<Opcode, 0x100>;
 
+  static const int max_frame_timing_;
+  static const long max_boot_timing_;
   static const std::array<std::string, 0x100> opcode_description_;
   static const std::array<std::string, 0x100> prefix_opcode_description_;
+  static const Opcodes opcodes_;
+  static const Opcodes cb_opcodes_;
+
+  static Opcodes makeOpcodes();
+  static Opcodes makeCbOpcodes();
+  static int invalidOpcode(CPU& cpu, Byte op);
+
+  CPU(const CPU& cpu, Window& window);
 
+  // Boots from power on, through the boot ROM if there is one
+  void boot();
   void initNoboot();
 
-  void setupOpcodes();
-  void setupCbOpcodes();
   int readInstruction();
+  void trace(Byte op);
 
   int handleOpcode(Byte op);
+  Word bc() const;
+  Word de() const;
+  Word hl() const;
   void clearFlags();
   void serializeFlags();
   void deserializeFlags();
@@ -94,33 +191,13 @@ class CPU {
 
   const Program& program_;
   Memory memory_;
+  MachineState::Cpu& regs_;
   Joypad joypad_;
   Timer timer_;
+  APU apu_;
   LCD lcd_;
 
-  Opcodes opcodes_;
-  Opcodes cb_opcodes_;
-
-  Byte a_{0};
-  Byte f_{0};
-  Byte b_{0};
-  Byte c_{0};
-  Byte d_{0};
-  Byte e_{0};
-  Byte h_{0};
-  Byte l_{0};
-
-  Word sp_{0};
-  Word pc_{0};
-
-  bool interrupts_{false};
-  bool halt_{false};
-  bool zero_{false};
-  bool add_{false};
-  bool half_carry_{false};
-  bool carry_{false};
-
-  bool output_{false};
+  Tracer tracer_;
 };
 
 }  // namespace gb
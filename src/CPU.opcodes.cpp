@@ -1,9 +1,16 @@
 #include "CPU.h"
 
+#include <stdexcept>
+
 #include "bits.h"
 
 namespace gb {
 
+const std::string& CPU::describe(Byte opcode, Byte operand) {
+  return opcode == 0xCB ? prefix_opcode_description_[operand]
+                        : opcode_description_[opcode];
+}
+
 const std::array<std::string, 0x100> CPU::opcode_description_{
     "NOP",        "LD BC,d16",   "LD (BC),A",   "INC BC",      "INC B",
     "DEC B",      "LD B,d8",     "RLCA",        "LD (a16),SP", "ADD HL,BC",
@@ -103,481 +110,492 @@ const std::array<std::string, 0x100> CPU::prefix_opcode_description_{
     "SET 6,(HL)", "SET 6,A", "SET 7,B",    "SET 7,C", "SET 7,D",    "SET 7,E",
     "SET 7,H",    "SET 7,L", "SET 7,(HL)", "SET 7,A"};
 
-void CPU::setupOpcodes() {
-  // Helper functions
-  auto bc = [&]() -> Word { return bits::assemble(b_, c_); };
-  auto de = [&]() -> Word { return bits::assemble(d_, e_); };
-  auto hl = [&]() -> Word { return bits::assemble(h_, l_); };
+const CPU::Opcodes CPU::opcodes_ = CPU::makeOpcodes();
+const CPU::Opcodes CPU::cb_opcodes_ = CPU::makeCbOpcodes();
+
+Word CPU::bc() const { return bits::assemble(regs_.b, regs_.c); }
+Word CPU::de() const { return bits::assemble(regs_.d, regs_.e); }
+Word CPU::hl() const { return bits::assemble(regs_.h, regs_.l); }
+
+// The unused opcodes lock up the real CPU
+int CPU::invalidOpcode(CPU&, Byte) {
+  throw std::runtime_error("Invalid opcode");
+}
+
+CPU::Opcodes CPU::makeOpcodes() {
+  Opcodes opcodes;
+  opcodes.fill(&CPU::invalidOpcode);
 
   // clang-format off
-  opcodes_[0x00] = [&]() { return 4; };
-  opcodes_[0x10] = [&]() { halt_ = true; /* HALT LCD */ return 4; };
-
-  opcodes_[0x20] = [&]() { return jumpRelative8Data(!zero_); };
-  opcodes_[0x30] = [&]() { return jumpRelative8Data(!carry_); };
-
-  opcodes_[0x01] = [&]() { return load16Data(b_, c_); };
-  opcodes_[0x11] = [&]() { return load16Data(d_, e_); };
-  opcodes_[0x21] = [&]() { return load16Data(h_, l_); };
-  opcodes_[0x31] = [&]() { Byte high, low; load16Data(high, low); sp_ = bits::assemble(high, low); return 12; };
-
-  opcodes_[0x02] = [&, bc]() { memory_.write(bc(), a_); return 8; };
-  opcodes_[0x12] = [&, de]() { memory_.write(de(), a_); return 8; };
-  opcodes_[0x22] = [&, hl]() { memory_.write(hl(), a_); bits::inc(h_, l_); return 8; };
-  opcodes_[0x32] = [&, hl]() { memory_.write(hl(), a_); bits::dec(h_, l_); return 8; };
-
-  opcodes_[0x03] = [&]() { bits::inc(b_, c_); return 8; };
-  opcodes_[0x13] = [&]() { bits::inc(d_, e_); return 8; };
-  opcodes_[0x23] = [&]() { bits::inc(h_, l_); return 8; };
-  opcodes_[0x33] = [&]() { sp_++; return 8; };
+  opcodes[0x00] = [](CPU&, Byte) { return 4; };
+  opcodes[0x10] = [](CPU& cpu, Byte) { cpu.regs_.halt = true; /* HALT LCD */ return 4; };
+
+  opcodes[0x20] = [](CPU& cpu, Byte) { return cpu.jumpRelative8Data(!cpu.regs_.zero); };
+  opcodes[0x30] = [](CPU& cpu, Byte) { return cpu.jumpRelative8Data(!cpu.regs_.carry); };
+
+  opcodes[0x01] = [](CPU& cpu, Byte) { return cpu.load16Data(cpu.regs_.b, cpu.regs_.c); };
+  opcodes[0x11] = [](CPU& cpu, Byte) { return cpu.load16Data(cpu.regs_.d, cpu.regs_.e); };
+  opcodes[0x21] = [](CPU& cpu, Byte) { return cpu.load16Data(cpu.regs_.h, cpu.regs_.l); };
+  opcodes[0x31] = [](CPU& cpu, Byte) { Byte high, low; cpu.load16Data(high, low); cpu.regs_.sp = bits::assemble(high, low); return 12; };
+
+  opcodes[0x02] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.bc(), cpu.regs_.a); return 8; };
+  opcodes[0x12] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.de(), cpu.regs_.a); return 8; };
+  opcodes[0x22] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.a); bits::inc(cpu.regs_.h, cpu.regs_.l); return 8; };
+  opcodes[0x32] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.a); bits::dec(cpu.regs_.h, cpu.regs_.l); return 8; };
+
+  opcodes[0x03] = [](CPU& cpu, Byte) { bits::inc(cpu.regs_.b, cpu.regs_.c); return 8; };
+  opcodes[0x13] = [](CPU& cpu, Byte) { bits::inc(cpu.regs_.d, cpu.regs_.e); return 8; };
+  opcodes[0x23] = [](CPU& cpu, Byte) { bits::inc(cpu.regs_.h, cpu.regs_.l); return 8; };
+  opcodes[0x33] = [](CPU& cpu, Byte) { cpu.regs_.sp++; return 8; };
   
-  opcodes_[0x04] = [&]() { return inc(b_); };
-  opcodes_[0x14] = [&]() { return inc(d_); };
-  opcodes_[0x24] = [&]() { return inc(h_); };
-  opcodes_[0x34] = [&, hl]() { Byte byte = memory_.read(hl()); timer_.advance(4); inc(byte); memory_.write(hl(), byte); return 8; };
+  opcodes[0x04] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.b); };
+  opcodes[0x14] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.d); };
+  opcodes[0x24] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.h); };
+  opcodes[0x34] = [](CPU& cpu, Byte) { Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.inc(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
   
-  opcodes_[0x05] = [&]() { return dec(b_); };
-  opcodes_[0x15] = [&]() { return dec(d_); };
-  opcodes_[0x25] = [&]() { return dec(h_); };
-  opcodes_[0x35] = [&, hl]() { Byte byte = memory_.read(hl()); timer_.advance(4); dec(byte); memory_.write(hl(), byte); return 8; };
-
-  opcodes_[0x06] = [&]() { b_ = memory_.read(pc_++); return 8; };
-  opcodes_[0x16] = [&]() { d_ = memory_.read(pc_++); return 8; };
-  opcodes_[0x26] = [&]() { h_ = memory_.read(pc_++); return 8; };
-  opcodes_[0x36] = [&, hl]() { timer_.advance(4); memory_.write(hl(), memory_.read(pc_++)); return 8; };
-
-  opcodes_[0x07] = [&]() { rotateLeft(a_); zero_ = false; return 4; };
-  opcodes_[0x17] = [&]() { rotateLeftCarry(a_); zero_ = false; return 4; };
-  opcodes_[0x27] = [&]() { daa(); return 4; };
-  opcodes_[0x37] = [&]() { add_ = false; half_carry_ = false; carry_ = true; return 4; };
-
-  opcodes_[0x08] = [&]() { Byte low = memory_.read(pc_++); Byte high = memory_.read(pc_++); Word word = bits::assemble(high, low); memory_.write(word, bits::low(sp_)); memory_.write(word + 1, bits::high(sp_)); return 20; };
-  opcodes_[0x18] = [&]() { return jumpRelative8Data(true); };
-  opcodes_[0x28] = [&]() { return jumpRelative8Data(zero_); };
-  opcodes_[0x38] = [&]() { return jumpRelative8Data(carry_); };
+  opcodes[0x05] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.b); };
+  opcodes[0x15] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.d); };
+  opcodes[0x25] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.h); };
+  opcodes[0x35] = [](CPU& cpu, Byte) { Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.dec(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+
+  opcodes[0x06] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+  opcodes[0x16] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+  opcodes[0x26] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+  opcodes[0x36] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); cpu.memory_.write(cpu.hl(), cpu.memory_.read(cpu.regs_.pc++)); return 8; };
+
+  opcodes[0x07] = [](CPU& cpu, Byte) { cpu.rotateLeft(cpu.regs_.a); cpu.regs_.zero = false; return 4; };
+  opcodes[0x17] = [](CPU& cpu, Byte) { cpu.rotateLeftCarry(cpu.regs_.a); cpu.regs_.zero = false; return 4; };
+  opcodes[0x27] = [](CPU& cpu, Byte) { cpu.daa(); return 4; };
+  opcodes[0x37] = [](CPU& cpu, Byte) { cpu.regs_.add = false; cpu.regs_.half_carry = false; cpu.regs_.carry = true; return 4; };
+
+  opcodes[0x08] = [](CPU& cpu, Byte) { Byte low = cpu.memory_.read(cpu.regs_.pc++); Byte high = cpu.memory_.read(cpu.regs_.pc++); Word word = bits::assemble(high, low); cpu.memory_.write(word, bits::low(cpu.regs_.sp)); cpu.memory_.write(word + 1, bits::high(cpu.regs_.sp)); return 20; };
+  opcodes[0x18] = [](CPU& cpu, Byte) { return cpu.jumpRelative8Data(true); };
+  opcodes[0x28] = [](CPU& cpu, Byte) { return cpu.jumpRelative8Data(cpu.regs_.zero); };
+  opcodes[0x38] = [](CPU& cpu, Byte) { return cpu.jumpRelative8Data(cpu.regs_.carry); };
   
-  opcodes_[0x09] = [&, bc]() { return addHl(bc()); };
-  opcodes_[0x19] = [&, de]() { return addHl(de()); };
-  opcodes_[0x29] = [&, hl]() { return addHl(hl()); };
-  opcodes_[0x39] = [&]() { return addHl(sp_); };
-
-  opcodes_[0x0A] = [&, bc]() { a_ = memory_.read(bc()); return 8; };
-  opcodes_[0x1A] = [&, de]() { a_ = memory_.read(de()); return 8; };
-  opcodes_[0x2A] = [&, hl]() { a_ = memory_.read(hl()); bits::inc(h_, l_); return 8; };
-  opcodes_[0x3A] = [&, hl]() { a_ = memory_.read(hl()); bits::dec(h_, l_); return 8; };
-
-  opcodes_[0x0B] = [&]() { bits::dec(b_, c_); return 8; };
-  opcodes_[0x1B] = [&]() { bits::dec(d_, e_); return 8; };
-  opcodes_[0x2B] = [&]() { bits::dec(h_, l_); return 8; };
-  opcodes_[0x3B] = [&]() { sp_--; return 8; };
+  opcodes[0x09] = [](CPU& cpu, Byte) { return cpu.addHl(cpu.bc()); };
+  opcodes[0x19] = [](CPU& cpu, Byte) { return cpu.addHl(cpu.de()); };
+  opcodes[0x29] = [](CPU& cpu, Byte) { return cpu.addHl(cpu.hl()); };
+  opcodes[0x39] = [](CPU& cpu, Byte) { return cpu.addHl(cpu.regs_.sp); };
+
+  opcodes[0x0A] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(cpu.bc()); return 8; };
+  opcodes[0x1A] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(cpu.de()); return 8; };
+  opcodes[0x2A] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(cpu.hl()); bits::inc(cpu.regs_.h, cpu.regs_.l); return 8; };
+  opcodes[0x3A] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(cpu.hl()); bits::dec(cpu.regs_.h, cpu.regs_.l); return 8; };
+
+  opcodes[0x0B] = [](CPU& cpu, Byte) { bits::dec(cpu.regs_.b, cpu.regs_.c); return 8; };
+  opcodes[0x1B] = [](CPU& cpu, Byte) { bits::dec(cpu.regs_.d, cpu.regs_.e); return 8; };
+  opcodes[0x2B] = [](CPU& cpu, Byte) { bits::dec(cpu.regs_.h, cpu.regs_.l); return 8; };
+  opcodes[0x3B] = [](CPU& cpu, Byte) { cpu.regs_.sp--; return 8; };
   
-  opcodes_[0x0C] = [&]() { return inc(c_); };
-  opcodes_[0x1C] = [&]() { return inc(e_); };
-  opcodes_[0x2C] = [&]() { return inc(l_); };
-  opcodes_[0x3C] = [&]() { return inc(a_); };
-
-  opcodes_[0x0D] = [&]() { return dec(c_); };
-  opcodes_[0x1D] = [&]() { return dec(e_); };
-  opcodes_[0x2D] = [&]() { return dec(l_); };
-  opcodes_[0x3D] = [&]() { return dec(a_); };
-
-  opcodes_[0x0E] = [&]() { c_ = memory_.read(pc_++); return 8; };
-  opcodes_[0x1E] = [&]() { e_ = memory_.read(pc_++); return 8; };
-  opcodes_[0x2E] = [&]() { l_ = memory_.read(pc_++); return 8; };
-  opcodes_[0x3E] = [&]() { a_ = memory_.read(pc_++); return 8; };
-
-  opcodes_[0x0F] = [&]() { rotateRight(a_); zero_ = false; return 4; };
-  opcodes_[0x1F] = [&]() { rotateRightCarry(a_); zero_ = false; return 4; };
-  opcodes_[0x2F] = [&]() { add_ = true; half_carry_ = true; a_ = ~a_; return 4; };
-  opcodes_[0x3F] = [&]() { add_ = false; half_carry_ = false; carry_ = !carry_; return 4; };
-
-  opcodes_[0x40] = [&]() { return 4; };
-  opcodes_[0x41] = [&]() { b_ = c_; return 4; };
-  opcodes_[0x42] = [&]() { b_ = d_; return 4; };
-  opcodes_[0x43] = [&]() { b_ = e_; return 4; };
-  opcodes_[0x44] = [&]() { b_ = h_; return 4; };
-  opcodes_[0x45] = [&]() { b_ = l_; return 4; };
-  opcodes_[0x46] = [&, hl]() { b_ = memory_.read(hl()); return 8; };
-  opcodes_[0x47] = [&]() { b_ = a_; return 4; };
-  opcodes_[0x48] = [&]() { c_ = b_; return 4; };
-  opcodes_[0x49] = [&]() { return 4; };
-  opcodes_[0x4A] = [&]() { c_ = d_; return 4; };
-  opcodes_[0x4B] = [&]() { c_ = e_; return 4; };
-  opcodes_[0x4C] = [&]() { c_ = h_; return 4; };
-  opcodes_[0x4D] = [&]() { c_ = l_; return 4; };
-  opcodes_[0x4E] = [&, hl]() { c_ = memory_.read(hl()); return 8; };
-  opcodes_[0x4F] = [&]() { c_ = a_; return 4; };
-
-  opcodes_[0x50] = [&]() { d_ = b_; return 4; };
-  opcodes_[0x51] = [&]() { d_ = c_; return 4; };
-  opcodes_[0x52] = [&]() { return 4; };
-  opcodes_[0x53] = [&]() { d_ = e_; return 4; };
-  opcodes_[0x54] = [&]() { d_ = h_; return 4; };
-  opcodes_[0x55] = [&]() { d_ = l_; return 4; };
-  opcodes_[0x56] = [&, hl]() { d_ = memory_.read(hl()); return 8; };
-  opcodes_[0x57] = [&]() { d_ = a_; return 4; };
-  opcodes_[0x58] = [&]() { e_ = b_; return 4; };
-  opcodes_[0x59] = [&]() { e_ = c_; return 4; };
-  opcodes_[0x5A] = [&]() { e_ = d_; return 4; };
-  opcodes_[0x5B] = [&]() { return 4; };
-  opcodes_[0x5C] = [&]() { e_ = h_; return 4; };
-  opcodes_[0x5D] = [&]() { e_ = l_; return 4; };
-  opcodes_[0x5E] = [&, hl]() { e_ = memory_.read(hl()); return 8; };
-  opcodes_[0x5F] = [&]() { e_ = a_; return 4; };
-
-  opcodes_[0x60] = [&]() { h_ = b_; return 4; };
-  opcodes_[0x61] = [&]() { h_ = c_; return 4; };
-  opcodes_[0x62] = [&]() { h_ = d_; return 4; };
-  opcodes_[0x63] = [&]() { h_ = e_; return 4; };
-  opcodes_[0x64] = [&]() { return 4; };
-  opcodes_[0x65] = [&]() { h_ = l_; return 4; };
-  opcodes_[0x66] = [&, hl]() { h_ = memory_.read(hl()); return 8; };
-  opcodes_[0x67] = [&]() { h_ = a_; return 4; };
-  opcodes_[0x68] = [&]() { l_ = b_; return 4; };
-  opcodes_[0x69] = [&]() { l_ = c_; return 4; };
-  opcodes_[0x6A] = [&]() { l_ = d_; return 4; };
-  opcodes_[0x6B] = [&]() { l_ = e_; return 4; };
-  opcodes_[0x6C] = [&]() { l_ = h_; return 4; };
-  opcodes_[0x6D] = [&]() { return 4; };
-  opcodes_[0x6E] = [&, hl]() { l_ = memory_.read(hl()); return 8; };
-  opcodes_[0x6F] = [&]() { l_ = a_; return 4; };
-
-  opcodes_[0x70] = [&, hl]() { memory_.write(hl(), b_); return 8; };
-  opcodes_[0x71] = [&, hl]() { memory_.write(hl(), c_); return 8; };
-  opcodes_[0x72] = [&, hl]() { memory_.write(hl(), d_); return 8; };
-  opcodes_[0x73] = [&, hl]() { memory_.write(hl(), e_); return 8; };
-  opcodes_[0x74] = [&, hl]() { memory_.write(hl(), h_); return 8; };
-  opcodes_[0x75] = [&, hl]() { memory_.write(hl(), l_); return 8; };
-
-  opcodes_[0x76] = [&]() { halt_ = true; return 4; };
-
-  opcodes_[0x77] = [&, hl]() { memory_.write(hl(), a_); return 8; };
-
-  opcodes_[0x78] = [&]() { a_ = b_; return 4; };
-  opcodes_[0x79] = [&]() { a_ = c_; return 4; };
-  opcodes_[0x7A] = [&]() { a_ = d_; return 4; };
-  opcodes_[0x7B] = [&]() { a_ = e_; return 4; };
-  opcodes_[0x7C] = [&]() { a_ = h_; return 4; };
-  opcodes_[0x7D] = [&]() { a_ = l_; return 4; };
-  opcodes_[0x7E] = [&, hl]() { a_ = memory_.read(hl()); return 8; };
-  opcodes_[0x7F] = [&]() { return 4; };
-
-  opcodes_[0x80] = [&]() { return add(b_); };
-  opcodes_[0x81] = [&]() { return add(c_); };
-  opcodes_[0x82] = [&]() { return add(d_); };
-  opcodes_[0x83] = [&]() { return add(e_); };
-  opcodes_[0x84] = [&]() { return add(h_); };
-  opcodes_[0x85] = [&]() { return add(l_); };
-  opcodes_[0x86] = [&, hl]() { return add(memory_.read(hl())) + 4; };
-  opcodes_[0x87] = [&]() { return add(a_); };
+  opcodes[0x0C] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.c); };
+  opcodes[0x1C] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.e); };
+  opcodes[0x2C] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.l); };
+  opcodes[0x3C] = [](CPU& cpu, Byte) { return cpu.inc(cpu.regs_.a); };
+
+  opcodes[0x0D] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.c); };
+  opcodes[0x1D] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.e); };
+  opcodes[0x2D] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.l); };
+  opcodes[0x3D] = [](CPU& cpu, Byte) { return cpu.dec(cpu.regs_.a); };
+
+  opcodes[0x0E] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+  opcodes[0x1E] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+  opcodes[0x2E] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+  opcodes[0x3E] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(cpu.regs_.pc++); return 8; };
+
+  opcodes[0x0F] = [](CPU& cpu, Byte) { cpu.rotateRight(cpu.regs_.a); cpu.regs_.zero = false; return 4; };
+  opcodes[0x1F] = [](CPU& cpu, Byte) { cpu.rotateRightCarry(cpu.regs_.a); cpu.regs_.zero = false; return 4; };
+  opcodes[0x2F] = [](CPU& cpu, Byte) { cpu.regs_.add = true; cpu.regs_.half_carry = true; cpu.regs_.a = ~cpu.regs_.a; return 4; };
+  opcodes[0x3F] = [](CPU& cpu, Byte) { cpu.regs_.add = false; cpu.regs_.half_carry = false; cpu.regs_.carry = !cpu.regs_.carry; return 4; };
+
+  opcodes[0x40] = [](CPU&, Byte) { return 4; };
+  opcodes[0x41] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.regs_.c; return 4; };
+  opcodes[0x42] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.regs_.d; return 4; };
+  opcodes[0x43] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.regs_.e; return 4; };
+  opcodes[0x44] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.regs_.h; return 4; };
+  opcodes[0x45] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.regs_.l; return 4; };
+  opcodes[0x46] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x47] = [](CPU& cpu, Byte) { cpu.regs_.b = cpu.regs_.a; return 4; };
+  opcodes[0x48] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.regs_.b; return 4; };
+  opcodes[0x49] = [](CPU&, Byte) { return 4; };
+  opcodes[0x4A] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.regs_.d; return 4; };
+  opcodes[0x4B] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.regs_.e; return 4; };
+  opcodes[0x4C] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.regs_.h; return 4; };
+  opcodes[0x4D] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.regs_.l; return 4; };
+  opcodes[0x4E] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x4F] = [](CPU& cpu, Byte) { cpu.regs_.c = cpu.regs_.a; return 4; };
+
+  opcodes[0x50] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.regs_.b; return 4; };
+  opcodes[0x51] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.regs_.c; return 4; };
+  opcodes[0x52] = [](CPU&, Byte) { return 4; };
+  opcodes[0x53] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.regs_.e; return 4; };
+  opcodes[0x54] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.regs_.h; return 4; };
+  opcodes[0x55] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.regs_.l; return 4; };
+  opcodes[0x56] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x57] = [](CPU& cpu, Byte) { cpu.regs_.d = cpu.regs_.a; return 4; };
+  opcodes[0x58] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.regs_.b; return 4; };
+  opcodes[0x59] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.regs_.c; return 4; };
+  opcodes[0x5A] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.regs_.d; return 4; };
+  opcodes[0x5B] = [](CPU&, Byte) { return 4; };
+  opcodes[0x5C] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.regs_.h; return 4; };
+  opcodes[0x5D] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.regs_.l; return 4; };
+  opcodes[0x5E] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x5F] = [](CPU& cpu, Byte) { cpu.regs_.e = cpu.regs_.a; return 4; };
+
+  opcodes[0x60] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.regs_.b; return 4; };
+  opcodes[0x61] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.regs_.c; return 4; };
+  opcodes[0x62] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.regs_.d; return 4; };
+  opcodes[0x63] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.regs_.e; return 4; };
+  opcodes[0x64] = [](CPU&, Byte) { return 4; };
+  opcodes[0x65] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.regs_.l; return 4; };
+  opcodes[0x66] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x67] = [](CPU& cpu, Byte) { cpu.regs_.h = cpu.regs_.a; return 4; };
+  opcodes[0x68] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.regs_.b; return 4; };
+  opcodes[0x69] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.regs_.c; return 4; };
+  opcodes[0x6A] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.regs_.d; return 4; };
+  opcodes[0x6B] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.regs_.e; return 4; };
+  opcodes[0x6C] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.regs_.h; return 4; };
+  opcodes[0x6D] = [](CPU&, Byte) { return 4; };
+  opcodes[0x6E] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x6F] = [](CPU& cpu, Byte) { cpu.regs_.l = cpu.regs_.a; return 4; };
+
+  opcodes[0x70] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.b); return 8; };
+  opcodes[0x71] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.c); return 8; };
+  opcodes[0x72] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.d); return 8; };
+  opcodes[0x73] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.e); return 8; };
+  opcodes[0x74] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.h); return 8; };
+  opcodes[0x75] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.l); return 8; };
+
+  opcodes[0x76] = [](CPU& cpu, Byte) { cpu.regs_.halt = true; return 4; };
+
+  opcodes[0x77] = [](CPU& cpu, Byte) { cpu.memory_.write(cpu.hl(), cpu.regs_.a); return 8; };
+
+  opcodes[0x78] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.regs_.b; return 4; };
+  opcodes[0x79] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.regs_.c; return 4; };
+  opcodes[0x7A] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.regs_.d; return 4; };
+  opcodes[0x7B] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.regs_.e; return 4; };
+  opcodes[0x7C] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.regs_.h; return 4; };
+  opcodes[0x7D] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.regs_.l; return 4; };
+  opcodes[0x7E] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(cpu.hl()); return 8; };
+  opcodes[0x7F] = [](CPU&, Byte) { return 4; };
+
+  opcodes[0x80] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.b); };
+  opcodes[0x81] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.c); };
+  opcodes[0x82] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.d); };
+  opcodes[0x83] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.e); };
+  opcodes[0x84] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.h); };
+  opcodes[0x85] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.l); };
+  opcodes[0x86] = [](CPU& cpu, Byte) { return cpu.add(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0x87] = [](CPU& cpu, Byte) { return cpu.add(cpu.regs_.a); };
   
-  opcodes_[0x88] = [&]() { return addCarry(b_); };
-  opcodes_[0x89] = [&]() { return addCarry(c_); };
-  opcodes_[0x8A] = [&]() { return addCarry(d_); };
-  opcodes_[0x8B] = [&]() { return addCarry(e_); };
-  opcodes_[0x8C] = [&]() { return addCarry(h_); };
-  opcodes_[0x8D] = [&]() { return addCarry(l_); };
-  opcodes_[0x8E] = [&, hl]() { return addCarry(memory_.read(hl())) + 4; };
-  opcodes_[0x8F] = [&]() { return addCarry(a_); };
+  opcodes[0x88] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.b); };
+  opcodes[0x89] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.c); };
+  opcodes[0x8A] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.d); };
+  opcodes[0x8B] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.e); };
+  opcodes[0x8C] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.h); };
+  opcodes[0x8D] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.l); };
+  opcodes[0x8E] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0x8F] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.regs_.a); };
   
-  opcodes_[0x90] = [&]() { return sub(b_); };
-  opcodes_[0x91] = [&]() { return sub(c_); };
-  opcodes_[0x92] = [&]() { return sub(d_); };
-  opcodes_[0x93] = [&]() { return sub(e_); };
-  opcodes_[0x94] = [&]() { return sub(h_); };
-  opcodes_[0x95] = [&]() { return sub(l_); };
-  opcodes_[0x96] = [&, hl]() { return sub(memory_.read(hl())) + 4; };
-  opcodes_[0x97] = [&]() { return sub(a_); };
+  opcodes[0x90] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.b); };
+  opcodes[0x91] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.c); };
+  opcodes[0x92] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.d); };
+  opcodes[0x93] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.e); };
+  opcodes[0x94] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.h); };
+  opcodes[0x95] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.l); };
+  opcodes[0x96] = [](CPU& cpu, Byte) { return cpu.sub(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0x97] = [](CPU& cpu, Byte) { return cpu.sub(cpu.regs_.a); };
   
-  opcodes_[0x98] = [&]() { return subCarry(b_); };
-  opcodes_[0x99] = [&]() { return subCarry(c_); };
-  opcodes_[0x9A] = [&]() { return subCarry(d_); };
-  opcodes_[0x9B] = [&]() { return subCarry(e_); };
-  opcodes_[0x9C] = [&]() { return subCarry(h_); };
-  opcodes_[0x9D] = [&]() { return subCarry(l_); };
-  opcodes_[0x9E] = [&, hl]() { return subCarry(memory_.read(hl())) + 4; };
-  opcodes_[0x9F] = [&]() { return subCarry(a_); };
+  opcodes[0x98] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.b); };
+  opcodes[0x99] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.c); };
+  opcodes[0x9A] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.d); };
+  opcodes[0x9B] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.e); };
+  opcodes[0x9C] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.h); };
+  opcodes[0x9D] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.l); };
+  opcodes[0x9E] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0x9F] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.regs_.a); };
   
-  opcodes_[0xA0] = [&]() { return handleAnd(b_); };
-  opcodes_[0xA1] = [&]() { return handleAnd(c_); };
-  opcodes_[0xA2] = [&]() { return handleAnd(d_); };
-  opcodes_[0xA3] = [&]() { return handleAnd(e_); };
-  opcodes_[0xA4] = [&]() { return handleAnd(h_); };
-  opcodes_[0xA5] = [&]() { return handleAnd(l_); };
-  opcodes_[0xA6] = [&, hl]() { return handleAnd(memory_.read(hl())) + 4; };
-  opcodes_[0xA7] = [&]() { return handleAnd(a_); };
-
-  opcodes_[0xA8] = [&]() { return handleXor(b_); };
-  opcodes_[0xA9] = [&]() { return handleXor(c_); };
-  opcodes_[0xAA] = [&]() { return handleXor(d_); };
-  opcodes_[0xAB] = [&]() { return handleXor(e_); };
-  opcodes_[0xAC] = [&]() { return handleXor(h_); };
-  opcodes_[0xAD] = [&]() { return handleXor(l_); };
-  opcodes_[0xAE] = [&, hl]() { return handleXor(memory_.read(hl())) + 4; };
-  opcodes_[0xAF] = [&]() { return handleXor(a_); };
-
-  opcodes_[0xB0] = [&]() { return handleOr(b_); };
-  opcodes_[0xB1] = [&]() { return handleOr(c_); };
-  opcodes_[0xB2] = [&]() { return handleOr(d_); };
-  opcodes_[0xB3] = [&]() { return handleOr(e_); };
-  opcodes_[0xB4] = [&]() { return handleOr(h_); };
-  opcodes_[0xB5] = [&]() { return handleOr(l_); };
-  opcodes_[0xB6] = [&, hl]() { return handleOr(memory_.read(hl())) + 4; };
-  opcodes_[0xB7] = [&]() { return handleOr(a_); };
+  opcodes[0xA0] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.b); };
+  opcodes[0xA1] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.c); };
+  opcodes[0xA2] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.d); };
+  opcodes[0xA3] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.e); };
+  opcodes[0xA4] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.h); };
+  opcodes[0xA5] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.l); };
+  opcodes[0xA6] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0xA7] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.regs_.a); };
+
+  opcodes[0xA8] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.b); };
+  opcodes[0xA9] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.c); };
+  opcodes[0xAA] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.d); };
+  opcodes[0xAB] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.e); };
+  opcodes[0xAC] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.h); };
+  opcodes[0xAD] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.l); };
+  opcodes[0xAE] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0xAF] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.regs_.a); };
+
+  opcodes[0xB0] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.b); };
+  opcodes[0xB1] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.c); };
+  opcodes[0xB2] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.d); };
+  opcodes[0xB3] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.e); };
+  opcodes[0xB4] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.h); };
+  opcodes[0xB5] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.l); };
+  opcodes[0xB6] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0xB7] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.regs_.a); };
   
-  opcodes_[0xB8] = [&]() { return compare(b_); };
-  opcodes_[0xB9] = [&]() { return compare(c_); };
-  opcodes_[0xBA] = [&]() { return compare(d_); };
-  opcodes_[0xBB] = [&]() { return compare(e_); };
-  opcodes_[0xBC] = [&]() { return compare(h_); };
-  opcodes_[0xBD] = [&]() { return compare(l_); };
-  opcodes_[0xBE] = [&, hl]() { return compare(memory_.read(hl())) + 4; };
-  opcodes_[0xBF] = [&]() { return compare(a_); };
-
-  opcodes_[0xC0] = [&]() { return ret(!zero_); };
-  opcodes_[0xD0] = [&]() { return ret(!carry_); };
-  opcodes_[0xE0] = [&]() { timer_.advance(4); memory_.write(0xFF00 + memory_.read(pc_++), a_); return 8; };
-  opcodes_[0xF0] = [&]() { timer_.advance(4); a_ = memory_.read(0xFF00 + memory_.read(pc_++)); return 8; };
-
-  opcodes_[0xC1] = [&]() { return pop(b_, c_); };
-  opcodes_[0xD1] = [&]() { return pop(d_, e_); };
-  opcodes_[0xE1] = [&]() { return pop(h_, l_); };
-  opcodes_[0xF1] = [&]() { pop(a_, f_); deserializeFlags(); return 12; };
-
-  opcodes_[0xC2] = [&]() { return jump16Data(!zero_); };
-  opcodes_[0xD2] = [&]() { return jump16Data(!carry_); };
-  opcodes_[0xE2] = [&]() { memory_.write(0xFF00 + c_, a_); return 8; };
-  opcodes_[0xF2] = [&]() { a_ = memory_.read(0xFF00 + c_); return 8; };
-
-  opcodes_[0xC3] = [&]() { return jump16Data(true); };
-  opcodes_[0xF3] = [&]() { interrupts_ = false; return 4; };
-
-  opcodes_[0xC4] = [&]() { return call16Data(!zero_); };
-  opcodes_[0xD4] = [&]() { return call16Data(!carry_); };
-
-  opcodes_[0xC5] = [&]() { return push(b_, c_); };
-  opcodes_[0xD5] = [&]() { return push(d_, e_); };
-  opcodes_[0xE5] = [&]() { return push(h_, l_); };
-  opcodes_[0xF5] = [&]() { return push(a_, f_); };
-
-  opcodes_[0xC6] = [&]() { return add(memory_.read(pc_++)) + 4; };
-  opcodes_[0xD6] = [&]() { return sub(memory_.read(pc_++)) + 4; };
-  opcodes_[0xE6] = [&]() { return handleAnd(memory_.read(pc_++)) + 4; };
-  opcodes_[0xF6] = [&]() { return handleOr(memory_.read(pc_++)) + 4; };
-
-  opcodes_[0xC7] = [&]() { return handleRst(0x00); };
-  opcodes_[0xD7] = [&]() { return handleRst(0x10); };
-  opcodes_[0xE7] = [&]() { return handleRst(0x20); };
-  opcodes_[0xF7] = [&]() { return handleRst(0x30); };
-
-  opcodes_[0xC8] = [&]() { return ret(zero_); };
-  opcodes_[0xD8] = [&]() { return ret(carry_); };
-  opcodes_[0xE8] = [&]() { return add8Stack(); };
-  opcodes_[0xF8] = [&]() { Word prev = sp_; add8Stack(); h_ = bits::high(sp_); l_ = bits::low(sp_); sp_ = prev; return 12; };
-
-  opcodes_[0xC9] = [&]() { ret(true); return 16; };
-  opcodes_[0xD9] = [&]() { ret(true); interrupts_ = true; return 16; };
-  opcodes_[0xE9] = [&, hl]() { pc_ = hl(); return 4; };
-  opcodes_[0xF9] = [&, hl]() { sp_ = hl(); return 8; };
-
-  opcodes_[0xCA] = [&]() { return jump16Data(zero_); };
-  opcodes_[0xDA] = [&]() { return jump16Data(carry_); };
-  opcodes_[0xEA] = [&]() { return write16DataAddress(); };
-  opcodes_[0xFA] = [&]() { return load16DataAddress(); };
-
-  opcodes_[0xCB] = [&]() {
-    Byte op = memory_.read(pc_++);
-    return cb_opcodes_[op]();
+  opcodes[0xB8] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.b); };
+  opcodes[0xB9] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.c); };
+  opcodes[0xBA] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.d); };
+  opcodes[0xBB] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.e); };
+  opcodes[0xBC] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.h); };
+  opcodes[0xBD] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.l); };
+  opcodes[0xBE] = [](CPU& cpu, Byte) { return cpu.compare(cpu.memory_.read(cpu.hl())) + 4; };
+  opcodes[0xBF] = [](CPU& cpu, Byte) { return cpu.compare(cpu.regs_.a); };
+
+  opcodes[0xC0] = [](CPU& cpu, Byte) { return cpu.ret(!cpu.regs_.zero); };
+  opcodes[0xD0] = [](CPU& cpu, Byte) { return cpu.ret(!cpu.regs_.carry); };
+  opcodes[0xE0] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); cpu.memory_.write(0xFF00 + cpu.memory_.read(cpu.regs_.pc++), cpu.regs_.a); return 8; };
+  opcodes[0xF0] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); cpu.regs_.a = cpu.memory_.read(0xFF00 + cpu.memory_.read(cpu.regs_.pc++)); return 8; };
+
+  opcodes[0xC1] = [](CPU& cpu, Byte) { return cpu.pop(cpu.regs_.b, cpu.regs_.c); };
+  opcodes[0xD1] = [](CPU& cpu, Byte) { return cpu.pop(cpu.regs_.d, cpu.regs_.e); };
+  opcodes[0xE1] = [](CPU& cpu, Byte) { return cpu.pop(cpu.regs_.h, cpu.regs_.l); };
+  opcodes[0xF1] = [](CPU& cpu, Byte) { cpu.pop(cpu.regs_.a, cpu.regs_.f); cpu.deserializeFlags(); return 12; };
+
+  opcodes[0xC2] = [](CPU& cpu, Byte) { return cpu.jump16Data(!cpu.regs_.zero); };
+  opcodes[0xD2] = [](CPU& cpu, Byte) { return cpu.jump16Data(!cpu.regs_.carry); };
+  opcodes[0xE2] = [](CPU& cpu, Byte) { cpu.memory_.write(0xFF00 + cpu.regs_.c, cpu.regs_.a); return 8; };
+  opcodes[0xF2] = [](CPU& cpu, Byte) { cpu.regs_.a = cpu.memory_.read(0xFF00 + cpu.regs_.c); return 8; };
+
+  opcodes[0xC3] = [](CPU& cpu, Byte) { return cpu.jump16Data(true); };
+  opcodes[0xF3] = [](CPU& cpu, Byte) { cpu.regs_.interrupts = false; return 4; };
+
+  opcodes[0xC4] = [](CPU& cpu, Byte) { return cpu.call16Data(!cpu.regs_.zero); };
+  opcodes[0xD4] = [](CPU& cpu, Byte) { return cpu.call16Data(!cpu.regs_.carry); };
+
+  opcodes[0xC5] = [](CPU& cpu, Byte) { return cpu.push(cpu.regs_.b, cpu.regs_.c); };
+  opcodes[0xD5] = [](CPU& cpu, Byte) { return cpu.push(cpu.regs_.d, cpu.regs_.e); };
+  opcodes[0xE5] = [](CPU& cpu, Byte) { return cpu.push(cpu.regs_.h, cpu.regs_.l); };
+  opcodes[0xF5] = [](CPU& cpu, Byte) { return cpu.push(cpu.regs_.a, cpu.regs_.f); };
+
+  opcodes[0xC6] = [](CPU& cpu, Byte) { return cpu.add(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+  opcodes[0xD6] = [](CPU& cpu, Byte) { return cpu.sub(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+  opcodes[0xE6] = [](CPU& cpu, Byte) { return cpu.handleAnd(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+  opcodes[0xF6] = [](CPU& cpu, Byte) { return cpu.handleOr(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+
+  opcodes[0xC7] = [](CPU& cpu, Byte) { return cpu.handleRst(0x00); };
+  opcodes[0xD7] = [](CPU& cpu, Byte) { return cpu.handleRst(0x10); };
+  opcodes[0xE7] = [](CPU& cpu, Byte) { return cpu.handleRst(0x20); };
+  opcodes[0xF7] = [](CPU& cpu, Byte) { return cpu.handleRst(0x30); };
+
+  opcodes[0xC8] = [](CPU& cpu, Byte) { return cpu.ret(cpu.regs_.zero); };
+  opcodes[0xD8] = [](CPU& cpu, Byte) { return cpu.ret(cpu.regs_.carry); };
+  opcodes[0xE8] = [](CPU& cpu, Byte) { return cpu.add8Stack(); };
+  opcodes[0xF8] = [](CPU& cpu, Byte) { Word prev = cpu.regs_.sp; cpu.add8Stack(); cpu.regs_.h = bits::high(cpu.regs_.sp); cpu.regs_.l = bits::low(cpu.regs_.sp); cpu.regs_.sp = prev; return 12; };
+
+  opcodes[0xC9] = [](CPU& cpu, Byte) { cpu.ret(true); return 16; };
+  opcodes[0xD9] = [](CPU& cpu, Byte) { cpu.ret(true); cpu.regs_.interrupts = true; return 16; };
+  opcodes[0xE9] = [](CPU& cpu, Byte) { cpu.regs_.pc = cpu.hl(); return 4; };
+  opcodes[0xF9] = [](CPU& cpu, Byte) { cpu.regs_.sp = cpu.hl(); return 8; };
+
+  opcodes[0xCA] = [](CPU& cpu, Byte) { return cpu.jump16Data(cpu.regs_.zero); };
+  opcodes[0xDA] = [](CPU& cpu, Byte) { return cpu.jump16Data(cpu.regs_.carry); };
+  opcodes[0xEA] = [](CPU& cpu, Byte) { return cpu.write16DataAddress(); };
+  opcodes[0xFA] = [](CPU& cpu, Byte) { return cpu.load16DataAddress(); };
+
+  opcodes[0xCB] = [](CPU& cpu, Byte) {
+    Byte op = cpu.memory_.read(cpu.regs_.pc++);
+    return cb_opcodes_[op](cpu, op);
   };
-  opcodes_[0xFB] = [&]() { interrupts_ = true; return 4; };
+  opcodes[0xFB] = [](CPU& cpu, Byte) { cpu.regs_.interrupts = true; return 4; };
 
-  opcodes_[0xCC] = [&]() { return call16Data(zero_); };
-  opcodes_[0xDC] = [&]() { return call16Data(carry_); };
+  opcodes[0xCC] = [](CPU& cpu, Byte) { return cpu.call16Data(cpu.regs_.zero); };
+  opcodes[0xDC] = [](CPU& cpu, Byte) { return cpu.call16Data(cpu.regs_.carry); };
 
-  opcodes_[0xCD] = [&]() { return call16Data(true); };
+  opcodes[0xCD] = [](CPU& cpu, Byte) { return cpu.call16Data(true); };
 
-  opcodes_[0xCE] = [&]() { return addCarry(memory_.read(pc_++)) + 4; };
-  opcodes_[0xDE] = [&]() { return subCarry(memory_.read(pc_++)) + 4; };
-  opcodes_[0xEE] = [&]() { return handleXor(memory_.read(pc_++)) + 4; };
-  opcodes_[0xFE] = [&]() { return compare(memory_.read(pc_++)) + 4; };
+  opcodes[0xCE] = [](CPU& cpu, Byte) { return cpu.addCarry(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+  opcodes[0xDE] = [](CPU& cpu, Byte) { return cpu.subCarry(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+  opcodes[0xEE] = [](CPU& cpu, Byte) { return cpu.handleXor(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
+  opcodes[0xFE] = [](CPU& cpu, Byte) { return cpu.compare(cpu.memory_.read(cpu.regs_.pc++)) + 4; };
   
-  opcodes_[0xCF] = [&]() { return handleRst(0x08); };
-  opcodes_[0xDF] = [&]() { return handleRst(0x18); };
-  opcodes_[0xEF] = [&]() { return handleRst(0x28); };
-  opcodes_[0xFF] = [&]() { return handleRst(0x38); };
+  opcodes[0xCF] = [](CPU& cpu, Byte) { return cpu.handleRst(0x08); };
+  opcodes[0xDF] = [](CPU& cpu, Byte) { return cpu.handleRst(0x18); };
+  opcodes[0xEF] = [](CPU& cpu, Byte) { return cpu.handleRst(0x28); };
+  opcodes[0xFF] = [](CPU& cpu, Byte) { return cpu.handleRst(0x38); };
 
   // clang-format on
+  return opcodes;
 }
 
-void CPU::setupCbOpcodes() {
-  // Helper functions
-  auto hl = [&]() { return bits::assemble(h_, l_); };
+CPU::Opcodes CPU::makeCbOpcodes() {
+  Opcodes cb_opcodes;
 
   // clang-format off
-  cb_opcodes_[0x00] = [&]() { return rotateLeft(b_); };
-  cb_opcodes_[0x01] = [&]() { return rotateLeft(c_); };
-  cb_opcodes_[0x02] = [&]() { return rotateLeft(d_); };
-  cb_opcodes_[0x03] = [&]() { return rotateLeft(e_); };
-  cb_opcodes_[0x04] = [&]() { return rotateLeft(h_); };
-  cb_opcodes_[0x05] = [&]() { return rotateLeft(l_); };
-  cb_opcodes_[0x06] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); rotateLeft(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x07] = [&]() { return rotateLeft(a_); };
-
-  cb_opcodes_[0x08] = [&]() { return rotateRight(b_); };
-  cb_opcodes_[0x09] = [&]() { return rotateRight(c_); };
-  cb_opcodes_[0x0A] = [&]() { return rotateRight(d_); };
-  cb_opcodes_[0x0B] = [&]() { return rotateRight(e_); };
-  cb_opcodes_[0x0C] = [&]() { return rotateRight(h_); };
-  cb_opcodes_[0x0D] = [&]() { return rotateRight(l_); };
-  cb_opcodes_[0x0E] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); rotateRight(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x0F] = [&]() { return rotateRight(a_); };
-
-  cb_opcodes_[0x10] = [&]() { return rotateLeftCarry(b_); };
-  cb_opcodes_[0x11] = [&]() { return rotateLeftCarry(c_); };
-  cb_opcodes_[0x12] = [&]() { return rotateLeftCarry(d_); };
-  cb_opcodes_[0x13] = [&]() { return rotateLeftCarry(e_); };
-  cb_opcodes_[0x14] = [&]() { return rotateLeftCarry(h_); };
-  cb_opcodes_[0x15] = [&]() { return rotateLeftCarry(l_); };
-  cb_opcodes_[0x16] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); rotateLeftCarry(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x17] = [&]() { return rotateLeftCarry(a_); };
-
-  cb_opcodes_[0x18] = [&]() { return rotateRightCarry(b_); };
-  cb_opcodes_[0x19] = [&]() { return rotateRightCarry(c_); };
-  cb_opcodes_[0x1A] = [&]() { return rotateRightCarry(d_); };
-  cb_opcodes_[0x1B] = [&]() { return rotateRightCarry(e_); };
-  cb_opcodes_[0x1C] = [&]() { return rotateRightCarry(h_); };
-  cb_opcodes_[0x1D] = [&]() { return rotateRightCarry(l_); };
-  cb_opcodes_[0x1E] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); rotateRightCarry(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x1F] = [&]() { return rotateRightCarry(a_); };
-
-  cb_opcodes_[0x20] = [&]() { return shiftLeftLogical(b_); };
-  cb_opcodes_[0x21] = [&]() { return shiftLeftLogical(c_); };
-  cb_opcodes_[0x22] = [&]() { return shiftLeftLogical(d_); };
-  cb_opcodes_[0x23] = [&]() { return shiftLeftLogical(e_); };
-  cb_opcodes_[0x24] = [&]() { return shiftLeftLogical(h_); };
-  cb_opcodes_[0x25] = [&]() { return shiftLeftLogical(l_); };
-  cb_opcodes_[0x26] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); shiftLeftLogical(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x27] = [&]() { return shiftLeftLogical(a_); };
-
-  cb_opcodes_[0x28] = [&]() { return shiftRight(b_); };
-  cb_opcodes_[0x29] = [&]() { return shiftRight(c_); };
-  cb_opcodes_[0x2A] = [&]() { return shiftRight(d_); };
-  cb_opcodes_[0x2B] = [&]() { return shiftRight(e_); };
-  cb_opcodes_[0x2C] = [&]() { return shiftRight(h_); };
-  cb_opcodes_[0x2D] = [&]() { return shiftRight(l_); };
-  cb_opcodes_[0x2E] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); shiftRight(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x2F] = [&]() { return shiftRight(a_); };
-
-  cb_opcodes_[0x30] = [&]() { return handleSwap(b_); };
-  cb_opcodes_[0x31] = [&]() { return handleSwap(c_); };
-  cb_opcodes_[0x32] = [&]() { return handleSwap(d_); };
-  cb_opcodes_[0x33] = [&]() { return handleSwap(e_); };
-  cb_opcodes_[0x34] = [&]() { return handleSwap(h_); };
-  cb_opcodes_[0x35] = [&]() { return handleSwap(l_); };
-  cb_opcodes_[0x36] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); handleSwap(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x37] = [&]() { return handleSwap(a_); };
-
-  cb_opcodes_[0x38] = [&]() { return shiftRightLogical(b_); };
-  cb_opcodes_[0x39] = [&]() { return shiftRightLogical(c_); };
-  cb_opcodes_[0x3A] = [&]() { return shiftRightLogical(d_); };
-  cb_opcodes_[0x3B] = [&]() { return shiftRightLogical(e_); };
-  cb_opcodes_[0x3C] = [&]() { return shiftRightLogical(h_); };
-  cb_opcodes_[0x3D] = [&]() { return shiftRightLogical(l_); };
-  cb_opcodes_[0x3E] = [&, hl]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); shiftRightLogical(byte); memory_.write(hl(), byte); return 8; };
-  cb_opcodes_[0x3F] = [&]() { return shiftRightLogical(a_); };
+  cb_opcodes[0x00] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.b); };
+  cb_opcodes[0x01] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.c); };
+  cb_opcodes[0x02] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.d); };
+  cb_opcodes[0x03] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.e); };
+  cb_opcodes[0x04] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.h); };
+  cb_opcodes[0x05] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.l); };
+  cb_opcodes[0x06] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.rotateLeft(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x07] = [](CPU& cpu, Byte) { return cpu.rotateLeft(cpu.regs_.a); };
+
+  cb_opcodes[0x08] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.b); };
+  cb_opcodes[0x09] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.c); };
+  cb_opcodes[0x0A] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.d); };
+  cb_opcodes[0x0B] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.e); };
+  cb_opcodes[0x0C] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.h); };
+  cb_opcodes[0x0D] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.l); };
+  cb_opcodes[0x0E] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.rotateRight(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x0F] = [](CPU& cpu, Byte) { return cpu.rotateRight(cpu.regs_.a); };
+
+  cb_opcodes[0x10] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.b); };
+  cb_opcodes[0x11] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.c); };
+  cb_opcodes[0x12] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.d); };
+  cb_opcodes[0x13] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.e); };
+  cb_opcodes[0x14] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.h); };
+  cb_opcodes[0x15] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.l); };
+  cb_opcodes[0x16] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.rotateLeftCarry(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x17] = [](CPU& cpu, Byte) { return cpu.rotateLeftCarry(cpu.regs_.a); };
+
+  cb_opcodes[0x18] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.b); };
+  cb_opcodes[0x19] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.c); };
+  cb_opcodes[0x1A] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.d); };
+  cb_opcodes[0x1B] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.e); };
+  cb_opcodes[0x1C] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.h); };
+  cb_opcodes[0x1D] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.l); };
+  cb_opcodes[0x1E] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.rotateRightCarry(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x1F] = [](CPU& cpu, Byte) { return cpu.rotateRightCarry(cpu.regs_.a); };
+
+  cb_opcodes[0x20] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.b); };
+  cb_opcodes[0x21] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.c); };
+  cb_opcodes[0x22] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.d); };
+  cb_opcodes[0x23] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.e); };
+  cb_opcodes[0x24] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.h); };
+  cb_opcodes[0x25] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.l); };
+  cb_opcodes[0x26] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.shiftLeftLogical(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x27] = [](CPU& cpu, Byte) { return cpu.shiftLeftLogical(cpu.regs_.a); };
+
+  cb_opcodes[0x28] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.b); };
+  cb_opcodes[0x29] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.c); };
+  cb_opcodes[0x2A] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.d); };
+  cb_opcodes[0x2B] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.e); };
+  cb_opcodes[0x2C] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.h); };
+  cb_opcodes[0x2D] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.l); };
+  cb_opcodes[0x2E] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.shiftRight(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x2F] = [](CPU& cpu, Byte) { return cpu.shiftRight(cpu.regs_.a); };
+
+  cb_opcodes[0x30] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.b); };
+  cb_opcodes[0x31] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.c); };
+  cb_opcodes[0x32] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.d); };
+  cb_opcodes[0x33] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.e); };
+  cb_opcodes[0x34] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.h); };
+  cb_opcodes[0x35] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.l); };
+  cb_opcodes[0x36] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.handleSwap(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x37] = [](CPU& cpu, Byte) { return cpu.handleSwap(cpu.regs_.a); };
+
+  cb_opcodes[0x38] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.b); };
+  cb_opcodes[0x39] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.c); };
+  cb_opcodes[0x3A] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.d); };
+  cb_opcodes[0x3B] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.e); };
+  cb_opcodes[0x3C] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.h); };
+  cb_opcodes[0x3D] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.l); };
+  cb_opcodes[0x3E] = [](CPU& cpu, Byte) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.shiftRightLogical(byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+  cb_opcodes[0x3F] = [](CPU& cpu, Byte) { return cpu.shiftRightLogical(cpu.regs_.a); };
 
   for (int i = 0; i < 8; i++) {
-    cb_opcodes_[0x40 + i * 8] = [i, this]() { return handleBit(i, b_); };
-    cb_opcodes_[0x41 + i * 8] = [i, this]() { return handleBit(i, c_); };
-    cb_opcodes_[0x42 + i * 8] = [i, this]() { return handleBit(i, d_); };
-    cb_opcodes_[0x43 + i * 8] = [i, this]() { return handleBit(i, e_); };
-    cb_opcodes_[0x44 + i * 8] = [i, this]() { return handleBit(i, h_); };
-    cb_opcodes_[0x45 + i * 8] = [i, this]() { return handleBit(i, l_); };
-    cb_opcodes_[0x46 + i * 8] = [hl, i, this]() { timer_.advance(4); return handleBit(i, memory_.read(hl())); };
-    cb_opcodes_[0x47 + i * 8] = [i, this]() { return handleBit(i, a_); };
+    cb_opcodes[0x40 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.b); };
+    cb_opcodes[0x41 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.c); };
+    cb_opcodes[0x42 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.d); };
+    cb_opcodes[0x43 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.e); };
+    cb_opcodes[0x44 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.h); };
+    cb_opcodes[0x45 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.l); };
+    cb_opcodes[0x46 + i * 8] = [](CPU& cpu, Byte op) { cpu.timer_.advance(4); return cpu.handleBit((op >> 3) & 7, cpu.memory_.read(cpu.hl())); };
+    cb_opcodes[0x47 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleBit((op >> 3) & 7, cpu.regs_.a); };
   }
   for (int i = 0; i < 8; i++) {
-    cb_opcodes_[0x80 + i * 8] = [i, this]() { return handleRes(i, b_); };
-    cb_opcodes_[0x81 + i * 8] = [i, this]() { return handleRes(i, c_); };
-    cb_opcodes_[0x82 + i * 8] = [i, this]() { return handleRes(i, d_); };
-    cb_opcodes_[0x83 + i * 8] = [i, this]() { return handleRes(i, e_); };
-    cb_opcodes_[0x84 + i * 8] = [i, this]() { return handleRes(i, h_); };
-    cb_opcodes_[0x85 + i * 8] = [i, this]() { return handleRes(i, l_); };
-    cb_opcodes_[0x86 + i * 8] = [hl, i, this]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); handleRes(i, byte); memory_.write(hl(), byte); return 8; };
-    cb_opcodes_[0x87 + i * 8] = [i, this]() { return handleRes(i, a_); };
+    cb_opcodes[0x80 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.b); };
+    cb_opcodes[0x81 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.c); };
+    cb_opcodes[0x82 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.d); };
+    cb_opcodes[0x83 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.e); };
+    cb_opcodes[0x84 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.h); };
+    cb_opcodes[0x85 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.l); };
+    cb_opcodes[0x86 + i * 8] = [](CPU& cpu, Byte op) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.handleRes((op >> 3) & 7, byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+    cb_opcodes[0x87 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleRes((op >> 3) & 7, cpu.regs_.a); };
   }
   for (int i = 0; i < 8; i++) {
-    cb_opcodes_[0xC0 + i * 8] = [i, this]() { return handleSet(i, b_); };
-    cb_opcodes_[0xC1 + i * 8] = [i, this]() { return handleSet(i, c_); };
-    cb_opcodes_[0xC2 + i * 8] = [i, this]() { return handleSet(i, d_); };
-    cb_opcodes_[0xC3 + i * 8] = [i, this]() { return handleSet(i, e_); };
-    cb_opcodes_[0xC4 + i * 8] = [i, this]() { return handleSet(i, h_); };
-    cb_opcodes_[0xC5 + i * 8] = [i, this]() { return handleSet(i, l_); };
-    cb_opcodes_[0xC6 + i * 8] = [hl, i, this]() { timer_.advance(4); Byte byte = memory_.read(hl()); timer_.advance(4); handleSet(i, byte); memory_.write(hl(), byte); return 8; };
-    cb_opcodes_[0xC7 + i * 8] = [i, this]() { return handleSet(i, a_); };
+    cb_opcodes[0xC0 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.b); };
+    cb_opcodes[0xC1 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.c); };
+    cb_opcodes[0xC2 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.d); };
+    cb_opcodes[0xC3 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.e); };
+    cb_opcodes[0xC4 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.h); };
+    cb_opcodes[0xC5 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.l); };
+    cb_opcodes[0xC6 + i * 8] = [](CPU& cpu, Byte op) { cpu.timer_.advance(4); Byte byte = cpu.memory_.read(cpu.hl()); cpu.timer_.advance(4); cpu.handleSet((op >> 3) & 7, byte); cpu.memory_.write(cpu.hl(), byte); return 8; };
+    cb_opcodes[0xC7 + i * 8] = [](CPU& cpu, Byte op) { return cpu.handleSet((op >> 3) & 7, cpu.regs_.a); };
   }
   // clang-format on
+  return cb_opcodes;
 }
 
 int CPU::load16Data(Byte& high, Byte& low) {
-  low = memory_.read(pc_++);
-  high = memory_.read(pc_++);
+  low = memory_.read(regs_.pc++);
+  high = memory_.read(regs_.pc++);
 
   return 12;
 }
 
 int CPU::write16DataAddress() {
-  Byte low = memory_.read(pc_++);
+  Byte low = memory_.read(regs_.pc++);
   timer_.advance(4);
-  Byte high = memory_.read(pc_++);
+  Byte high = memory_.read(regs_.pc++);
   timer_.advance(4);
   Word word = bits::assemble(high, low);
 
-  memory_.write(word, a_);
+  memory_.write(word, regs_.a);
 
   return 8;
 }
 
 int CPU::load16DataAddress() {
-  Byte low = memory_.read(pc_++);
-  Byte high = memory_.read(pc_++);
+  Byte low = memory_.read(regs_.pc++);
+  Byte high = memory_.read(regs_.pc++);
   timer_.advance(8);
   Word word = bits::assemble(high, low);
 
-  a_ = memory_.read(word);
+  regs_.a = memory_.read(word);
 
   return 8;
 }
 
 int CPU::jumpRelative8Data(bool jump) {
-  SByte address = memory_.read(pc_++);
+  SByte address = memory_.read(regs_.pc++);
   if (jump) {
-    pc_ += address;
+    regs_.pc += address;
     return 12;
   }
   return 8;
 }
 
 int CPU::jump16Data(bool jump) {
-  Byte low = memory_.read(pc_++);
-  Byte high = memory_.read(pc_++);
+  Byte low = memory_.read(regs_.pc++);
+  Byte high = memory_.read(regs_.pc++);
   Word word = bits::assemble(high, low);
 
   if (jump) {
-    pc_ = word;
+    regs_.pc = word;
     return 16;
   }
   return 12;
 }
 
 int CPU::call16Data(bool jump) {
-  Byte low = memory_.read(pc_++);
-  Byte high = memory_.read(pc_++);
+  Byte low = memory_.read(regs_.pc++);
+  Byte high = memory_.read(regs_.pc++);
   Word word = bits::assemble(high, low);
 
   if (jump) {
-    push(bits::high(pc_), bits::low(pc_));
-    pc_ = word;
+    push(bits::high(regs_.pc), bits::low(regs_.pc));
+    regs_.pc = word;
     return 24;
   }
   return 12;
@@ -587,143 +605,143 @@ int CPU::ret(bool jump) {
   if (jump) {
     Byte high, low;
     pop(high, low);
-    pc_ = bits::assemble(high, low);
+    regs_.pc = bits::assemble(high, low);
     return 20;
   }
   return 8;
 }
 
 int CPU::inc(Byte& byte) {
-  add_ = false;
+  regs_.add = false;
 
-  half_carry_ = ((byte & 0x0F) == 0x0F);
+  regs_.half_carry = ((byte & 0x0F) == 0x0F);
   byte++;
-  zero_ = byte == 0;
+  regs_.zero = byte == 0;
 
   return 4;
 }
 
 int CPU::dec(Byte& byte) {
-  add_ = true;
+  regs_.add = true;
 
-  half_carry_ = ((byte & 0x0F) == 0x00);
+  regs_.half_carry = ((byte & 0x0F) == 0x00);
   byte--;
-  zero_ = byte == 0;
+  regs_.zero = byte == 0;
 
   return 4;
 }
 
 int CPU::addHl(Word word) {
-  add_ = false;
+  regs_.add = false;
 
-  Word hl = bits::assemble(h_, l_);
+  Word hl = bits::assemble(regs_.h, regs_.l);
   int result = hl + word;
-  carry_ = result & 0x10000;
+  regs_.carry = result & 0x10000;
   result &= 0xFFFF;
-  half_carry_ = (hl ^ word ^ result) & 0x1000;
+  regs_.half_carry = (hl ^ word ^ result) & 0x1000;
 
-  h_ = bits::high(result);
-  l_ = bits::low(result);
+  regs_.h = bits::high(result);
+  regs_.l = bits::low(result);
 
   return 8;
 }
 
 int CPU::add(Byte byte) {
-  int result = a_ + byte;
-  add_ = false;
-  carry_ = (a_ ^ byte ^ result) & 0x100;
-  half_carry_ = (a_ ^ byte ^ result) & 0x10;
+  int result = regs_.a + byte;
+  regs_.add = false;
+  regs_.carry = (regs_.a ^ byte ^ result) & 0x100;
+  regs_.half_carry = (regs_.a ^ byte ^ result) & 0x10;
   result &= 0xFF;
-  zero_ = result == 0;
-  a_ = result;
+  regs_.zero = result == 0;
+  regs_.a = result;
 
   return 4;
 }
 
 int CPU::addCarry(Byte byte) {
-  int carry = carry_ ? 1 : 0;
-  int result = a_ + byte + carry;
+  int carry = regs_.carry ? 1 : 0;
+  int result = regs_.a + byte + carry;
 
-  add_ = false;
+  regs_.add = false;
 
-  carry_ = result > 0xFF;
-  half_carry_ = ((a_ & 0x0F) + (byte & 0x0F) + carry) > 0x0F;
+  regs_.carry = result > 0xFF;
+  regs_.half_carry = ((regs_.a & 0x0F) + (byte & 0x0F) + carry) > 0x0F;
 
   result &= 0xFF;
-  zero_ = result == 0;
+  regs_.zero = result == 0;
 
-  a_ = result;
+  regs_.a = result;
 
   return 4;
 }
 
 int CPU::sub(Byte byte) {
-  int result = a_ - byte;
+  int result = regs_.a - byte;
 
-  add_ = true;
+  regs_.add = true;
 
-  carry_ = (a_ ^ byte ^ result) & 0x100;
-  half_carry_ = (a_ ^ byte ^ result) & 0x10;
+  regs_.carry = (regs_.a ^ byte ^ result) & 0x100;
+  regs_.half_carry = (regs_.a ^ byte ^ result) & 0x10;
 
   result &= 0xFF;
-  zero_ = result == 0;
+  regs_.zero = result == 0;
 
-  a_ = result;
+  regs_.a = result;
 
   return 4;
 }
 
 int CPU::subCarry(Byte byte) {
-  int carry = carry_ ? 1 : 0;
-  int result = a_ - byte - carry;
+  int carry = regs_.carry ? 1 : 0;
+  int result = regs_.a - byte - carry;
 
-  add_ = true;
+  regs_.add = true;
 
-  carry_ = result < 0;
-  half_carry_ = ((a_ & 0x0F) - (byte & 0x0F) - carry) < 0;
+  regs_.carry = result < 0;
+  regs_.half_carry = ((regs_.a & 0x0F) - (byte & 0x0F) - carry) < 0;
 
   result &= 0xFF;
-  zero_ = result == 0;
+  regs_.zero = result == 0;
 
-  a_ = result;
+  regs_.a = result;
 
   return 4;
 }
 
 int CPU::compare(Byte byte) {
-  Byte a = a_;
+  Byte a = regs_.a;
   sub(byte);
-  a_ = a;
+  regs_.a = a;
 
   return 4;
 }
 
 int CPU::handleAnd(Byte byte) {
-  a_ &= byte;
+  regs_.a &= byte;
 
-  zero_ = a_ == 0;
-  add_ = 0;
-  half_carry_ = 1;
-  carry_ = 0;
+  regs_.zero = regs_.a == 0;
+  regs_.add = 0;
+  regs_.half_carry = 1;
+  regs_.carry = 0;
 
   return 4;
 }
 
 int CPU::handleXor(Byte byte) {
-  a_ ^= byte;
+  regs_.a ^= byte;
   clearFlags();
-  zero_ = a_ == 0;
+  regs_.zero = regs_.a == 0;
 
   return 4;
 }
 
 int CPU::handleOr(Byte byte) {
-  a_ |= byte;
+  regs_.a |= byte;
 
-  zero_ = a_ == 0;
-  add_ = 0;
-  half_carry_ = 0;
-  carry_ = 0;
+  regs_.zero = regs_.a == 0;
+  regs_.add = 0;
+  regs_.half_carry = 0;
+  regs_.carry = 0;
 
   return 4;
 }
@@ -733,18 +751,18 @@ int CPU::handleSwap(Byte& byte) {
   byte >>= 4;
   byte |= (temp << 4);
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
-  carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
+  regs_.carry = false;
 
   return 8;
 }
 
 int CPU::handleBit(int bit, Byte byte) {
-  zero_ = !bits::bit(byte, bit);
-  add_ = false;
-  half_carry_ = true;
+  regs_.zero = !bits::bit(byte, bit);
+  regs_.add = false;
+  regs_.half_carry = true;
 
   return 8;
 }
@@ -762,155 +780,155 @@ int CPU::handleSet(int bit, Byte& byte) {
 }
 
 int CPU::handleRst(Byte offset) {
-  push(bits::high(pc_), bits::low(pc_));
-  pc_ = offset;
+  push(bits::high(regs_.pc), bits::low(regs_.pc));
+  regs_.pc = offset;
 
   return 16;
 }
 
 int CPU::pop(Byte& high, Byte& low) {
-  low = memory_.read(sp_++);
-  high = memory_.read(sp_++);
+  low = memory_.read(regs_.sp++);
+  high = memory_.read(regs_.sp++);
 
   return 12;
 }
 
 int CPU::push(Byte high, Byte low) {
-  memory_.write(--sp_, high);
-  memory_.write(--sp_, low);
+  memory_.write(--regs_.sp, high);
+  memory_.write(--regs_.sp, low);
 
   return 16;
 }
 
 int CPU::add8Stack() {
-  SByte byte = memory_.read(pc_++);
-  zero_ = false;
-  add_ = false;
+  SByte byte = memory_.read(regs_.pc++);
+  regs_.zero = false;
+  regs_.add = false;
 
-  Word result = sp_ + byte;
-  carry_ = (sp_ ^ byte ^ result) & 0x100;
-  half_carry_ = (sp_ ^ byte ^ result) & 0x10;
-  sp_ = result;
+  Word result = regs_.sp + byte;
+  regs_.carry = (regs_.sp ^ byte ^ result) & 0x100;
+  regs_.half_carry = (regs_.sp ^ byte ^ result) & 0x10;
+  regs_.sp = result;
 
   return 16;
 }
 
 int CPU::rotateLeft(Byte& byte) {
-  carry_ = bits::bit(byte, 7);
+  regs_.carry = bits::bit(byte, 7);
   byte <<= 1;
-  if (carry_) {
+  if (regs_.carry) {
     byte |= 1;
   }
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
 
   return 8;
 }
 
 int CPU::rotateLeftCarry(Byte& byte) {
-  bool carry = carry_;
-  carry_ = bits::bit(byte, 7);
+  bool carry = regs_.carry;
+  regs_.carry = bits::bit(byte, 7);
   byte <<= 1;
   if (carry) {
     byte |= 1;
   }
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
 
   return 8;
 }
 
 int CPU::rotateRight(Byte& byte) {
-  carry_ = byte & 1;
+  regs_.carry = byte & 1;
   byte >>= 1;
-  bits::setBit(byte, 7, carry_);
+  bits::setBit(byte, 7, regs_.carry);
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
   return 8;
 }
 
 int CPU::rotateRightCarry(Byte& byte) {
-  bool carry = carry_;
-  carry_ = byte & 1;
+  bool carry = regs_.carry;
+  regs_.carry = byte & 1;
 
   byte >>= 1;
   bits::setBit(byte, 7, carry);
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
 
   return 8;
 }
 
 int CPU::shiftLeftLogical(Byte& byte) {
-  carry_ = byte & 0x80;
+  regs_.carry = byte & 0x80;
   byte <<= 1;
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
 
   return 8;
 }
 
 int CPU::shiftRightLogical(Byte& byte) {
-  carry_ = byte & 1;
+  regs_.carry = byte & 1;
   byte >>= 1;
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
 
   return 8;
 }
 
 int CPU::shiftRight(Byte& byte) {
   Byte msb = byte & 0x80;
-  carry_ = byte & 1;
+  regs_.carry = byte & 1;
   byte >>= 1;
   byte |= msb;
 
-  zero_ = byte == 0;
-  add_ = false;
-  half_carry_ = false;
+  regs_.zero = byte == 0;
+  regs_.add = false;
+  regs_.half_carry = false;
 
   return 8;
 }
 
 int CPU::daa() {
-  int a = a_;
+  int a = regs_.a;
 
-  if (!add_) {
-    if ((a & 0x0F) > 0x09 || half_carry_) {
+  if (!regs_.add) {
+    if ((a & 0x0F) > 0x09 || regs_.half_carry) {
       a += 0x06;
     }
-    if (a > 0x9F || carry_) {
+    if (a > 0x9F || regs_.carry) {
       a += 0x60;
     }
   } else {
-    if (half_carry_) {
+    if (regs_.half_carry) {
       a = (a - 0x06) & 0xFF;
     }
-    if (carry_) {
+    if (regs_.carry) {
       a -= 0x60;
     }
   }
 
-  half_carry_ = false;
+  regs_.half_carry = false;
   if ((a & 0x100) == 0x100) {
-    carry_ = true;
+    regs_.carry = true;
   }
 
   a &= 0xFF;
-  zero_ = a == 0;
+  regs_.zero = a == 0;
 
-  a_ = a;
+  regs_.a = a;
 
   return 4;
 }
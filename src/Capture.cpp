@@ -0,0 +1,182 @@
+#include "Capture.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CPU.h"
+#include "Window.h"
+
+namespace gb {
+
+namespace {
+
+const int frame_clocks = 70224;
+const std::size_t frame_size = Window::width * Window::height;
+const std::size_t chroma_size = frame_size / 2;
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void putLittle(std::ostream& out, uint32_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) {
+    out.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+}  // namespace
+
+Capture::Capture(const Options& options)
+    : every_(std::max(options.every, 1)),
+      sample_rate_(options.sample_rate),
+      slots_(std::max<std::size_t>(options.queue, 1)) {
+  if (!options.video.empty()) {
+    video_file_.open(options.video, std::ios::binary | std::ios::trunc);
+    valid_ &= video_file_.is_open();
+    y4m_ = endsWith(options.video, ".y4m");
+    if (y4m_) {
+      // Full range luma with neutral 4:2:0 chroma planes
+      video_file_ << "YUV4MPEG2 W" << Window::width << " H" << Window::height
+                  << " F" << APU::clock_rate << ":" << frame_clocks * every_
+                  << " Ip A1:1 C420jpeg\n";
+      chroma_.assign(chroma_size, 0x80);
+    }
+  }
+  if (!options.audio.empty()) {
+    audio_file_.open(options.audio, std::ios::binary | std::ios::trunc);
+    valid_ &= audio_file_.is_open() && sample_rate_ > 0;
+    writeWavHeader(0);
+  }
+
+  for (Slot& slot : slots_) {
+    slot.pixels.resize(frame_size);
+  }
+  if (valid_) {
+    writer_ = std::thread{&Capture::run, this};
+  }
+}
+
+Capture::~Capture() { finish(); }
+
+void Capture::addFrame(CPU& cpu) {
+  bool video = video_file_.is_open() && frames_ % every_ == 0;
+  bool audio = audio_file_.is_open();
+  frames_++;
+  if (!writer_.joinable() || (!video && !audio)) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  if (count_ == slots_.size()) {
+    stalls_++;
+    not_full_.wait(lock, [this]() { return count_ < slots_.size(); });
+  }
+  Slot& slot = slots_[head_];
+  lock.unlock();
+
+  // The writer never touches a slot past the ones counted in count_
+  slot.video = video;
+  if (video) {
+    std::memcpy(slot.pixels.data(), cpu.lcd().framebuffer(), frame_size);
+  }
+  slot.samples.clear();
+  if (audio) {
+    slot.samples.resize(cpu.apu().samplesAvailable() * 2);
+    std::size_t read =
+        cpu.apu().readSamples(slot.samples.data(), slot.samples.size() / 2);
+    slot.samples.resize(read * 2);
+  }
+
+  lock.lock();
+  head_ = (head_ + 1) % slots_.size();
+  count_++;
+  lock.unlock();
+  not_empty_.notify_one();
+}
+
+void Capture::finish() {
+  if (writer_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      finished_ = true;
+    }
+    not_empty_.notify_one();
+    writer_.join();
+  }
+
+  if (audio_file_.is_open()) {
+    audio_file_.seekp(0);
+    writeWavHeader(static_cast<uint32_t>(audio_samples_ * 4));
+    audio_file_.close();
+  }
+  if (video_file_.is_open()) {
+    video_file_.close();
+  }
+}
+
+void Capture::run() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (true) {
+    not_empty_.wait(lock, [this]() { return count_ > 0 || finished_; });
+    if (count_ == 0) {
+      return;
+    }
+    const Slot& slot = slots_[tail_];
+    lock.unlock();
+
+    if (slot.video) {
+      writeVideo(slot);
+    }
+    if (!slot.samples.empty()) {
+      writeAudio(slot);
+    }
+
+    lock.lock();
+    tail_ = (tail_ + 1) % slots_.size();
+    count_--;
+    not_full_.notify_one();
+  }
+}
+
+void Capture::writeVideo(const Slot& slot) {
+  if (y4m_) {
+    video_file_ << "FRAME\n";
+  }
+  video_file_.write(reinterpret_cast<const char*>(slot.pixels.data()),
+                    slot.pixels.size());
+  if (y4m_) {
+    video_file_.write(reinterpret_cast<const char*>(chroma_.data()),
+                      chroma_.size());
+  }
+  video_frames_++;
+}
+
+void Capture::writeAudio(const Slot& slot) {
+  // WAV samples are little endian whatever the host is
+  audio_bytes_.resize(slot.samples.size() * 2);
+  for (std::size_t i = 0; i < slot.samples.size(); i++) {
+    uint16_t sample = static_cast<uint16_t>(slot.samples[i]);
+    audio_bytes_[i * 2] = static_cast<char>(sample & 0xFF);
+    audio_bytes_[i * 2 + 1] = static_cast<char>(sample >> 8);
+  }
+  audio_file_.write(audio_bytes_.data(), audio_bytes_.size());
+  audio_samples_ += slot.samples.size() / 2;
+}
+
+void Capture::writeWavHeader(uint32_t data_bytes) {
+  audio_file_.write("RIFF", 4);
+  putLittle(audio_file_, 36 + data_bytes, 4);
+  audio_file_.write("WAVEfmt ", 8);
+  putLittle(audio_file_, 16, 4);
+  putLittle(audio_file_, 1, 2);  // PCM
+  putLittle(audio_file_, 2, 2);  // Stereo
+  putLittle(audio_file_, sample_rate_, 4);
+  putLittle(audio_file_, sample_rate_ * 4, 4);
+  putLittle(audio_file_, 4, 2);
+  putLittle(audio_file_, 16, 2);
+  audio_file_.write("data", 4);
+  putLittle(audio_file_, data_bytes, 4);
+}
+
+}  // namespace gb
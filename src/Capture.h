@@ -0,0 +1,98 @@
+#ifndef GEEBEE_SRC_CAPTURE_H
+#define GEEBEE_SRC_CAPTURE_H
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "types.h"
+
+namespace gb {
+
+class CPU;
+
+// Records a running machine to disk: the LCD framebuffer as Y4M or raw 8 bit
+// video and the APU output as a 16 bit stereo WAV file. Frames are copied
+// into a fixed ring of slots and written by a dedicated thread, so the
+// emulation only waits when the disk falls `queue` frames behind.
+class Capture {
+ public:
+  struct Options {
+    // Y4M if the name ends in .y4m, headerless shades otherwise. Empty for
+    // no video.
+    std::string video;
+    // Empty for no audio.
+    std::string audio;
+    // Keeps only every Nth video frame. Audio is always complete.
+    int every{1};
+    int sample_rate{48000};
+    std::size_t queue{64};
+  };
+
+  explicit Capture(const Options& options);
+  Capture(const Capture& capture) = delete;
+  Capture(Capture&& capture) = delete;
+  ~Capture();
+  Capture& operator=(const Capture& capture) = delete;
+  Capture& operator=(const Capture&& capture) = delete;
+
+  // False if one of the files could not be created.
+  bool is_valid() const { return valid_; }
+  // The rate to set on the captured APU, 0 if no audio is recorded.
+  int sampleRate() const { return audio_file_.is_open() ? sample_rate_ : 0; }
+
+  // Queues the frame `cpu` just finished along with all its pending samples.
+  void addFrame(CPU& cpu);
+  // Writes out everything queued and completes the file headers. Nothing
+  // can be added afterwards.
+  void finish();
+
+  long videoFrames() const { return video_frames_; }
+  long audioSamples() const { return audio_samples_; }
+  // How often addFrame() had to wait for a free slot.
+  long stalls() const { return stalls_; }
+
+ private:
+  struct Slot {
+    bool video{false};
+    Bytes pixels;
+    std::vector<int16_t> samples;
+  };
+
+  void run();
+  void writeVideo(const Slot& slot);
+  void writeAudio(const Slot& slot);
+  void writeWavHeader(uint32_t data_bytes);
+
+  bool valid_{true};
+  bool y4m_{false};
+  int every_{1};
+  int sample_rate_{48000};
+  long frames_{0};
+
+  std::ofstream video_file_;
+  std::ofstream audio_file_;
+  Bytes chroma_;
+  std::vector<char> audio_bytes_;
+
+  std::vector<Slot> slots_;
+  std::size_t head_{0};
+  std::size_t tail_{0};
+  std::size_t count_{0};
+  bool finished_{false};
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::thread writer_;
+
+  long video_frames_{0};
+  long audio_samples_{0};
+  long stalls_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,66 @@
+#include "FrameHashes.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "Window.h"
+#include "hash.h"
+#include "savestate.h"
+
+namespace gb {
+
+FrameHashes::FrameHashes(const std::string& filename) {
+  std::ifstream stream{filename};
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream fields{line};
+    Entry entry;
+    if (!(fields >> std::hex >> entry.frame)) {
+      entries_.clear();
+      return;
+    }
+    fields >> std::hex >> entry.state;
+    entries_.push_back(entry);
+  }
+}
+
+uint64_t FrameHashes::frame(const LCD& lcd) {
+  return hash::bytes(lcd.framebuffer(), Window::width * Window::height);
+}
+
+bool FrameHashes::save(const std::string& filename) const {
+  std::ofstream stream{filename};
+  stream << std::hex << std::setfill('0');
+  for (const Entry& entry : entries_) {
+    stream << std::setw(16) << entry.frame;
+    if (entry.state) {
+      stream << ' ' << std::setw(16) << entry.state;
+    }
+    stream << '\n';
+  }
+  return static_cast<bool>(stream);
+}
+
+long FrameHashes::firstDivergence(const FrameHashes& golden) const {
+  std::size_t frames = std::min(size(), golden.size());
+  for (std::size_t i = 0; i < frames; i++) {
+    const Entry& ours = entries_[i];
+    const Entry& theirs = golden[i];
+    if (ours.frame != theirs.frame ||
+        (ours.state && theirs.state && ours.state != theirs.state)) {
+      return static_cast<long>(i);
+    }
+  }
+  return size() == golden.size() ? -1 : static_cast<long>(frames);
+}
+
+uint64_t StateHasher::hash(const CPU& cpu) {
+  cpu.save(state_);
+  buffer_.resize(savestate::size(state_));
+  savestate::write(state_, buffer_.data(), buffer_.size());
+  return hash::bytes(buffer_.data(), buffer_.size());
+}
+
+}  // namespace gb
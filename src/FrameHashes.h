@@ -0,0 +1,59 @@
+#ifndef GEEBEE_SRC_FRAMEHASHES_H
+#define GEEBEE_SRC_FRAMEHASHES_H
+
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+#include "types.h"
+
+namespace gb {
+
+// One 64 bit fingerprint per frame of a run: the finished framebuffer and
+// optionally the whole machine state. Comparing a run against a golden
+// file of these finds the first frame where its output changed.
+class FrameHashes {
+ public:
+  struct Entry {
+    uint64_t frame{0};
+    // 0 if the state was not hashed
+    uint64_t state{0};
+  };
+
+  FrameHashes() = default;
+  // Reads a file written by save(), one line of hex hashes per frame.
+  explicit FrameHashes(const std::string& filename);
+  ~FrameHashes() = default;
+
+  // Hash of the frame the LCD finished at the last VBlank.
+  static uint64_t frame(const LCD& lcd);
+
+  bool is_valid() const { return !entries_.empty(); }
+  std::size_t size() const { return entries_.size(); }
+  const Entry& operator[](std::size_t frame) const { return entries_[frame]; }
+  void add(const Entry& entry) { entries_.push_back(entry); }
+
+  bool save(const std::string& filename) const;
+  // The first frame whose hashes differ from `golden`, or -1 if both runs
+  // match frame by frame. State hashes only count if both sides have them,
+  // and a frame missing on either side is a difference.
+  long firstDivergence(const FrameHashes& golden) const;
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+// Hashes the complete state of a machine, keeping its buffers between calls
+// so hashing every frame doesn't allocate.
+class StateHasher {
+ public:
+  uint64_t hash(const CPU& cpu);
+
+ private:
+  CPU::State state_;
+  Bytes buffer_;
+};
+
+}  // namespace gb
+
+#endif
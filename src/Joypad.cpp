@@ -5,16 +5,22 @@
 
 namespace gb {
 
-Joypad::Joypad(Memory& memory) : memory_(memory) {
-  for (bool& b : keys_) {
-    b = false;
-  }
+static_assert(std::tuple_size<MachineState::Joypad>::value == Joypad::Key::Max,
+              "The state block has room for every key");
 
+Joypad::Joypad(Memory& memory)
+    : memory_(memory), keys_(memory.machine().joypad) {
   memory_.registerHandler(this);
 }
 
 Joypad::~Joypad() { memory_.unregisterHandler(this); }
 
+void Joypad::set(Byte keys) {
+  for (int i = 0; i < Key::Max; i++) {
+    keys_[i] = bits::bit(keys, i);
+  }
+}
+
 void Joypad::press(Key key) { keys_[key] = true; }
 
 void Joypad::release(Key key) { keys_[key] = false; }
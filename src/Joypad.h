@@ -4,6 +4,7 @@
 #include <array>
 
 #include "IOHandler.h"
+#include "MachineState.h"
 #include "types.h"
 
 namespace gb {
@@ -32,6 +33,8 @@ class Joypad : public IOHandler {
   Joypad& operator=(const Joypad& joypad) = delete;
   Joypad& operator=(const Joypad&& joypad) = delete;
 
+  // Sets all keys at once, bit n of `keys` being the state of Key n.
+  void set(Byte keys);
   void press(Key key);
   void release(Key key);
 
@@ -42,8 +45,7 @@ class Joypad : public IOHandler {
  private:
   enum Register : Word { Joyp = 0xFF00 };
   Memory& memory_;
-
-  std::array<bool, Key::Max> keys_;
+  MachineState::Joypad& keys_;
 };
 }  // namespace gb
 
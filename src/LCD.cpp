@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "Memory.h"
+#include "Timeline.h"
 #include "Window.h"
 #include "bits.h"
 
@@ -12,14 +13,23 @@ namespace gb {
 const std::array<int, 4> LCD::color_map_{255, 170, 85, 0};
 
 LCD::LCD(Window& window, Memory& memory)
-    : IOHandler(), window_(window), memory_(memory) {
+    : IOHandler(),
+      window_(window),
+      memory_(memory),
+      state_(memory.machine().lcd) {
+  pixels_.fill(255);
+  framebuffer_ = pixels_.data();
   memory_.registerHandler(this);
 }
 
 LCD::~LCD() { memory_.unregisterHandler(this); }
 
+void LCD::setFramebuffer(Byte* pixels) {
+  framebuffer_ = pixels ? pixels : pixels_.data();
+}
+
 void LCD::advance(int timing) {
-  done_frame_ = false;
+  state_.done_frame = false;
   resetInterruptFlags();
 
   memory_.setOAMAccess(true);
@@ -28,36 +38,38 @@ void LCD::advance(int timing) {
   Byte lcdc = memory_.read(Register::Lcdc);
   // Check if screen is enabled
   if (!bits::bit(lcdc, 7)) {
-    if (enabled_) {
+    if (state_.enabled) {
       setMode(Mode::HBlank);
-      mode_timing_ = 0;
-      enabled_ = false;
+      state_.mode_timing = 0;
+      state_.enabled = false;
     }
     return;
   }
-  if (!enabled_) {
+  if (!state_.enabled) {
     setMode(Mode::OAM);
-    mode_timing_ = 0;
-    enabled_ = true;
+    state_.mode_timing = 0;
+    state_.enabled = true;
   }
 
-  mode_timing_ += timing;
-  if (mode_ == Mode::OAM) {
-    if (mode_timing_ >= 79) {
-      mode_timing_ -= 79;
+  state_.mode_timing += timing;
+  if (state_.mode == Mode::OAM) {
+    if (state_.mode_timing >= 79) {
+      state_.mode_timing -= 79;
       setMode(Mode::VRAM);
     }
-  } else if (mode_ == Mode::VRAM) {
-    if (mode_timing_ >= 172) {
-      mode_timing_ -= 172;
+  } else if (state_.mode == Mode::VRAM) {
+    if (state_.mode_timing >= 172) {
+      state_.mode_timing -= 172;
       setMode(Mode::HBlank);
 
-      Byte ly = memory_.read(Register::Ly);
-      drawLine(ly);
+      if (rendering_) {
+        Byte ly = memory_.read(Register::Ly);
+        drawLine(ly);
+      }
     }
-  } else if (mode_ == Mode::HBlank) {
-    if (mode_timing_ >= 205) {
-      mode_timing_ -= 205;
+  } else if (state_.mode == Mode::HBlank) {
+    if (state_.mode_timing >= 205) {
+      state_.mode_timing -= 205;
       Byte ly = memory_.read(Register::Ly);
       ly++;
       memory_.write(Register::Ly, ly);
@@ -68,10 +80,10 @@ void LCD::advance(int timing) {
       }
     }
   } else {
-    Byte ly = (mode_timing_ / 456) + 144;
-    if (mode_timing_ >= 4560) {
+    Byte ly = (state_.mode_timing / 456) + 144;
+    if (state_.mode_timing >= 4560) {
       setMode(Mode::OAM);
-      mode_timing_ -= 4560;
+      state_.mode_timing -= 4560;
       memory_.write(Register::Ly, 0);
     } else {
       memory_.write(Register::Ly, ly);
@@ -90,27 +102,26 @@ Byte LCD::read(Word address) { return memory_.read(address); }
 
 void LCD::write(Word address, Byte byte) {
   if (address == Register::Dma) {
-    Word source_start = byte << 8 | 0x00;
-    Word source_end = byte << 8 | 0x9F;
-    Word destination = 0xFE00;
-    for (Word i = source_start; i <= source_end; i++, destination++) {
-      memory_.write(destination, read(i));
-    }
-  } else {
-    memory_.write(address, byte);
+    memory_.startDma(byte);
   }
+  memory_.write(address, byte);
+}
+
+Byte LCD::vram(Word address) const {
+  return memory_.vram()[address - 0x8000];
 }
 
 LCD::SpriteInfo::SpriteInfo(const Memory& memory, int id)
-    : y(memory.read(0xFE00 + id * 4 + 0)),
-      x(memory.read(0xFE00 + id * 4 + 1)),
-      tile(memory.read(0xFE00 + id * 4 + 2)),
-      flags(memory.read(0xFE00 + id * 4 + 3)) {}
+    : y(memory.sat()[id * 4 + 0]),
+      x(memory.sat()[id * 4 + 1]),
+      tile(memory.sat()[id * 4 + 2]),
+      flags(memory.sat()[id * 4 + 3]) {}
 
 void LCD::drawLine(int ly) {
   if (ly >= 144) {
     return;
   }
+  Timeline::Scope scope{Timeline::DrawLine};
   Byte bgp_data = memory_.read(Register::Bgp);
   Byte obp0_data = memory_.read(Register::Obp0);
   Byte obp1_data = memory_.read(Register::Obp1);
@@ -132,8 +143,10 @@ void LCD::drawLine(int ly) {
   Word bg_tile_data = !signed_tile ? 0x9000 : 0x8000;
   Word bg_tile_map = !bits::bit(lcdc, 3) ? 0x9800 : 0x9C00;
 
+  Byte* line = framebuffer_ + ly * Window::width;
+
   // BG
-  std::vector<int> bgcolors(160, 0);
+  std::array<int, Window::width> bgcolors{};
   if (bits::bit(lcdc, 0)) {
     int y = (ly + scy) % 256;
     Byte bottom = 0x00;
@@ -148,25 +161,22 @@ void LCD::drawLine(int ly) {
       int pixel_y = y % 8;
 
       if (tile_x != last_tile_x) {
-        int tile = memory_.read(bg_tile_map + (tile_y * 32) + tile_x);
+        int tile = vram(bg_tile_map + (tile_y * 32) + tile_x);
         int offset = tile;
         if (!signed_tile) {
           offset = static_cast<SByte>(tile);
         }
-        bottom = memory_.read(bg_tile_data + (offset * 16) + (pixel_y * 2));
-        top = memory_.read(bg_tile_data + (offset * 16) + (pixel_y * 2) + 1);
+        bottom = vram(bg_tile_data + (offset * 16) + (pixel_y * 2));
+        top = vram(bg_tile_data + (offset * 16) + (pixel_y * 2) + 1);
         last_tile_x = tile_x;
       }
 
       int color = color_number(pixel_x, top, bottom);
       bgcolors[i] = color;
-      Byte pixel = palette(bgp_data, color);
-      window_.setPixel(i, ly, pixel);
+      line[i] = palette(bgp_data, color);
     }
   } else {
-    for (int i = 0; i < 160; i++) {
-      window_.setPixel(i, ly, 255);
-    }
+    std::fill(line, line + Window::width, 255);
   }
 
   Byte wx = memory_.read(Register::Wx);
@@ -178,7 +188,7 @@ void LCD::drawLine(int ly) {
     Byte top = 0x00;
     int last_tile_x = -1;
 
-    for (int i = wx - 7; i < 160; i++) {
+    for (int i = std::max(wx - 7, 0); i < 160; i++) {
       int x = i - wx + 7;
       int tile_x = x / 8;
       int tile_y = y / 8;
@@ -186,28 +196,27 @@ void LCD::drawLine(int ly) {
       int pixel_y = y % 8;
 
       if (tile_x != last_tile_x) {
-        int tile = memory_.read(win_tile_map + (tile_y * 32) + tile_x);
+        int tile = vram(win_tile_map + (tile_y * 32) + tile_x);
         int offset = tile;
         if (!signed_tile) {
           offset = static_cast<SByte>(tile);
         }
-        bottom = memory_.read(bg_tile_data + (offset * 16) + (pixel_y * 2));
-        top = memory_.read(bg_tile_data + (offset * 16) + (pixel_y * 2) + 1);
+        bottom = vram(bg_tile_data + (offset * 16) + (pixel_y * 2));
+        top = vram(bg_tile_data + (offset * 16) + (pixel_y * 2) + 1);
         last_tile_x = tile_x;
       }
 
       int color = color_number(pixel_x, top, bottom);
       bgcolors[i] = color;
-      Byte pixel = palette(bgp_data, color);
-      window_.setPixel(i, ly, pixel);
+      line[i] = palette(bgp_data, color);
     }
   }
 
   // OBJ
   bool big_sprites = bits::bit(lcdc, 2);
-  std::vector<SpriteInfo> sprites = getSprites(ly, big_sprites);
+  Sprites sprites;
   // Keep at most 10 sprites
-  int size = std::min(10, static_cast<int>(sprites.size()));
+  int size = std::min(10, getSprites(ly, big_sprites, sprites));
   // Draw them! Back to front, so front renders on top.
   for (int i = size - 1; i >= 0; i--) {
     SpriteInfo& info = sprites[i];
@@ -240,12 +249,12 @@ void LCD::drawLine(int ly) {
         }
       }
 
-      Byte bottom = memory_.read(0x8000 + (static_cast<int>(sprite_tile) * 16) +
-                                 (pixel_y * 2));
-      Byte top = memory_.read(0x8000 + (static_cast<int>(sprite_tile) * 16) +
-                              (pixel_y * 2) + 1);
+      Byte bottom =
+          vram(0x8000 + (static_cast<int>(sprite_tile) * 16) + (pixel_y * 2));
+      Byte top = vram(0x8000 + (static_cast<int>(sprite_tile) * 16) +
+                      (pixel_y * 2) + 1);
       for (int x = 0; x < 8; x++) {
-        if (info.x + x - 8 < 0) {
+        if (info.x + x - 8 < 0 || info.x + x - 8 >= 160) {
           continue;
         }
         int pixel_x = 8 - x % 8 - 1;
@@ -255,35 +264,31 @@ void LCD::drawLine(int ly) {
 
         int color = color_number(pixel_x, top, bottom);
         if (color != 0 && !(behind && bgcolors[info.x + x - 8] > 0)) {
-          Byte pixel = palette(obp, color);
-          window_.setPixel(info.x + x - 8, ly, pixel);
+          line[info.x + x - 8] = palette(obp, color);
         }
       }
     }
   }
 }
 
-std::vector<LCD::SpriteInfo> LCD::getSprites(int ly, bool big_sprites) {
-  std::vector<SpriteInfo> sprites;
-  sprites.reserve(40);
+int LCD::getSprites(int ly, bool big_sprites, Sprites& sprites) const {
+  int count = 0;
   for (int i = 0; i < 40; i++) {
-    sprites.push_back(SpriteInfo{memory_, i});
+    SpriteInfo info{memory_, i};
+    // Only keep sprites that fit in y on this line
+    if (info.y == 0 || info.y >= 160 || ly < info.y - 16 ||
+        ly >= info.y - (big_sprites ? 0 : 8)) {
+      continue;
+    }
+    sprites[count++] = info;
   }
-  // Remove all sprites from consideration for this line if they don't fit in y
-  sprites.erase(std::remove_if(std::begin(sprites), std::end(sprites),
-                               [ly, big_sprites](const SpriteInfo& info) {
-                                 return info.y == 0 || info.y >= 160 ||
-                                        ly < info.y - 16 ||
-                                        ly >= info.y - (big_sprites ? 0 : 8);
-                               }),
-                sprites.end());
   // Sort all leftover sprites by x coordinate
-  std::sort(std::begin(sprites), std::end(sprites),
+  std::sort(sprites.begin(), sprites.begin() + count,
             [](const SpriteInfo& left, const SpriteInfo& right) {
               return left.x < right.x;
             });
 
-  return sprites;
+  return count;
 }
 
 void LCD::resetInterruptFlags() {
@@ -294,15 +299,15 @@ void LCD::resetInterruptFlags() {
 }
 
 void LCD::setMode(Mode mode) {
-  if (mode == mode_) {
+  if (mode == state_.mode) {
     return;
   }
-  mode_ = mode;
+  state_.mode = mode;
 
   Byte stat = memory_.read(Register::Stat);
   // Write current mode
   stat &= 0xFC;
-  stat |= static_cast<int>(mode_) & 0x03;
+  stat |= static_cast<int>(state_.mode) & 0x03;
 
   // Request interrupt for mode if available
   Byte interrupts = memory_.read(Memory::Register::InterruptFlag);
@@ -313,7 +318,10 @@ void LCD::setMode(Mode mode) {
   }
   if (mode == Mode::VBlank) {
     bits::setBit(interrupts, 0, true);
-    done_frame_ = true;
+    state_.done_frame = true;
+    if (rendering_) {
+      window_.setFrame(framebuffer_);
+    }
   }
 
   memory_.write(Memory::Register::InterruptFlag, interrupts);
@@ -324,13 +332,13 @@ void LCD::updateMemoryAccess() {
   memory_.setOAMAccess(true);
   memory_.setVRAMAccess(true);
 
-  if (!enabled_) {
+  if (!state_.enabled) {
     return;
   }
 
-  if (mode_ == Mode::OAM) {
+  if (state_.mode == Mode::OAM) {
     memory_.setOAMAccess(false);
-  } else if (mode_ == Mode::VRAM) {
+  } else if (state_.mode == Mode::VRAM) {
     memory_.setOAMAccess(false);
     memory_.setVRAMAccess(false);
   }
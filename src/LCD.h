@@ -3,17 +3,20 @@
 
 #include <array>
 #include <unordered_set>
-#include <vector>
 
 #include "IOHandler.h"
+#include "MachineState.h"
+#include "Window.h"
 #include "types.h"
 
 namespace gb {
 
 class Memory;
-class Window;
 
 class LCD : public IOHandler {
+ private:
+  using Mode = MachineState::LcdMode;
+
  public:
   LCD(Window& window, Memory& memory);
   LCD(const LCD& lcd) = delete;
@@ -22,7 +25,15 @@ class LCD : public IOHandler {
   LCD& operator=(const LCD& lcd) = delete;
   LCD& operator=(const LCD&& lcd) = delete;
 
-  bool doneFrame() const { return done_frame_; }
+  bool doneFrame() const { return state_.done_frame; }
+  // The shades of the frame being drawn, Window::width by Window::height.
+  const Byte* framebuffer() const { return framebuffer_; }
+  // Renders into `pixels` instead of the internal buffer, or back into the
+  // internal one if `pixels` is null.
+  void setFramebuffer(Byte* pixels);
+  // Frames advanced without rendering still run the full PPU timing, but skip
+  // drawing pixels to the window.
+  void setRendering(bool rendering) { rendering_ = rendering; }
   void advance(int timing);
 
   bool handlesAddress(Word address) const override;
@@ -30,8 +41,6 @@ class LCD : public IOHandler {
   void write(Word address, Byte byte) override;
 
  private:
-  enum class Mode : int { HBlank = 0, VBlank = 1, OAM = 2, VRAM = 3 };
-
   enum Register : Word {
     Lcdc = 0xFF40,
     Stat = 0xFF41,
@@ -53,12 +62,17 @@ class LCD : public IOHandler {
     Byte tile{0};
     Byte flags{0};
 
+    SpriteInfo() = default;
     SpriteInfo(const Memory& memory, int id);
   };
+  using Sprites = std::array<SpriteInfo, 40>;
   static const std::array<int, 4> color_map_;
 
+  // The PPU has its own bus to VRAM, unaffected by CPU access restrictions
+  Byte vram(Word address) const;
   void drawLine(int ly);
-  std::vector<SpriteInfo> getSprites(int ly, bool big_sprites);
+  // Fills `sprites` with the ones on line `ly` sorted by x, returns how many
+  int getSprites(int ly, bool big_sprites, Sprites& sprites) const;
   void resetInterruptFlags();
   void setMode(Mode mode);
   void updateMemoryAccess();
@@ -66,11 +80,11 @@ class LCD : public IOHandler {
 
   Window& window_;
   Memory& memory_;
+  MachineState::Lcd& state_;
+  bool rendering_{true};
 
-  bool enabled_{false};
-  Mode mode_{Mode::HBlank};
-  int mode_timing_{0};
-  bool done_frame_{true};
+  std::array<Byte, Window::width * Window::height> pixels_;
+  Byte* framebuffer_{nullptr};
 };
 
 }  // namespace gb
@@ -0,0 +1,101 @@
+#include "Lockstep.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace gb {
+
+namespace {
+
+template <typename T>
+void field(std::ostringstream& out, const char* name, T reference,
+           T candidate) {
+  if (reference != candidate) {
+    out << "  " << name << ": " << std::hex
+        << static_cast<uint64_t>(reference) << " != "
+        << static_cast<uint64_t>(candidate) << std::dec << "\n";
+  }
+}
+
+}  // namespace
+
+Lockstep::Lockstep(CPU& reference, CPU& candidate, int interval)
+    : reference_(reference),
+      candidate_(candidate),
+      interval_(interval > 0 ? interval : 1) {
+  reference_.memory().setWriteHashing(true);
+  candidate_.memory().setWriteHashing(true);
+  compare();
+}
+
+Lockstep::~Lockstep() {
+  reference_.memory().setWriteHashing(false);
+  candidate_.memory().setWriteHashing(false);
+}
+
+bool Lockstep::run(long instructions) {
+  for (long i = 0; i < instructions && !diverged(); i += interval_) {
+    Word pc = reference_.registers().pc;
+    Byte op = reference_.memory().peek(pc);
+    Byte operand = reference_.memory().peek(pc + 1);
+    // The last block stops where it was asked to
+    long block = std::min<long>(interval_, instructions - i);
+    for (long step = 0; step < block; step++) {
+      reference_.step();
+      candidate_.step();
+    }
+    instructions_ += block;
+    if (!compare()) {
+      describe(pc, op, operand);
+    }
+  }
+  return !diverged();
+}
+
+bool Lockstep::compare() {
+  CPU::Registers ours = reference_.registers();
+  CPU::Registers theirs = candidate_.registers();
+  std::ostringstream out;
+  field(out, "a", ours.a, theirs.a);
+  field(out, "f", ours.f, theirs.f);
+  field(out, "b", ours.b, theirs.b);
+  field(out, "c", ours.c, theirs.c);
+  field(out, "d", ours.d, theirs.d);
+  field(out, "e", ours.e, theirs.e);
+  field(out, "h", ours.h, theirs.h);
+  field(out, "l", ours.l, theirs.l);
+  field(out, "sp", ours.sp, theirs.sp);
+  field(out, "pc", ours.pc, theirs.pc);
+  field(out, "ime", ours.interrupts, theirs.interrupts);
+  field(out, "halt", ours.halt, theirs.halt);
+  field(out, "cycles", reference_.memory().cycles(),
+        candidate_.memory().cycles());
+  field(out, "write hash", reference_.memory().writeHash(),
+        candidate_.memory().writeHash());
+  divergence_ = out.str();
+  return divergence_.empty();
+}
+
+void Lockstep::describe(Word pc, Byte op, Byte operand) {
+  std::ostringstream out;
+  out << "Diverged after " << instructions_ << " instructions, the last "
+      << "block starting at " << std::hex << std::setfill('0')
+      << std::setw(4) << pc << " " << CPU::describe(op, operand) << "\n"
+      << divergence_;
+
+  // Point at the first byte that differs to narrow down a bad write
+  for (int address = 0; address < 0x10000; address++) {
+    Byte ours = reference_.memory().peek(address);
+    Byte theirs = candidate_.memory().peek(address);
+    if (ours != theirs) {
+      out << "  memory " << std::setw(4) << address << ": " << std::setw(2)
+          << static_cast<int>(ours) << " != " << std::setw(2)
+          << static_cast<int>(theirs) << "\n";
+      break;
+    }
+  }
+  divergence_ = out.str();
+}
+
+}  // namespace gb
@@ -0,0 +1,48 @@
+#ifndef GEEBEE_SRC_LOCKSTEP_H
+#define GEEBEE_SRC_LOCKSTEP_H
+
+#include <string>
+
+#include "CPU.h"
+#include "types.h"
+
+namespace gb {
+
+// Runs a reference machine and a candidate, e.g. a clone, a restored
+// snapshot or one with different settings, side by side on the same input.
+// After every block of instructions it compares their registers, cycle
+// counts and a rolling hash of all memory writes, and stops at the first
+// difference with a description of it.
+class Lockstep {
+ public:
+  // Both machines have to be in the same state already. Compares after
+  // every `interval` instructions.
+  Lockstep(CPU& reference, CPU& candidate, int interval = 1);
+  Lockstep(const Lockstep& lockstep) = delete;
+  Lockstep(Lockstep&& lockstep) = delete;
+  ~Lockstep();
+  Lockstep& operator=(const Lockstep& lockstep) = delete;
+  Lockstep& operator=(const Lockstep&& lockstep) = delete;
+
+  // Runs up to `instructions` more instructions on both machines. Returns
+  // false if they diverged.
+  bool run(long instructions);
+  long instructions() const { return instructions_; }
+  bool diverged() const { return !divergence_.empty(); }
+  // What differed, empty while the machines agree.
+  const std::string& divergence() const { return divergence_; }
+
+ private:
+  bool compare();
+  void describe(Word pc, Byte op, Byte operand);
+
+  CPU& reference_;
+  CPU& candidate_;
+  int interval_{1};
+  long instructions_{0};
+  std::string divergence_;
+};
+
+}  // namespace gb
+
+#endif
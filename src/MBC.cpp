@@ -1,44 +1,244 @@
 #include "MBC.h"
 
+#include <algorithm>
+#include <ctime>
+#include <cstring>
 #include <stdexcept>
 
 #include "Program.h"
 
 namespace gb {
 
+namespace {
+
+const std::size_t rom_bank_size = 0x4000;
+const std::size_t ram_bank_size = 0x2000;
+
+}  // namespace
+
+// Plain banked RAM at the cached offset, shared by most controllers
+struct MBC::Generic {
+  static Byte readRam(const MBC& mbc, Word address) {
+    std::size_t offset = mbc.ram_offset_ + (address - 0xA000);
+    if (!mbc.ram_enable_ || offset >= mbc.ramSize()) {
+      return 0xFF;
+    }
+    return mbc.ramByte(offset);
+  }
+
+  static void writeRam(MBC& mbc, Word address, Byte byte) {
+    std::size_t offset = mbc.ram_offset_ + (address - 0xA000);
+    if (!mbc.ram_enable_ || offset >= mbc.ramSize()) {
+      return;
+    }
+    mbc.setRamByte(offset, byte);
+  }
+};
+
+// 32kB ROM, with optional RAM that is always enabled
+struct MBC::None : MBC::Generic {
+  static void write(MBC&, Word, Byte) {}
+
+  static void update(MBC& mbc) {
+    mbc.ram_enable_ = true;
+    mbc.mapRom(0, 1);
+    mbc.mapRam(0);
+  }
+};
+
+struct MBC::Mbc1 : MBC::Generic {
+  static void write(MBC& mbc, Word address, Byte byte) {
+    switch (address & 0xE000) {
+      case 0x0000:
+        mbc.enableRam((byte & 0x0F) == 0x0A);
+        return;
+      case 0x2000:
+        mbc.rom_bank_ = byte & 0x1F;
+        break;
+      case 0x4000:
+        mbc.ram_bank_ = byte & 0x03;
+        break;
+      case 0x6000:
+        mbc.ram_banking_ = byte & 0x01;
+        break;
+    }
+    update(mbc);
+  }
+
+  // The two bit register extends the ROM bank, or in RAM banking mode also
+  // selects the RAM bank and the bank at 0000-3FFF
+  static void update(MBC& mbc) {
+    std::size_t low = mbc.rom_bank_ ? mbc.rom_bank_ : 1;
+    std::size_t high = mbc.ram_bank_ << 5;
+    mbc.mapRom(mbc.ram_banking_ ? high : 0, high | low);
+    mbc.mapRam(mbc.ram_banking_ ? mbc.ram_bank_ : 0);
+  }
+};
+
+// 512 half bytes of RAM built into the controller
+struct MBC::Mbc2 {
+  static void write(MBC& mbc, Word address, Byte byte) {
+    if (address >= 0x4000) {
+      return;
+    }
+    if (address & 0x0100) {
+      mbc.rom_bank_ = byte & 0x0F;
+      update(mbc);
+    } else {
+      mbc.enableRam((byte & 0x0F) == 0x0A);
+    }
+  }
+
+  static void update(MBC& mbc) {
+    mbc.mapRom(0, mbc.rom_bank_ ? mbc.rom_bank_ : 1);
+    mbc.mapRam(0);
+  }
+
+  static Byte readRam(const MBC& mbc, Word address) {
+    if (!mbc.ram_enable_) {
+      return 0xFF;
+    }
+    return 0xF0 | mbc.ramByte((address - 0xA000) & 0x01FF);
+  }
+
+  static void writeRam(MBC& mbc, Word address, Byte byte) {
+    if (mbc.ram_enable_) {
+      mbc.setRamByte((address - 0xA000) & 0x01FF, byte & 0x0F);
+    }
+  }
+};
+
+// RAM bank values 08-0C select the clock registers instead of RAM
+struct MBC::Mbc3 : MBC::Generic {
+  static void write(MBC& mbc, Word address, Byte byte) {
+    switch (address & 0xE000) {
+      case 0x0000:
+        mbc.enableRam((byte & 0x0F) == 0x0A);
+        return;
+      case 0x2000:
+        mbc.rom_bank_ = byte & 0x7F;
+        break;
+      case 0x4000:
+        mbc.ram_bank_ = byte & 0x0F;
+        break;
+      case 0x6000:
+        if (mbc.has_timer_) {
+          mbc.rtc_.latch(byte, mbc.now());
+          mbc.storeClock();
+        }
+        return;
+    }
+    update(mbc);
+  }
+
+  static void update(MBC& mbc) {
+    mbc.mapRom(0, mbc.rom_bank_ ? mbc.rom_bank_ : 1);
+    mbc.mapRam(mbc.ram_bank_ & 0x03);
+  }
+
+  static Byte readRam(const MBC& mbc, Word address) {
+    if (!(mbc.ram_bank_ & 0x08)) {
+      return Generic::readRam(mbc, address);
+    }
+    if (!mbc.ram_enable_ || !mbc.has_timer_) {
+      return 0xFF;
+    }
+    return mbc.rtc_.read(mbc.ram_bank_);
+  }
+
+  static void writeRam(MBC& mbc, Word address, Byte byte) {
+    if (!(mbc.ram_bank_ & 0x08)) {
+      Generic::writeRam(mbc, address, byte);
+    } else if (mbc.ram_enable_ && mbc.has_timer_) {
+      mbc.rtc_.write(mbc.ram_bank_, byte, mbc.now());
+    }
+  }
+};
+
+// 9 bit ROM banks where bank 0 can be mapped at 4000-7FFF. Rumble carts use
+// the fourth RAM bank bit for the motor.
+struct MBC::Mbc5 : MBC::Generic {
+  static void write(MBC& mbc, Word address, Byte byte) {
+    switch (address & 0xF000) {
+      case 0x0000:
+      case 0x1000:
+        mbc.enableRam((byte & 0x0F) == 0x0A);
+        return;
+      case 0x2000:
+        mbc.rom_bank_ = (mbc.rom_bank_ & 0x100) | byte;
+        break;
+      case 0x3000:
+        mbc.rom_bank_ = (mbc.rom_bank_ & 0xFF) | ((byte & 0x01) << 8);
+        break;
+      case 0x4000:
+      case 0x5000:
+        mbc.ram_bank_ = byte & 0x0F;
+        break;
+      default:
+        return;
+    }
+    update(mbc);
+  }
+
+  static void update(MBC& mbc) {
+    mbc.mapRom(0, mbc.rom_bank_);
+    mbc.mapRam(mbc.has_rumble_ ? mbc.ram_bank_ & 0x07 : mbc.ram_bank_);
+  }
+};
+
 MBC::MBC(const Program& program) : program_(program) { reset(); }
 
-void MBC::reset() {
-  int type = program_.type();
+MBC::MBC(const MBC& mbc)
+    : program_(mbc.program_),
+      mbc_(mbc.mbc_),
+      has_ram_(mbc.has_ram_),
+      has_battery_(mbc.has_battery_),
+      has_timer_(mbc.has_timer_),
+      has_rumble_(mbc.has_rumble_),
+      ram_enable_(mbc.ram_enable_),
+      rom_bank_(mbc.rom_bank_),
+      ram_bank_(mbc.ram_bank_),
+      ram_banking_(mbc.ram_banking_),
+      padded_rom_(mbc.padded_rom_),
+      rom_(mbc.rom_),
+      rom_banks_(mbc.rom_banks_),
+      write_(mbc.write_),
+      read_ram_(mbc.read_ram_),
+      update_(mbc.update_),
+      ram_(mbc.ram_),
+      rtc_(mbc.rtc_),
+      clock_(mbc.clock_) {
+  if (mbc.save_file_) {
+    ram_.assign(ram_.size(), 0);
+    std::memcpy(ram_.mutableData(), mbc.save_file_->data(), ram_.size());
+  }
+  update_(*this);
+}
+
+MBC::~MBC() { storeClock(); }
 
+int MBC::controller(int type) {
   switch (type) {
     case 0x00:
-      mbc_ = 0;
-      break;
+    case 0x08:
+    case 0x09:
+      return 0;
 
     case 0x01:
     case 0x02:
     case 0x03:
-      mbc_ = 1;
-      break;
+      return 1;
 
     case 0x05:
     case 0x06:
-      mbc_ = 2;
-      break;
+      return 2;
 
     case 0x0F:
     case 0x10:
+    case 0x11:
     case 0x12:
     case 0x13:
-      mbc_ = 3;
-      break;
-
-    case 0x15:
-    case 0x16:
-    case 0x17:
-      mbc_ = 4;
-      break;
+      return 3;
 
     case 0x19:
     case 0x1A:
@@ -46,9 +246,83 @@ void MBC::reset() {
     case 0x1C:
     case 0x1D:
     case 0x1E:
-      mbc_ = 5;
-      break;
+      return 5;
 
+    default:
+      return -1;
+  }
+}
+
+bool MBC::battery(int type) {
+  switch (type) {
+    case 0x03:
+    case 0x06:
+    case 0x09:
+    case 0x0D:
+    case 0x0F:
+    case 0x10:
+    case 0x13:
+    case 0x1B:
+    case 0x1E:
+    case 0xFF:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+bool MBC::attachSaveFile(const std::string& filename) {
+  if (!has_battery_ || (!has_ram_ && !has_timer_)) {
+    return false;
+  }
+
+  std::size_t size = ram_.size() + (has_timer_ ? RTC::footer_size : 0);
+  std::unique_ptr<SaveFile> file{new SaveFile{filename, size}};
+  if (!file->is_valid()) {
+    return false;
+  }
+  save_file_ = std::move(file);
+
+  if (has_timer_) {
+    rtc_.readFooter(save_file_->data() + ram_.size(), now());
+  }
+  return true;
+}
+
+template <typename Policy>
+void MBC::use() {
+  write_ = [](MBC& mbc, Word address, Byte byte) {
+    if (address < 0x8000) {
+      Policy::write(mbc, address, byte);
+    } else {
+      Policy::writeRam(mbc, address, byte);
+    }
+  };
+  read_ram_ = &Policy::readRam;
+  update_ = &Policy::update;
+}
+
+void MBC::reset() {
+  int type = program_.type();
+
+  mbc_ = controller(type);
+  switch (mbc_) {
+    case 0:
+      use<None>();
+      break;
+    case 1:
+      use<Mbc1>();
+      break;
+    case 2:
+      use<Mbc2>();
+      break;
+    case 3:
+      use<Mbc3>();
+      break;
+    case 5:
+      use<Mbc5>();
+      break;
     default:
       throw std::runtime_error("Invalid/Unknown MBC");
   }
@@ -61,9 +335,8 @@ void MBC::reset() {
     case 0x0C:
     case 0x0D:
     case 0x10:
+    case 0x12:
     case 0x13:
-    case 0x16:
-    case 0x17:
     case 0x1A:
     case 0x1B:
     case 0x1D:
@@ -79,77 +352,89 @@ void MBC::reset() {
   if (mbc_ == 2) {
     has_ram_ = true;
   }
+  has_battery_ = battery(type);
+  has_timer_ = type == 0x0F || type == 0x10;
+  has_rumble_ = type >= 0x1C && type <= 0x1E;
 
+  ram_enable_ = false;
+  rom_bank_ = 0;
+  ram_bank_ = 0;
+  ram_banking_ = false;
+
+  prepareRom();
   if (has_ram_) {
     prepareRam();
   }
+  update_(*this);
 }
 
-Byte MBC::read(Word address) const {
-  switch (address & 0xF000) {
-    case 0x0000:
-    case 0x1000:
-    case 0x2000:
-    case 0x3000:
-      return program_.rom()[address];
-    case 0x4000:
-    case 0x5000:
-    case 0x6000:
-    case 0x7000:
-      return program_.rom()[translateRomAddress(address)];
-    case 0xA000:
-    case 0xB000:
-      return ram_enable_ ? ram_[address - 0xA000] : 0;
-
-    default:
-      throw std::runtime_error("Invalid MBC read");
-  }
+void MBC::resetRegisters() {
+  ram_enable_ = false;
+  rom_bank_ = 0;
+  ram_bank_ = 0;
+  ram_banking_ = false;
+  update_(*this);
 }
 
-void MBC::write(Word address, Byte byte) {
-  switch (address & 0xF000) {
-    case 0x0000:
-    case 0x1000:
-      enableRam(byte);
-      break;
-    case 0x2000:
-    case 0x3000:
-      selectRomBank(byte);
-      break;
-    case 0x4000:
-    case 0x5000:
-      selectModeSpecificSelect(byte);
-      break;
-    case 0x6000:
-    case 0x7000:
-      selectModeSelect(byte);
-      break;
-    case 0xA000:
-    case 0xB000:
-      if (ram_enable_) {
-        ram_[address - 0xA000] = byte;
-      }
-      break;
+void MBC::save(State& state) const {
+  state.ram_enable = ram_enable_;
+  state.rom_bank = rom_bank_;
+  state.ram_bank = ram_bank_;
+  state.ram_banking = ram_banking_;
+  rtc_.save(state.rtc);
+  if (!save_file_) {
+    state.ram = ram_;
+    return;
+  }
 
-    default:
-      throw std::runtime_error("Invalid MBC write");
+  // Reuse the state's buffer so repeated snapshots don't allocate
+  std::size_t size = ram_.size();
+  if (state.ram.size() != size) {
+    state.ram.assign(size, 0);
   }
+  std::memcpy(state.ram.mutableData(), save_file_->data(), size);
 }
 
-uint32_t MBC::translateRomAddress(Word address) const {
-  if (rom_bank_ <= 0x01) {
-    return address;
+void MBC::load(const State& state) {
+  ram_enable_ = state.ram_enable;
+  rom_bank_ = state.rom_bank;
+  ram_bank_ = state.ram_bank;
+  ram_banking_ = state.ram_banking;
+  rtc_.load(state.rtc);
+  update_(*this);
+  if (!save_file_) {
+    ram_ = state.ram;
+    return;
   }
 
-  uint32_t bank = rom_bank_;
-  if (mbc_ == 1) {
-    if (bank == 0x20 || bank == 0x40 || bank == 0x60) {
-      bank++;
+  // Only touch the pages that differ so they alone get flushed again
+  std::size_t size = std::min(ram_.size(), state.ram.size());
+  for (std::size_t page = 0; page < size; page += SaveFile::page_size) {
+    std::size_t length = std::min(SaveFile::page_size, size - page);
+    if (std::memcmp(save_file_->data() + page, state.ram.data() + page,
+                    length) != 0) {
+      for (std::size_t i = page; i < page + length; i++) {
+        save_file_->write(i, state.ram[i]);
+      }
     }
   }
+}
 
-  bank *= 0x4000;
-  return bank + (address - 0x4000);
+void MBC::prepareRom() {
+  const Rom& rom = program_.rom();
+  std::size_t size = std::max(rom.size(), 2 * rom_bank_size);
+  size = (size + rom_bank_size - 1) / rom_bank_size * rom_bank_size;
+
+  if (size == rom.size()) {
+    padded_rom_.reset();
+    rom_ = rom.data();
+  } else {
+    auto padded = std::make_shared<Bytes>(size, 0xFF);
+    std::copy(rom.data(), rom.data() + rom.size(), padded->begin());
+    padded_rom_ = padded;
+    rom_ = padded_rom_->data();
+  }
+  rom_banks_ = size / rom_bank_size;
 }
 
 void MBC::prepareRam() {
@@ -168,32 +453,55 @@ void MBC::prepareRam() {
     case 0x03:
       ram_.assign(0x8000, 0);
       break;
+    case 0x04:
+      ram_.assign(0x20000, 0);
+      break;
+    case 0x05:
+      ram_.assign(0x10000, 0);
+      break;
     default:
       throw std::runtime_error("Invalid MBC RAM size");
   }
 }
 
-void MBC::enableRam(Byte byte) {
-  byte &= 0x0F;
-  ram_enable_ = byte == 0x0A;
+// Bank numbers past the end of the cartridge wrap around like the unused
+// high bank lines do on hardware
+void MBC::mapRom(std::size_t bank0, std::size_t bankx) {
+  rom0_ = rom_ + (bank0 % rom_banks_) * rom_bank_size;
+  romx_ = rom_ + (bankx % rom_banks_) * rom_bank_size;
 }
 
-void MBC::selectRomBank(Byte byte) {
-  byte &= 0x1F;
-  rom_bank_ &= 0xE0;
-  rom_bank_ |= byte;
+void MBC::mapRam(std::size_t bank) {
+  std::size_t banks = std::max<std::size_t>(ramSize() / ram_bank_size, 1);
+  ram_offset_ = (bank % banks) * ram_bank_size;
 }
 
-void MBC::selectModeSpecificSelect(Byte byte) {
-  byte &= 0x03;
-  if (ram_banking_) {
-    ram_bank_ = byte;
-  } else {
-    rom_bank_ &= 0x1F;
-    rom_bank_ |= byte << 5;
+void MBC::enableRam(bool enable) {
+  // Games disable RAM once they're done saving, a good time to persist it
+  if (ram_enable_ && !enable && save_file_) {
+    storeClock();
+    save_file_->requestFlush();
   }
+  ram_enable_ = enable;
 }
 
-void MBC::selectModeSelect(Byte byte) { ram_banking_ = byte & 0x01; }
+void MBC::storeClock() {
+  if (!has_timer_ || !save_file_) {
+    return;
+  }
+
+  RTC rtc = rtc_;
+  rtc.advance(now());
+  Byte footer[RTC::footer_size];
+  rtc.writeFooter(footer, std::time(nullptr));
+
+  // Leave unchanged bytes alone so their pages don't get flushed again
+  std::size_t offset = ram_.size();
+  for (std::size_t i = 0; i < RTC::footer_size; i++) {
+    if (save_file_->read(offset + i) != footer[i]) {
+      save_file_->write(offset + i, footer[i]);
+    }
+  }
+}
 
 }  // namespace gb
@@ -1,6 +1,12 @@
 #ifndef GEEBEE_SRC_MBC_H
 #define GEEBEE_SRC_MBC_H
 
+#include <memory>
+#include <string>
+
+#include "RTC.h"
+#include "SaveFile.h"
+#include "SharedBytes.h"
 #include "types.h"
 
 namespace gb {
@@ -9,22 +15,107 @@ class Program;
 
 class MBC {
  public:
+  struct State {
+    bool ram_enable{false};
+    Word rom_bank{0};
+    Byte ram_bank{0};
+    bool ram_banking{false};
+    SharedBytes ram;
+    RTC::State rtc;
+  };
+
   explicit MBC(const Program& program);
-  ~MBC() = default;
+  // Copies get a private copy of battery RAM rather than the save file.
+  MBC(const MBC& mbc);
+  ~MBC();
+
+  // The memory bank controller used by a cartridge type, 0 for none and -1
+  // for unsupported types.
+  static int controller(int type);
+  // Whether a cartridge type keeps its RAM alive with a battery.
+  static bool battery(int type);
+
+  // Drives the clock of MBC3 timer cartridges with the emulated cycle count.
+  void setClock(const uint64_t* cycles) { clock_ = cycles; }
+
+  // Backs battery RAM and the clock with the given .sav file, replacing the
+  // current contents with the file's. Returns false if the cartridge has
+  // neither battery RAM nor a clock or the file can't be mapped.
+  bool attachSaveFile(const std::string& filename);
+  SaveFile* saveFile() { return save_file_.get(); }
+  const SaveFile* saveFile() const { return save_file_.get(); }
+
+  void save(State& state) const;
+  void load(const State& state);
+
+  // Only valid while no save file is attached.
+  const SharedBytes& ram() const { return ram_; }
+  // Cartridge RAM wherever it currently lives.
+  const Byte* ramData() const {
+    return save_file_ ? save_file_->data() : ram_.data();
+  }
+  std::size_t ramSize() const { return ram_.size(); }
+  // Bytes of cartridge RAM this MBC does not share with any other
+  std::size_t footprint() const { return ram_.shared() ? 0 : ram_.size(); }
+  const RTC& rtc() const { return rtc_; }
+
+  // Whether an MBC5 rumble cartridge currently drives its motor.
+  bool rumble() const { return has_rumble_ && (ram_bank_ & 0x08); }
 
   void reset();
-  Byte read(Word address) const;
-  void write(Word address, Byte byte);
+  // Puts the bank registers back to power on, keeping the RAM and clock
+  void resetRegisters();
+  Byte read(Word address) const {
+    if (address < 0x4000) {
+      return rom0_[address];
+    } else if (address < 0x8000) {
+      return romx_[address - 0x4000];
+    }
+    return read_ram_(*this, address);
+  }
+  void write(Word address, Byte byte) { write_(*this, address, byte); }
+  // The bank currently mapped at a 0000-7FFF address
+  Word romBank(Word address) const {
+    return static_cast<Word>((romData(address) - rom_) / 0x4000);
+  }
+  // The currently mapped ROM from a 0000-7FFF address to the end of its bank
+  const Byte* romData(Word address) const {
+    return address < 0x4000 ? rom0_ + address : romx_ + (address - 0x4000);
+  }
 
  private:
-  uint32_t translateRomAddress(Word address) const;
+  // One policy per controller, chosen once by reset(). Each remaps the
+  // cached banks only when a bank register is written.
+  struct Generic;
+  struct None;
+  struct Mbc1;
+  struct Mbc2;
+  struct Mbc3;
+  struct Mbc5;
+
+  template <typename Policy>
+  void use();
 
+  void prepareRom();
   void prepareRam();
 
-  void enableRam(Byte byte);
-  void selectRomBank(Byte byte);
-  void selectModeSpecificSelect(Byte byte);
-  void selectModeSelect(Byte byte);
+  void mapRom(std::size_t bank0, std::size_t bankx);
+  void mapRam(std::size_t bank);
+  void enableRam(bool enable);
+  uint64_t now() const { return clock_ ? *clock_ : 0; }
+  // Writes the clock footer into the save file
+  void storeClock();
+
+  Byte ramByte(std::size_t offset) const {
+    return save_file_ ? save_file_->read(offset) : ram_[offset];
+  }
+  void setRamByte(std::size_t offset, Byte byte) {
+    if (save_file_) {
+      save_file_->write(offset, byte);
+    } else {
+      ram_.set(offset, byte);
+    }
+  }
 
   const Program& program_;
 
@@ -33,13 +124,31 @@ class MBC {
   bool has_ram_{false};
   bool has_battery_{false};
   bool has_timer_{false};
+  bool has_rumble_{false};
 
   bool ram_enable_{false};
-  Byte rom_bank_{0};
+  Word rom_bank_{0};
   Byte ram_bank_{0};
   bool ram_banking_{false};
 
-  Bytes ram_;
+  // ROMs that don't fill whole banks get padded with 0xFF, in a copy shared
+  // with clones like the ROM itself
+  std::shared_ptr<const Bytes> padded_rom_;
+  const Byte* rom_{nullptr};
+  std::size_t rom_banks_{0};
+  const Byte* rom0_{nullptr};
+  const Byte* romx_{nullptr};
+  std::size_t ram_offset_{0};
+
+  void (*write_)(MBC& mbc, Word address, Byte byte){nullptr};
+  Byte (*read_ram_)(const MBC& mbc, Word address){nullptr};
+  void (*update_)(MBC& mbc){nullptr};
+
+  SharedBytes ram_;
+  std::unique_ptr<SaveFile> save_file_;
+
+  RTC rtc_;
+  const uint64_t* clock_{nullptr};
 };
 
 }  // namespace gb
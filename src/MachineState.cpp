@@ -0,0 +1,18 @@
+#include "MachineState.h"
+
+#include "Arena.h"
+
+namespace gb {
+
+const MachineState& MachineState::blank() {
+  static const MachineState state{};
+  return state;
+}
+
+void* MachineState::operator new(std::size_t size) {
+  return Arena::allocate(size, cache_line);
+}
+
+void MachineState::operator delete(void* block) { Arena::deallocate(block); }
+
+}  // namespace gb
@@ -0,0 +1,118 @@
+#ifndef GEEBEE_SRC_MACHINESTATE_H
+#define GEEBEE_SRC_MACHINESTATE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "types.h"
+
+namespace gb {
+
+// All mutable guest state of a machine outside of the cartridge, in one block
+// of fixed size arrays that Memory owns and every part of the machine works
+// on. Resetting, snapshotting and cloning a machine are plain copies of it.
+//
+// The registers and the small regions touched on every instruction come
+// first, so they share the first few cache lines of the block.
+struct MachineState {
+  static const std::size_t cache_line = 64;
+
+  struct Cpu {
+    Byte a{0};
+    Byte f{0};
+    Byte b{0};
+    Byte c{0};
+    Byte d{0};
+    Byte e{0};
+    Byte h{0};
+    Byte l{0};
+
+    Word sp{0};
+    Word pc{0};
+
+    bool interrupts{false};
+    bool halt{false};
+    bool zero{false};
+    bool add{false};
+    bool half_carry{false};
+    bool carry{false};
+  };
+
+  struct Timer {
+    int divider{0};
+    int counter{0};
+  };
+
+  enum class LcdMode : int { HBlank = 0, VBlank = 1, OAM = 2, VRAM = 3 };
+  struct Lcd {
+    bool enabled{false};
+    LcdMode mode{LcdMode::HBlank};
+    int mode_timing{0};
+    bool done_frame{true};
+  };
+
+  // One key per Joypad::Key
+  using Joypad = std::array<bool, 8>;
+
+  struct Memory {
+    std::array<Byte, 0xFFFF - 0xFF80> hram{};
+    // All I/O registers, with the interrupt enable flag at FFFF last
+    std::array<Byte, 0xFF80 - 0xFF00 + 1> io{};
+
+    // Clock cycles emulated since reset
+    uint64_t cycles{0};
+    uint64_t dma_end{0};
+    bool dma{false};
+    bool booting{true};
+    bool oam_access{true};
+    bool vram_access{true};
+
+    std::array<Byte, 0xFEA0 - 0xFE00> sat{};
+    std::array<Byte, 0xE000 - 0xC000> ram{};
+    std::array<Byte, 0xA000 - 0x8000> vram{};
+  };
+
+  // Every field is an int so states have no padding and hash reproducibly
+  struct Channel {
+    int enabled{0};
+    int length{0};
+    int volume{0};
+    int envelope_timer{0};
+    // Clocks until the next waveform step
+    int timer{0};
+    int position{0};
+    int lfsr{0x7FFF};
+    int shadow_frequency{0};
+    int sweep_timer{0};
+    int sweep_enabled{0};
+  };
+  struct Apu {
+    std::array<Channel, 4> channels;
+    int sequencer_step{0};
+    int sequencer_timing{0};
+  };
+
+  Cpu cpu;
+  Timer timer;
+  Lcd lcd;
+  Joypad joypad{};
+  Memory memory;
+  Apu apu;
+
+  // The state of a machine that was just switched on
+  static const MachineState& blank();
+
+  // Blocks allocated with new start on a cache line of their own, in the
+  // arena of the thread if it has one
+  static void* operator new(std::size_t size);
+  static void operator delete(void* block);
+};
+
+static_assert(std::is_trivially_copyable<MachineState>::value,
+              "Machine states are copied as plain bytes");
+
+}  // namespace gb
+
+#endif
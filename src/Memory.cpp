@@ -7,40 +7,106 @@
 
 #include "IOHandler.h"
 #include "Program.h"
+#include "Timeline.h"
 
 namespace gb {
 
-Memory::Memory(const Program& program) : program_(program), mbc_(program) {
+Memory::Memory(const Program& program)
+    : program_(program),
+      machine_(new MachineState),
+      regions_(machine_->memory),
+      mbc_(program) {
+  mbc_.setClock(&regions_.cycles);
   for (IOHandler*& handler : io_handlers_) {
     handler = nullptr;
   }
+  serial_data_.reserve(serial_capacity);
   reset();
 }
 
-void Memory::reset() {
-  booting_ = true;
-
-  ram_.assign(0x2000, 0);
-  vram_.assign(0x2000, 0);
-  sat_.assign(0xFEA0 - 0xFE00, 0);
-  // All I/O flags + the single flag at FFFF
-  io_.assign(0xFF80 - 0xFF00 + 1, 0);
-  hram_.assign(0xFFFF - 0xFF80, 0);
+Memory::Memory(const Memory& memory)
+    : program_(memory.program_),
+      machine_(new MachineState(*memory.machine_)),
+      regions_(machine_->memory),
+      mbc_(memory.mbc_),
+      serial_data_(memory.serial_data_) {
+  serial_data_.reserve(serial_capacity);
+  mbc_.setClock(&regions_.cycles);
+  for (IOHandler*& handler : io_handlers_) {
+    handler = nullptr;
+  }
+}
 
-  oam_access_ = true;
-  vram_access_ = true;
+void Memory::reset() { reset(MachineState::blank()); }
 
+void Memory::reset(const MachineState& state) {
+  *machine_ = state;
   io_handling_ = false;
+  // The cartridge keeps its RAM over a reset, but not its bank registers
+  serial_data_.clear();
+  mbc_.resetRegisters();
+}
+
+void Memory::save(State& state) const {
+  state.machine = *machine_;
+  state.serial_data = serial_data_;
+  mbc_.save(state.mbc);
+}
+
+void Memory::load(const State& state) {
+  *machine_ = state.machine;
+  serial_data_ = state.serial_data;
+  mbc_.load(state.mbc);
+}
+
+void Memory::startDma(Byte page) {
+  Word source = page << 8;
+  const Byte* data = dmaSource(source);
+  if (data) {
+    std::copy(data, data + regions_.sat.size(), regions_.sat.begin());
+  } else {
+    for (std::size_t i = 0; i < regions_.sat.size(); i++) {
+      regions_.sat[i] = peek(source + i);
+    }
+  }
+
+  regions_.dma = true;
+  regions_.dma_end = regions_.cycles + dma_cycles;
+}
+
+const Byte* Memory::dmaSource(Word address) const {
+  switch (address & 0xE000) {
+    case 0x0000:
+      if (regions_.booting && address < 0x0100) {
+        return nullptr;
+      }
+      return mbc_.romData(address);
+    case 0x2000:
+    case 0x4000:
+    case 0x6000:
+      return mbc_.romData(address);
+    case 0x8000:
+      return regions_.vram.data() + (address - 0x8000);
+    case 0xC000:
+      return regions_.ram.data() + (address - 0xC000);
+    // Pages E0-FF read from the WRAM echo
+    case 0xE000:
+      return regions_.ram.data() + (address - 0xE000);
+
+    // Cartridge RAM may not be plain memory
+    default:
+      return nullptr;
+  }
 }
 
-Byte Memory::read(Word address) const {
+Byte Memory::peek(Word address) const {
   switch (address & 0xF000) {
     // 16kB ROM Bank 00
     case 0x0000:
     case 0x1000:
     case 0x2000:
     case 0x3000:
-      if (booting_ && in(address, 0x0000, 0x0100)) {
+      if (regions_.booting && in(address, 0x0000, 0x0100)) {
         return program_.bootrom()[address];
       } else {
         return mbc_.read(address);
@@ -56,7 +122,7 @@ Byte Memory::read(Word address) const {
     // 8kB VRAM
     case 0x8000:
     case 0x9000:
-      return vram_access_ ? vram_[address - 0x8000] : 0x00;
+      return regions_.vram_access ? regions_.vram[address - 0x8000] : 0x00;
 
     // 8kB ERAM
     case 0xA000:
@@ -65,14 +131,14 @@ Byte Memory::read(Word address) const {
 
     // 4KB Work RAM Bank 0 (WRAM)
     case 0xC000:
-      return ram_[address - 0xC000];
+      return regions_.ram[address - 0xC000];
 
     // 4KB Work RAM Bank 0 (WRAM)
     case 0xD000:
-      return ram_[address - 0xC000];
+      return regions_.ram[address - 0xC000];
 
     case 0xE000:
-      return ram_[address - 0xC000];
+      return regions_.ram[address - 0xE000];
 
     default:
       break;
@@ -80,11 +146,11 @@ Byte Memory::read(Word address) const {
 
   // Same as C000-DDFF (ECHO)
   if (in(address, 0xE000, 0xFDFF)) {
-    return ram_[address - 0xC000];
+    return regions_.ram[address - 0xE000];
 
     // Sprite Attribute Table (OAM)
   } else if (in(address, 0xFE00, 0xFE9F)) {
-    return oam_access_ ? sat_[address - 0xFE00] : 0x00;
+    return regions_.oam_access ? regions_.sat[address - 0xFE00] : 0x00;
 
     // I/O Ports
   } else if (in(address, 0xFF00, 0xFF7F)) {
@@ -92,21 +158,22 @@ Byte Memory::read(Word address) const {
       io_handling_ = true;
       IOHandler* handler = io_handlers_[address - 0xFF00];
       if (handler) {
+        Timeline::Scope scope{Timeline::MemoryIO};
         Byte byte = handler->read(address);
         io_handling_ = false;
         return byte;
       }
       io_handling_ = false;
     }
-    return io_[address - 0xFF00];
+    return regions_.io[address - 0xFF00];
 
     // High RAM (HRAM)
   } else if (in(address, 0xFF80, 0xFFFE)) {
-    return hram_[address - 0xFF80];
+    return regions_.hram[address - 0xFF80];
 
     // Interrupt Enable Register
   } else if (in(address, 0xFFFF, 0xFFFF)) {
-    return io_.back();
+    return regions_.io.back();
 
     // Not Usable
   } else if (in(address, 0xFEA0, 0xFEFF)) {
@@ -120,6 +187,15 @@ Byte Memory::read(Word address) const {
 }
 
 void Memory::write(Word address, Byte byte) {
+  // The bus drops everything below the I/O registers during DMA, only
+  // writes that take effect go into the hash
+  if (regions_.dma && address < 0xFF00) {
+    return;
+  }
+  if (write_hashing_) {
+    write_hash_ = (write_hash_ ^ ((address << 8) | byte)) * 0x100000001B3ULL;
+  }
+
   switch (address & 0xF000) {
     // 32kB ROM
     case 0x0000:
@@ -136,10 +212,10 @@ void Memory::write(Word address, Byte byte) {
     // 8kB Video RAM (VRAM)
     case 0x8000:
     case 0x9000:
-      if (!vram_access_) {
+      if (!regions_.vram_access) {
         return;
       }
-      vram_[address - 0x8000] = byte;
+      regions_.vram[address - 0x8000] = byte;
       return;
 
     // 8kB External RAM
@@ -150,17 +226,17 @@ void Memory::write(Word address, Byte byte) {
 
     // 4KB Work RAM Bank 0 (WRAM)
     case 0xC000:
-      ram_[address - 0xC000] = byte;
+      regions_.ram[address - 0xC000] = byte;
       return;
 
     // 4KB Work RAM Bank 1 (WRAM)
     case 0xD000:
-      ram_[address - 0xC000] = byte;
+      regions_.ram[address - 0xC000] = byte;
       return;
 
     // Same as C000-DDFF (ECHO)
     case 0xE000:
-      ram_[address - 0xC000] = byte;
+      regions_.ram[address - 0xE000] = byte;
       return;
 
     default:
@@ -169,14 +245,14 @@ void Memory::write(Word address, Byte byte) {
 
   // Same as C000-DDFF (ECHO)
   if (in(address, 0xE000, 0xFDFF)) {
-    ram_[address - 0xC000] = byte;
+    regions_.ram[address - 0xE000] = byte;
 
     // Sprite Attribute Table (OAM)
   } else if (in(address, 0xFE00, 0xFE9F)) {
-    if (!oam_access_) {
+    if (!regions_.oam_access) {
       return;
     }
-    sat_[address - 0xFE00] = byte;
+    regions_.sat[address - 0xFE00] = byte;
 
     // I/O Ports
   } else if (in(address, 0xFF00, 0xFF7F)) {
@@ -184,6 +260,7 @@ void Memory::write(Word address, Byte byte) {
       io_handling_ = true;
       IOHandler* handler = io_handlers_[address - 0xFF00];
       if (handler) {
+        Timeline::Scope scope{Timeline::MemoryIO};
         handler->write(address, byte);
         io_handling_ = false;
         return;
@@ -192,21 +269,24 @@ void Memory::write(Word address, Byte byte) {
     }
 
     if (address == Register::SerialTransferControl) {
-      serial_data_.push_back(io_[Register::SerialTransferData - 0xFF00]);
+      if (serial_data_.size() >= serial_capacity) {
+        serial_data_.erase(0, serial_data_.size() - serial_capacity / 2);
+      }
+      serial_data_.push_back(regions_.io[Register::SerialTransferData - 0xFF00]);
     }
 
     if (address == Register::BootMode && byte != 0x0) {
-      booting_ = false;
+      regions_.booting = false;
     }
 
-    io_[address - 0xFF00] = byte;
+    regions_.io[address - 0xFF00] = byte;
     // High RAM (HRAM)
   } else if (in(address, 0xFF80, 0xFFFE)) {
-    hram_[address - 0xFF80] = byte;
+    regions_.hram[address - 0xFF80] = byte;
 
     // Interrupt Enable Register
   } else if (in(address, 0xFFFF, 0xFFFF)) {
-    io_.back() = byte;
+    regions_.io.back() = byte;
 
     // Not Usable
   } else if (in(address, 0xFEA0, 0xFEFF)) {
@@ -2,9 +2,11 @@
 #define GEEBEE_SRC_MEMORY_H
 
 #include <array>
+#include <memory>
 #include <string>
 
 #include "MBC.h"
+#include "MachineState.h"
 #include "types.h"
 
 namespace gb {
@@ -22,53 +24,107 @@ class Memory {
     InterruptEnable = 0xFFFF
   };
 
+  // A snapshot of the whole machine
+  struct State {
+    MachineState machine;
+    std::string serial_data;
+    MBC::State mbc;
+  };
+
   explicit Memory(const Program& program);
+  // Copies the guest state only. Handlers have to register with the copy.
+  Memory(const Memory& memory);
   ~Memory() = default;
 
-  const Bytes& ram() const { return ram_; }
-  const Bytes& vram() const { return vram_; }
-  const Bytes& sat() const { return sat_; }
-  const Bytes& io() const { return io_; }
-  const Bytes& hram() const { return hram_; }
-  const std::string& serial_data() const { return serial_data_; }
+  void save(State& state) const;
+  void load(const State& state);
 
-  bool booting() const { return booting_; }
-
-  Bytes& ram() { return ram_; }
-  Bytes& vram() { return vram_; }
-  Bytes& sat() { return sat_; }
-  Bytes& io() { return io_; }
-  Bytes& hram() { return hram_; }
+  // The state block of the machine this memory belongs to, which also holds
+  // the state of the CPU and the other parts of the machine
+  MachineState& machine() { return *machine_; }
+  const MachineState& machine() const { return *machine_; }
 
+  const std::array<Byte, 0x2000>& ram() const { return regions_.ram; }
+  const std::array<Byte, 0x2000>& vram() const { return regions_.vram; }
+  const std::array<Byte, 0xA0>& sat() const { return regions_.sat; }
+  const std::array<Byte, 0x81>& io() const { return regions_.io; }
+  const std::array<Byte, 0x7F>& hram() const { return regions_.hram; }
+  const std::string& serial_data() const { return serial_data_; }
+  MBC& mbc() { return mbc_; }
+  const MBC& mbc() const { return mbc_; }
+  // Bytes held outside of the object itself, without the ROM
+  std::size_t footprint() const {
+    return sizeof(MachineState) + serial_data_.capacity() + mbc_.footprint();
+  }
+
+  bool booting() const { return regions_.booting; }
+  // Clock cycles emulated since reset
+  uint64_t cycles() const { return regions_.cycles; }
+  void advance(int cycles) {
+    regions_.cycles += cycles;
+    if (regions_.dma && regions_.cycles >= regions_.dma_end) {
+      regions_.dma = false;
+    }
+  }
+
+  // Copies a page to OAM at once, then keeps the CPU to HRAM and I/O for
+  // the 160 M-cycles the transfer takes on hardware
+  void startDma(Byte page);
+  bool dma() const { return regions_.dma; }
+
+  std::array<Byte, 0xA0>& sat() { return regions_.sat; }
+  std::array<Byte, 0x81>& io() { return regions_.io; }
+  std::array<Byte, 0x7F>& hram() { return regions_.hram; }
+
+  // Puts the whole machine, not only its memory, back to its power on state
   void reset();
-  Byte read(Word address) const;
+  // Starts over from `state` instead of a machine that was just switched on
+  void reset(const MachineState& state);
+  Byte read(Word address) const {
+    return regions_.dma && address < 0xFF00 ? 0xFF : peek(address);
+  }
+  // Reads past the bus restrictions of a running DMA, for observers
+  Byte peek(Word address) const;
   void write(Word address, Byte byte);
 
-  void setOAMAccess(bool enable) { oam_access_ = enable; }
-  void setVRAMAccess(bool enable) { vram_access_ = enable; }
+  // Folds every write, in order, into a running hash, so two machines can be
+  // checked for writing the same values without comparing all of memory.
+  // Enabling it restarts the hash.
+  void setWriteHashing(bool hashing) {
+    write_hashing_ = hashing;
+    write_hash_ = 0;
+  }
+  uint64_t writeHash() const { return write_hash_; }
+
+  void setOAMAccess(bool enable) { regions_.oam_access = enable; }
+  void setVRAMAccess(bool enable) { regions_.vram_access = enable; }
 
   void registerHandler(IOHandler* handler);
   void unregisterHandler(IOHandler* handler);
 
  private:
+  static const int dma_cycles = 160 * 4;
+  // Serial output kept, dropping the older half when it fills up so that
+  // long runs never reallocate it
+  static const std::size_t serial_capacity = 0x1000;
+
   static int in(Word address, Word from, Word to);
+  // Contiguous memory behind a DMA source page, if there is any
+  const Byte* dmaSource(Word address) const;
 
   const Program& program_;
+  // Declared before mbc_, whose clock reads the cycles in it until it is
+  // destroyed
+  std::unique_ptr<MachineState> machine_;
+  MachineState::Memory& regions_;
   MBC mbc_;
 
-  bool booting_{false};
-  bool oam_access_{true};
-  bool vram_access_{true};
-
-  Bytes ram_;
-  Bytes vram_;
-  Bytes sat_;
-  Bytes io_;
-  Bytes hram_;
-
   std::array<IOHandler*, 0xFF80 - 0xFF00> io_handlers_;
   mutable bool io_handling_{false};
   std::string serial_data_;
+
+  bool write_hashing_{false};
+  uint64_t write_hash_{0};
 };
 
 }  // namespace gb
@@ -0,0 +1,25 @@
+#include "Movie.h"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+using std::ifstream;
+using std::ios;
+using std::istreambuf_iterator;
+using std::string;
+
+namespace gb {
+
+Movie::Movie(const string& filename) {
+  if (!fs::exists(filename) || !fs::is_regular_file(filename)) {
+    return;
+  }
+
+  ifstream stream{filename, ios::binary};
+  frames_.assign(istreambuf_iterator<char>(stream),
+                 istreambuf_iterator<char>());
+}
+
+}  // namespace gb
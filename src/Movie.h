@@ -0,0 +1,27 @@
+#ifndef GEEBEE_SRC_MOVIE_H
+#define GEEBEE_SRC_MOVIE_H
+
+#include <string>
+
+#include "types.h"
+
+namespace gb {
+
+// Recorded joypad input, one byte per frame in the format of Joypad::set.
+class Movie {
+ public:
+  Movie() = default;
+  explicit Movie(const std::string& filename);
+  ~Movie() = default;
+
+  bool is_valid() const { return !frames_.empty(); }
+  std::size_t size() const { return frames_.size(); }
+  Byte operator[](std::size_t frame) const { return frames_[frame]; }
+
+ private:
+  Bytes frames_;
+};
+
+}  // namespace gb
+
+#endif
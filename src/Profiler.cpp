@@ -0,0 +1,313 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "Program.h"
+
+namespace gb {
+
+namespace {
+
+bool isCall(Byte op) {
+  switch (op) {
+    case 0xC4:
+    case 0xCC:
+    case 0xCD:
+    case 0xD4:
+    case 0xDC:
+      return true;
+    default:
+      // RST
+      return (op & 0xC7) == 0xC7;
+  }
+}
+
+bool isVector(Word address) {
+  return address >= 0x40 && address <= 0x60 && address % 0x08 == 0;
+}
+
+bool isReturn(Byte op) {
+  switch (op) {
+    case 0xC0:
+    case 0xC8:
+    case 0xC9:
+    case 0xD0:
+    case 0xD8:
+    case 0xD9:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string hexLocation(uint32_t location) {
+  char text[16];
+  std::snprintf(text, sizeof(text), "%02X:%04X", location >> 16,
+                location & 0xFFFF);
+  return text;
+}
+
+double percent(uint64_t part, uint64_t total) {
+  return total ? 100.0 * part / total : 0.0;
+}
+
+}  // namespace
+
+Profiler::Profiler(const Program& program)
+    : program_(program),
+      rom_bytes_(std::max<std::size_t>(
+          0x8000, (program.rom().size() + 0x3FFF) / 0x4000 * 0x4000)),
+      addresses_(rom_bytes_ + 0x8000) {
+  frames_.push_back(Frame{-1, 0, 0, 0});
+}
+
+bool Profiler::loadSymbols(const std::string& filename) {
+  std::ifstream stream{filename};
+  if (!stream) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    line = line.substr(0, line.find(';'));
+    unsigned int bank = 0;
+    unsigned int address = 0;
+    char name[256];
+    if (std::sscanf(line.c_str(), "%x:%x %255s", &bank, &address, name) !=
+        3) {
+      continue;
+    }
+    // Local labels only mark places inside of functions
+    if (std::string{name}.find('.') != std::string::npos) {
+      continue;
+    }
+    symbols_.push_back(Symbol{location(bank, address), name});
+  }
+  std::sort(symbols_.begin(), symbols_.end(),
+            [](const Symbol& left, const Symbol& right) {
+              return left.location < right.location;
+            });
+  return true;
+}
+
+int Profiler::step(CPU& cpu) {
+  CPU::Registers before = cpu.registers();
+  Byte op = before.halt ? 0x76 : cpu.memory().peek(before.pc);
+  Byte operand = op == 0xCB ? cpu.memory().peek(before.pc + 1) : 0;
+  std::size_t at = index(cpu, before.pc);
+
+  int timing = cpu.step();
+  CPU::Registers after = cpu.registers();
+
+  // A dispatch pushes PC, jumps to a vector and clears IME in one go, which
+  // no instruction does. ADD SP,-2 drops SP the same and RST 40 lands on a
+  // vector too, but neither touches IME.
+  bool pushed = after.sp == static_cast<Word>(before.sp - 2);
+  bool dispatched = pushed && before.interrupts && !after.interrupts &&
+                    isVector(after.pc);
+  bool called = pushed && isCall(op);
+  total_.cycles += timing;
+  if (dispatched) {
+    // The instruction at PC did not run, an interrupt was dispatched instead
+    dispatch_cycles_ += timing;
+    call(locationOf(index(cpu, after.pc)));
+    frames_[current_].cycles += timing;
+    return timing;
+  }
+
+  total_.instructions++;
+  Count& count = addresses_[at];
+  count.instructions++;
+  count.cycles += timing;
+  Count& by_opcode = opcodes_[op == 0xCB ? 0x100 + operand : op];
+  by_opcode.instructions++;
+  by_opcode.cycles += timing;
+  frames_[current_].cycles += timing;
+
+  if (called) {
+    call(locationOf(index(cpu, after.pc)));
+  } else if (!before.halt && isReturn(op) &&
+             after.sp == static_cast<Word>(before.sp + 2)) {
+    ret();
+  }
+  return timing;
+}
+
+const Profiler::Count& Profiler::at(Word bank, Word address) const {
+  if (address >= 0x8000) {
+    return addresses_[rom_bytes_ + address - 0x8000];
+  }
+  return addresses_[bank * 0x4000 + (address & 0x3FFF)];
+}
+
+std::string Profiler::name(Word bank, Word address) const {
+  return frameName(location(bank, address));
+}
+
+std::size_t Profiler::index(const CPU& cpu, Word pc) const {
+  if (pc >= 0x8000) {
+    return rom_bytes_ + pc - 0x8000;
+  }
+  return cpu.memory().mbc().romBank(pc) * 0x4000 + (pc & 0x3FFF);
+}
+
+uint32_t Profiler::locationOf(std::size_t index) const {
+  if (index >= rom_bytes_) {
+    return location(0, static_cast<Word>(0x8000 + index - rom_bytes_));
+  }
+  Word bank = static_cast<Word>(index / 0x4000);
+  return location(bank, static_cast<Word>((bank ? 0x4000 : 0) +
+                                          index % 0x4000));
+}
+
+std::string Profiler::frameName(uint32_t location) const {
+  auto symbol = std::upper_bound(
+      symbols_.begin(), symbols_.end(), location,
+      [](uint32_t location, const Symbol& symbol) {
+        return location < symbol.location;
+      });
+  if (symbol == symbols_.begin() ||
+      ((symbol - 1)->location >> 16) != (location >> 16)) {
+    return hexLocation(location);
+  }
+  --symbol;
+  if (symbol->location == location) {
+    return symbol->name;
+  }
+  std::ostringstream name;
+  name << symbol->name << "+" << (location - symbol->location);
+  return name.str();
+}
+
+void Profiler::call(uint32_t location) {
+  if (frames_[current_].depth >= max_depth) {
+    overflow_++;
+    return;
+  }
+  uint64_t key = (static_cast<uint64_t>(current_) << 32) | location;
+  auto child = children_.find(key);
+  if (child == children_.end()) {
+    frames_.push_back(
+        Frame{current_, location, frames_[current_].depth + 1, 0});
+    child = children_.emplace(key, static_cast<int>(frames_.size() - 1))
+                .first;
+  }
+  current_ = child->second;
+}
+
+void Profiler::ret() {
+  if (overflow_ > 0) {
+    overflow_--;
+  } else if (frames_[current_].parent >= 0) {
+    current_ = frames_[current_].parent;
+  }
+}
+
+void Profiler::writeReport(std::ostream& out, std::size_t top) const {
+  char line[256];
+  out << total_.instructions << " instructions in " << total_.cycles
+      << " cycles, " << dispatch_cycles_ << " of them dispatching interrupts"
+      << "\n";
+
+  // Exclusive cycles of every function, whatever it was called from
+  std::unordered_map<uint32_t, uint64_t> functions;
+  for (const Frame& frame : frames_) {
+    functions[frame.parent < 0 ? 0xFFFFFFFF : frame.location] += frame.cycles;
+  }
+  std::vector<std::pair<uint32_t, uint64_t>> by_function(functions.begin(),
+                                                         functions.end());
+  std::sort(by_function.begin(), by_function.end(),
+            [](const std::pair<uint32_t, uint64_t>& left,
+               const std::pair<uint32_t, uint64_t>& right) {
+              return left.second > right.second;
+            });
+  out << "\nFunctions by exclusive cycles:\n";
+  for (std::size_t i = 0; i < std::min(top, by_function.size()); i++) {
+    std::string name = by_function[i].first == 0xFFFFFFFF
+                           ? "(outside any call)"
+                           : frameName(by_function[i].first);
+    std::snprintf(line, sizeof(line), "%14llu %6.2f%%  %s\n",
+                  static_cast<unsigned long long>(by_function[i].second),
+                  percent(by_function[i].second, total_.cycles),
+                  name.c_str());
+    out << line;
+  }
+
+  std::vector<std::size_t> hot;
+  for (std::size_t i = 0; i < addresses_.size(); i++) {
+    if (addresses_[i].instructions) {
+      hot.push_back(i);
+    }
+  }
+  std::size_t shown = std::min(top, hot.size());
+  std::partial_sort(hot.begin(), hot.begin() + shown, hot.end(),
+                    [this](std::size_t left, std::size_t right) {
+                      return addresses_[left].cycles >
+                             addresses_[right].cycles;
+                    });
+  out << "\nInstructions by cycles:\n";
+  const Rom& rom = program_.rom();
+  for (std::size_t i = 0; i < shown; i++) {
+    const Count& count = addresses_[hot[i]];
+    uint32_t location = locationOf(hot[i]);
+    std::string mnemonic;
+    if (hot[i] + 1 < rom.size()) {
+      mnemonic = CPU::describe(rom.data()[hot[i]], rom.data()[hot[i] + 1]);
+    }
+    std::string name = frameName(location);
+    std::string hex = hexLocation(location);
+    std::snprintf(line, sizeof(line), "%14llu %6.2f%% %12llu  %s  %-12s %s\n",
+                  static_cast<unsigned long long>(count.cycles),
+                  percent(count.cycles, total_.cycles),
+                  static_cast<unsigned long long>(count.instructions),
+                  hex.c_str(), mnemonic.c_str(),
+                  name == hex ? "" : name.c_str());
+    out << line;
+  }
+
+  std::vector<int> opcodes;
+  for (int i = 0; i < 0x200; i++) {
+    if (opcodes_[i].instructions) {
+      opcodes.push_back(i);
+    }
+  }
+  std::sort(opcodes.begin(), opcodes.end(), [this](int left, int right) {
+    return opcodes_[left].cycles > opcodes_[right].cycles;
+  });
+  out << "\nOpcodes by cycles:\n";
+  for (std::size_t i = 0; i < std::min(top, opcodes.size()); i++) {
+    int op = opcodes[i];
+    const Count& count = opcodes_[op];
+    const std::string& mnemonic =
+        op >= 0x100 ? CPU::describe(0xCB, op - 0x100) : CPU::describe(op, 0);
+    std::snprintf(line, sizeof(line), "%14llu %6.2f%% %12llu  %s\n",
+                  static_cast<unsigned long long>(count.cycles),
+                  percent(count.cycles, total_.cycles),
+                  static_cast<unsigned long long>(count.instructions),
+                  mnemonic.c_str());
+    out << line;
+  }
+}
+
+void Profiler::writeCollapsed(std::ostream& out) const {
+  for (std::size_t i = 0; i < frames_.size(); i++) {
+    if (!frames_[i].cycles) {
+      continue;
+    }
+    std::vector<std::string> names;
+    for (int frame = static_cast<int>(i); frames_[frame].parent >= 0;
+         frame = frames_[frame].parent) {
+      names.push_back(frameName(frames_[frame].location));
+    }
+    out << "(root)";
+    for (auto name = names.rbegin(); name != names.rend(); ++name) {
+      out << ";" << *name;
+    }
+    out << " " << frames_[i].cycles << "\n";
+  }
+}
+
+}  // namespace gb
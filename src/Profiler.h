@@ -0,0 +1,104 @@
+#ifndef GEEBEE_SRC_PROFILER_H
+#define GEEBEE_SRC_PROFILER_H
+
+#include <array>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CPU.h"
+#include "types.h"
+
+namespace gb {
+
+class Program;
+
+// Counts the instructions and cycles a guest spends at every (ROM bank, PC)
+// and on every opcode, including CB prefixed ones. A shadow call stack,
+// kept from the CALLs, RSTs, interrupts and RETs it sees, attributes cycles
+// to guest functions, which RGBDS .sym files can give names to.
+class Profiler {
+ public:
+  struct Count {
+    uint64_t instructions{0};
+    uint64_t cycles{0};
+  };
+
+  explicit Profiler(const Program& program);
+  Profiler(const Profiler& profiler) = delete;
+  Profiler(Profiler&& profiler) = delete;
+  ~Profiler() = default;
+  Profiler& operator=(const Profiler& profiler) = delete;
+  Profiler& operator=(const Profiler&& profiler) = delete;
+
+  // Reads the global labels of an RGBDS .sym file. Returns false if the file
+  // can't be read.
+  bool loadSymbols(const std::string& filename);
+  std::size_t symbols() const { return symbols_.size(); }
+
+  // Runs a frame of `cpu` like CPU::cycle(), profiling every instruction.
+  void cycle(CPU& cpu) {
+    cpu.cycle([this, &cpu]() { return step(cpu); });
+  }
+  int step(CPU& cpu);
+
+  uint64_t instructions() const { return total_.instructions; }
+  uint64_t cycles() const { return total_.cycles; }
+  // Counts of the instruction at `address` while `bank` was mapped there.
+  const Count& at(Word bank, Word address) const;
+  const Count& opcode(Byte opcode, Byte operand = 0) const {
+    return opcodes_[opcode == 0xCB ? 0x100 + operand : opcode];
+  }
+  // The label at or before `address` in `bank`, or BB:AAAA without one.
+  std::string name(Word bank, Word address) const;
+
+  // Hottest functions, instructions and opcodes as text.
+  void writeReport(std::ostream& out, std::size_t top = 20) const;
+  // One line per call stack with its exclusive cycles, for flamegraph.pl.
+  void writeCollapsed(std::ostream& out) const;
+
+ private:
+  struct Symbol {
+    uint32_t location;
+    std::string name;
+  };
+  // One unique call stack, which its callees point back to
+  struct Frame {
+    int parent;
+    uint32_t location;
+    int depth;
+    uint64_t cycles;
+  };
+
+  static const int max_depth = 256;
+
+  static uint32_t location(Word bank, Word address) {
+    return (static_cast<uint32_t>(bank) << 16) | address;
+  }
+  std::size_t index(const CPU& cpu, Word pc) const;
+  uint32_t locationOf(std::size_t index) const;
+  std::string frameName(uint32_t location) const;
+  void call(uint32_t location);
+  void ret();
+
+  const Program& program_;
+  std::size_t rom_bytes_;
+  // ROM banks first, then everything from 0x8000 on
+  std::vector<Count> addresses_;
+  std::array<Count, 0x200> opcodes_;
+  Count total_;
+  uint64_t dispatch_cycles_{0};
+
+  std::vector<Symbol> symbols_;
+
+  std::vector<Frame> frames_;
+  std::unordered_map<uint64_t, int> children_;
+  int current_{0};
+  // Calls past max_depth, which are not tracked
+  int overflow_{0};
+};
+
+}  // namespace gb
+
+#endif
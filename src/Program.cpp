@@ -4,8 +4,9 @@
 #include <sstream>
 
 #include <boost/filesystem.hpp>
-#include <boost/range/adaptors.hpp>
-#include <boost/range/algorithm_ext.hpp>
+
+#include "Arena.h"
+#include "RomCache.h"
 
 namespace fs = boost::filesystem;
 using std::ifstream;
@@ -15,28 +16,70 @@ using std::string;
 
 namespace gb {
 
-Program::Program(const string& rom_filename, const string& bootrom_filename) {
-  if (!fs::exists(rom_filename) || !fs::is_regular_file(rom_filename)) {
+Program::Program(const string& rom_filename, const string& bootrom_filename)
+    : rom_(RomCache::global().load(rom_filename)) {
+  if (rom_->empty()) {
     return;
   }
 
-  {
-    ifstream rom_stream{rom_filename, ios::binary};
-    rom_.assign(istreambuf_iterator<char>(rom_stream),
-                istreambuf_iterator<char>());
-  }
-
   if (fs::exists(bootrom_filename) && fs::is_regular_file(bootrom_filename)) {
     ifstream bootrom_stream{bootrom_filename, ios::binary};
     bootrom_.assign(istreambuf_iterator<char>(bootrom_stream),
                     istreambuf_iterator<char>());
   }
 
-  boost::push_back(title_, rom_ | boost::adaptors::sliced(0x0134, 0x0134 + 11));
+  readHeader();
+}
+
+Program::Program(Bytes rom, Bytes bootrom)
+    : rom_(std::make_shared<Rom>(std::move(rom))),
+      bootrom_(std::move(bootrom)) {
+  readHeader();
+}
+
+const MachineState& Program::bootState(const Boot& boot) const {
+  BootCache& cache = *boot_cache_;
+  std::call_once(cache.once, [&cache, &boot]() {
+    // Outside of any arena, as the cache outlives the machines of one
+    Arena::Scope heap{nullptr};
+    std::unique_ptr<MachineState> state{new MachineState};
+    boot(*state);
+    cache.state = std::move(state);
+  });
+  return *cache.state;
+}
+
+Program::Header Program::parseHeader(const Byte* data) {
+  Header header;
+
+  const char* title = reinterpret_cast<const char*>(data + 0x0134);
+  header.title.assign(title, title + 11);
+
+  header.type = data[0x0147];
+  header.rom_size = data[0x0148];
+  header.ram_size = data[0x0149];
+
+  Byte checksum = 0;
+  for (int i = 0x0134; i <= 0x014C; i++) {
+    checksum = checksum - data[i] - 1;
+  }
+  header.checksum_valid = checksum == data[0x014D];
+
+  return header;
+}
+
+void Program::readHeader() {
+  // Anything without a complete cartridge header is not a valid rom
+  if (rom_->size() < header_end) {
+    rom_ = std::make_shared<Rom>();
+    return;
+  }
 
-  type_ = rom_[0x0147];
-  rom_size_ = rom_[0x0148];
-  ram_size_ = rom_[0x0149];
+  Header header = parseHeader(rom_->data());
+  title_ = header.title;
+  type_ = header.type;
+  rom_size_ = header.rom_size;
+  ram_size_ = header.ram_size;
 }
 
 }  // namespace gb
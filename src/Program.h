@@ -1,16 +1,37 @@
 #ifndef GEEBEE_SRC_PROGRAM_H
 #define GEEBEE_SRC_PROGRAM_H
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 
+#include "MachineState.h"
+#include "Rom.h"
 #include "types.h"
 
 namespace gb {
 
 class Program {
  public:
+  // The parts of the cartridge header at 0x0100-0x014F we care about.
+  struct Header {
+    std::string title;
+    int type{0};
+    int rom_size{0};
+    int ram_size{0};
+    bool checksum_valid{false};
+  };
+  static const std::size_t header_end = 0x0150;
+
+  // Parses the first header_end bytes of a ROM.
+  static Header parseHeader(const Byte* data);
+
+  // Maps the ROM file through RomCache::global(), so every Program of the
+  // same game shares one read-only image.
   explicit Program(const std::string& rom_filename,
                    const std::string& bootrom_filename = "");
+  explicit Program(Bytes rom, Bytes bootrom = Bytes());
   ~Program() = default;
 
   const std::string& title() const { return title_; }
@@ -18,14 +39,28 @@ class Program {
   int rom_size() const { return rom_size_; }
   int ram_size() const { return ram_size_; }
 
-  bool is_valid() const { return !rom_.empty(); }
+  bool is_valid() const { return !rom_->empty(); }
 
-  const Bytes& rom() const { return rom_; }
+  const Rom& rom() const { return *rom_; }
   const Bytes& bootrom() const { return bootrom_; }
 
+  using Boot = std::function<void(MachineState& state)>;
+  // The machine state right after the boot ROM, or what it would leave
+  // behind. `boot` works it out the first time on any thread, every machine
+  // of this program and its copies gets the same state after that.
+  const MachineState& bootState(const Boot& boot) const;
+
  private:
-  Bytes rom_;
+  struct BootCache {
+    std::once_flag once;
+    std::unique_ptr<const MachineState> state;
+  };
+
+  void readHeader();
+
+  std::shared_ptr<const Rom> rom_;
   Bytes bootrom_;
+  std::shared_ptr<BootCache> boot_cache_{std::make_shared<BootCache>()};
 
   std::string title_;
   int type_{0};
@@ -0,0 +1,160 @@
+#include "RTC.h"
+
+namespace gb {
+
+namespace {
+
+const Byte masks[RTC::Register::Count] = {0x3F, 0x3F, 0x1F, 0xFF, 0xC1};
+
+}  // namespace
+
+void RTC::save(State& state) const {
+  state.registers = registers_;
+  state.latched = latched_;
+  state.latch = latch_;
+  state.subsecond = subsecond_;
+  state.last = last_;
+}
+
+void RTC::load(const State& state) {
+  registers_ = state.registers;
+  latched_ = state.latched;
+  latch_ = state.latch;
+  subsecond_ = state.subsecond;
+  last_ = state.last;
+}
+
+Byte RTC::read(Byte select) const {
+  Byte index = select - 0x08;
+  if (index >= Register::Count) {
+    return 0xFF;
+  }
+  return latched_[index];
+}
+
+void RTC::write(Byte select, Byte byte, uint64_t now) {
+  Byte index = select - 0x08;
+  if (index >= Register::Count) {
+    return;
+  }
+
+  advance(now);
+  registers_[index] = byte & masks[index];
+  // Writing the seconds restarts the current second
+  if (index == Seconds) {
+    subsecond_ = 0;
+  }
+}
+
+void RTC::latch(Byte byte, uint64_t now) {
+  if (latch_ == 0x00 && byte == 0x01) {
+    advance(now);
+    latched_ = registers_;
+  }
+  latch_ = byte;
+}
+
+void RTC::advance(uint64_t now) {
+  uint64_t elapsed = now > last_ ? now - last_ : 0;
+  last_ = now;
+  if (halted()) {
+    return;
+  }
+
+  elapsed += subsecond_;
+  subsecond_ = elapsed % cycles_per_second;
+  addSeconds(elapsed / cycles_per_second);
+}
+
+void RTC::addSeconds(uint64_t seconds) {
+  // Out of range values count up to their register limit and wrap without
+  // carrying, so step through those one second at a time
+  while (seconds > 0 && (registers_[Seconds] >= 60 ||
+                         registers_[Minutes] >= 60 || registers_[Hours] >= 24)) {
+    tick();
+    seconds--;
+  }
+  if (seconds == 0) {
+    return;
+  }
+
+  uint64_t days =
+      registers_[DaysLow] | ((registers_[DaysHigh] & 0x01) << 8);
+  uint64_t total =
+      registers_[Seconds] +
+      60 * (registers_[Minutes] + 60 * (registers_[Hours] + 24 * days)) +
+      seconds;
+
+  registers_[Seconds] = total % 60;
+  total /= 60;
+  registers_[Minutes] = total % 60;
+  total /= 60;
+  registers_[Hours] = total % 24;
+  days = total / 24;
+
+  Byte high = registers_[DaysHigh] & 0xC0;
+  if (days > 0x1FF) {
+    high |= 0x80;
+    days &= 0x1FF;
+  }
+  registers_[DaysLow] = days & 0xFF;
+  registers_[DaysHigh] = high | (days >> 8);
+}
+
+void RTC::tick() {
+  Byte& seconds = registers_[Seconds];
+  seconds = (seconds + 1) & 0x3F;
+  if (seconds != 60) {
+    return;
+  }
+  seconds = 0;
+
+  Byte& minutes = registers_[Minutes];
+  minutes = (minutes + 1) & 0x3F;
+  if (minutes != 60) {
+    return;
+  }
+  minutes = 0;
+
+  Byte& hours = registers_[Hours];
+  hours = (hours + 1) & 0x1F;
+  if (hours != 24) {
+    return;
+  }
+  hours = 0;
+
+  if (++registers_[DaysLow] == 0) {
+    if (registers_[DaysHigh] & 0x01) {
+      registers_[DaysHigh] = (registers_[DaysHigh] & 0xFE) | 0x80;
+    } else {
+      registers_[DaysHigh] |= 0x01;
+    }
+  }
+}
+
+void RTC::writeFooter(Byte* footer, int64_t timestamp) const {
+  auto put = [&footer](uint64_t value, int size) {
+    for (int i = 0; i < size; i++) {
+      *footer++ = (value >> (i * 8)) & 0xFF;
+    }
+  };
+  for (Byte value : registers_) {
+    put(value, 4);
+  }
+  for (Byte value : latched_) {
+    put(value, 4);
+  }
+  put(static_cast<uint64_t>(timestamp), 8);
+}
+
+// The stored UNIX time is ignored, time spent switched off doesn't count
+void RTC::readFooter(const Byte* footer, uint64_t now) {
+  for (int i = 0; i < Register::Count; i++) {
+    registers_[i] = footer[i * 4] & masks[i];
+    latched_[i] = footer[(Register::Count + i) * 4] & masks[i];
+  }
+  subsecond_ = 0;
+  last_ = now;
+}
+
+}  // namespace gb
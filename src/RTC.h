@@ -0,0 +1,62 @@
+#ifndef GEEBEE_SRC_RTC_H
+#define GEEBEE_SRC_RTC_H
+
+#include <array>
+
+#include "types.h"
+
+namespace gb {
+
+// MBC3 real time clock counting emulated cycles rather than wall time, so
+// replays and uncapped runs stay deterministic. Time only moves forward when
+// the clock is accessed, by the whole number of seconds since the last
+// access.
+class RTC {
+ public:
+  enum Register : Byte { Seconds, Minutes, Hours, DaysLow, DaysHigh, Count };
+
+  struct State {
+    std::array<Byte, Register::Count> registers{};
+    std::array<Byte, Register::Count> latched{};
+    Byte latch{0xFF};
+    uint32_t subsecond{0};
+    uint64_t last{0};
+  };
+
+  static const uint32_t cycles_per_second = 4194304;
+  // Current and latched registers as 32 bit values plus a 64 bit UNIX time,
+  // the footer most emulators append to MBC3 save files
+  static const std::size_t footer_size = 48;
+
+  RTC() = default;
+  ~RTC() = default;
+
+  void save(State& state) const;
+  void load(const State& state);
+
+  // Registers are selected by the MBC3 RAM bank values 08-0C
+  Byte read(Byte select) const;
+  void write(Byte select, Byte byte, uint64_t now);
+  // Writing 00 and then 01 latches the current time
+  void latch(Byte byte, uint64_t now);
+
+  void advance(uint64_t now);
+
+  void writeFooter(Byte* footer, int64_t timestamp) const;
+  void readFooter(const Byte* footer, uint64_t now);
+
+ private:
+  bool halted() const { return registers_[DaysHigh] & 0x40; }
+  void addSeconds(uint64_t seconds);
+  void tick();
+
+  std::array<Byte, Register::Count> registers_{};
+  std::array<Byte, Register::Count> latched_{};
+  Byte latch_{0xFF};
+  uint32_t subsecond_{0};
+  uint64_t last_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,28 @@
+#include "Rom.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace ipc = boost::interprocess;
+
+namespace gb {
+
+Rom::Rom(Bytes bytes)
+    : bytes_(std::move(bytes)), data_(bytes_.data()), size_(bytes_.size()) {}
+
+Rom::Rom(const std::string& filename) {
+  try {
+    ipc::file_mapping file{filename.c_str(), ipc::read_only};
+    auto region = std::make_shared<ipc::mapped_region>(file, ipc::read_only);
+    data_ = static_cast<const Byte*>(region->get_address());
+    size_ = region->get_size();
+    mapping_ = region;
+    mapped_ = true;
+  } catch (const ipc::interprocess_exception&) {
+    // Empty or unreadable files
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace gb
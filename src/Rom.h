@@ -0,0 +1,43 @@
+#ifndef GEEBEE_SRC_ROM_H
+#define GEEBEE_SRC_ROM_H
+
+#include <memory>
+#include <string>
+
+#include "types.h"
+
+namespace gb {
+
+// Immutable cartridge image, either mapped read-only from a file or held in
+// memory. Machines of the same game share one Rom through RomCache.
+class Rom {
+ public:
+  Rom() = default;
+  explicit Rom(Bytes bytes);
+  // Maps the whole file, leaving the Rom empty if that fails.
+  explicit Rom(const std::string& filename);
+  Rom(const Rom& rom) = delete;
+  Rom(Rom&& rom) = delete;
+  ~Rom() = default;
+  Rom& operator=(const Rom& rom) = delete;
+  Rom& operator=(const Rom&& rom) = delete;
+
+  bool empty() const { return size_ == 0; }
+  std::size_t size() const { return size_; }
+  const Byte* data() const { return data_; }
+  Byte operator[](std::size_t index) const { return data_[index]; }
+
+  bool mapped() const { return mapped_; }
+
+ private:
+  Bytes bytes_;
+  std::shared_ptr<const void> mapping_;
+  bool mapped_{false};
+
+  const Byte* data_{nullptr};
+  std::size_t size_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,84 @@
+#include "RomCache.h"
+
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+#include "hash.h"
+
+namespace fs = boost::filesystem;
+
+namespace gb {
+
+RomCache& RomCache::global() {
+  static RomCache cache;
+  return cache;
+}
+
+std::shared_ptr<const Rom> RomCache::load(const std::string& filename) {
+  boost::system::error_code error;
+  fs::path path = fs::canonical(filename, error);
+  if (error || !fs::is_regular_file(path)) {
+    return std::make_shared<Rom>();
+  }
+  uintmax_t size = fs::file_size(path);
+  std::time_t modified = fs::last_write_time(path);
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  Entry& entry = entries_[path.string()];
+  std::shared_ptr<const Rom> rom = entry.rom.lock();
+  if (rom && entry.size == size && entry.modified == modified) {
+    return rom;
+  }
+
+  rom = std::make_shared<Rom>(path.string());
+  entry = Entry{};
+  entry.rom = rom;
+  entry.size = size;
+  entry.modified = modified;
+
+  // Share the image of an identical file under another name
+  for (auto& other : entries_) {
+    if (&other.second == &entry || other.second.size != size) {
+      continue;
+    }
+    std::shared_ptr<const Rom> existing = other.second.rom.lock();
+    if (!existing || existing->size() != rom->size() ||
+        hash(other.second, *existing) != hash(entry, *rom) ||
+        std::memcmp(existing->data(), rom->data(), rom->size()) != 0) {
+      continue;
+    }
+    entry.rom = existing;
+    rom = existing;
+    break;
+  }
+
+  prune();
+  return rom;
+}
+
+std::size_t RomCache::size() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  prune();
+  return entries_.size();
+}
+
+uint64_t RomCache::hash(Entry& entry, const Rom& rom) {
+  if (!entry.hashed) {
+    entry.hash = hash::bytes(rom.data(), rom.size());
+    entry.hashed = true;
+  }
+  return entry.hash;
+}
+
+void RomCache::prune() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.rom.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace gb
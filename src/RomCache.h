@@ -0,0 +1,52 @@
+#ifndef GEEBEE_SRC_ROMCACHE_H
+#define GEEBEE_SRC_ROMCACHE_H
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Rom.h"
+
+namespace gb {
+
+// Hands out one shared Rom per ROM file for as long as anybody uses it.
+// Files are looked up by path first; a different path to a file with the same
+// contents also ends up with the same Rom. Only ROMs of equal size are ever
+// hashed, so loading a new game costs one mmap and no reads.
+class RomCache {
+ public:
+  static RomCache& global();
+
+  RomCache() = default;
+  RomCache(const RomCache& cache) = delete;
+  RomCache(RomCache&& cache) = delete;
+  ~RomCache() = default;
+  RomCache& operator=(const RomCache& cache) = delete;
+  RomCache& operator=(const RomCache&& cache) = delete;
+
+  // Returns an empty Rom for missing files.
+  std::shared_ptr<const Rom> load(const std::string& filename);
+  // Number of ROMs that are currently loaded.
+  std::size_t size();
+
+ private:
+  struct Entry {
+    std::weak_ptr<const Rom> rom;
+    uintmax_t size{0};
+    std::time_t modified{0};
+    uint64_t hash{0};
+    bool hashed{false};
+  };
+
+  uint64_t hash(Entry& entry, const Rom& rom);
+  void prune();
+
+  std::mutex mutex_;
+  std::map<std::string, Entry> entries_;
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,298 @@
+#include "RomIndex.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "MBC.h"
+#include "Rom.h"
+#include "hash.h"
+
+namespace fs = boost::filesystem;
+
+namespace gb {
+
+const int RomIndex::version_ = 1;
+
+namespace {
+
+bool isRom(const fs::path& path) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](char c) { return std::tolower(c); });
+  return extension == ".gb" || extension == ".gbc" || extension == ".sgb";
+}
+
+// Titles are stored as a tab separated column.
+std::string printable(const std::string& text) {
+  std::string result;
+  for (char c : text) {
+    if (c >= 0x20 && c <= 0x7E) {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+RomIndex::RomIndex(const std::string& filename, int threads)
+    : filename_(filename), pool_(threads) {
+  load();
+}
+
+RomIndex::~RomIndex() { pool_.wait(); }
+
+RomIndex::Stats RomIndex::scan(const std::vector<std::string>& directories) {
+  std::vector<std::string> roots;
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stats_ = Stats{};
+    seen_.clear();
+  }
+
+  for (const std::string& directory : directories) {
+    boost::system::error_code error;
+    fs::path root = fs::canonical(directory, error);
+    if (error || !fs::is_directory(root)) {
+      continue;
+    }
+    roots.push_back(root.string());
+    submitScan([this, root]() { scanDirectory(root.string()); });
+  }
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  scanned_.wait(lock, [this]() { return scanning_ == 0; });
+
+  // Forget files that disappeared from the scanned directories
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const std::string& path = it->first;
+    bool scanned = std::any_of(
+        roots.begin(), roots.end(), [&path](const std::string& root) {
+          return path.compare(0, root.size() + 1, root + "/") == 0;
+        });
+    if (scanned && seen_.count(path) == 0) {
+      it = entries_.erase(it);
+      stats_.removed++;
+    } else {
+      ++it;
+    }
+  }
+
+  return stats_;
+}
+
+void RomIndex::wait() { pool_.wait(); }
+
+bool RomIndex::save() {
+  wait();
+
+  std::string temporary = filename_ + ".tmp";
+  {
+    std::ofstream stream{temporary, std::ios::trunc};
+    if (!stream) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    stream << "geebee-index " << version_ << "\n";
+    for (const auto& item : entries_) {
+      const Entry& entry = item.second;
+      stream << entry.size << "\t" << entry.modified << "\t";
+      if (entry.hashed) {
+        stream << std::hex << entry.hash << std::dec;
+      } else {
+        stream << "-";
+      }
+      stream << "\t" << entry.header.type << "\t" << entry.header.rom_size
+             << "\t" << entry.header.ram_size << "\t" << entry.mbc << "\t"
+             << entry.header.checksum_valid << "\t"
+             << printable(entry.header.title) << "\t" << entry.path << "\n";
+    }
+    if (!stream) {
+      return false;
+    }
+  }
+
+  boost::system::error_code error;
+  fs::rename(temporary, filename_, error);
+  return !error;
+}
+
+std::size_t RomIndex::size() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return entries_.size();
+}
+
+std::vector<RomIndex::Entry> RomIndex::entries() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  std::vector<Entry> result;
+  for (const auto& item : entries_) {
+    result.push_back(item.second);
+  }
+  return result;
+}
+
+bool RomIndex::find(const std::string& path, Entry& entry) const {
+  boost::system::error_code error;
+  fs::path canonical = fs::canonical(path, error);
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  auto it = entries_.find(error ? path : canonical.string());
+  if (it == entries_.end()) {
+    return false;
+  }
+  entry = it->second;
+  return true;
+}
+
+std::vector<RomIndex::Entry> RomIndex::findHash(uint64_t hash) const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  std::vector<Entry> result;
+  for (const auto& item : entries_) {
+    if (item.second.hashed && item.second.hash == hash) {
+      result.push_back(item.second);
+    }
+  }
+  return result;
+}
+
+void RomIndex::load() {
+  std::ifstream stream{filename_};
+  std::string magic;
+  int version = 0;
+  if (!(stream >> magic >> version) || magic != "geebee-index" ||
+      version != version_) {
+    return;
+  }
+  stream.ignore(1);
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream fields{line};
+    Entry entry;
+    std::string hash;
+    fields >> entry.size >> entry.modified >> hash >> entry.header.type >>
+        entry.header.rom_size >> entry.header.ram_size >> entry.mbc >>
+        entry.header.checksum_valid;
+    fields.ignore(1);
+    std::getline(fields, entry.header.title, '\t');
+    std::getline(fields, entry.path);
+    if (!fields || entry.path.empty()) {
+      continue;
+    }
+    if (hash != "-") {
+      entry.hash = std::stoull(hash, nullptr, 16);
+      entry.hashed = true;
+    }
+    entries_[entry.path] = entry;
+  }
+}
+
+void RomIndex::scanDirectory(const std::string& directory) {
+  boost::system::error_code error;
+  for (fs::directory_iterator it{directory, error}, end; !error && it != end;
+       it.increment(error)) {
+    const fs::path& path = it->path();
+    fs::file_status status = it->status(error);
+    if (error) {
+      error.clear();
+      continue;
+    }
+
+    if (fs::is_directory(status)) {
+      // Linked directories are left out, as a link to a parent would have
+      // the scan go round forever
+      if (fs::is_symlink(it->symlink_status(error)) || error) {
+        error.clear();
+        continue;
+      }
+      std::string subdirectory = path.string();
+      submitScan([this, subdirectory]() { scanDirectory(subdirectory); });
+    } else if (fs::is_regular_file(status) && isRom(path)) {
+      uintmax_t size = fs::file_size(path, error);
+      std::time_t modified = fs::last_write_time(path, error);
+      if (error) {
+        error.clear();
+        continue;
+      }
+
+      std::string file = path.string();
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+        seen_.insert(file);
+        auto entry = entries_.find(file);
+        if (entry != entries_.end() && entry->second.size == size &&
+            entry->second.modified == modified) {
+          stats_.unchanged++;
+          continue;
+        }
+      }
+      submitScan(
+          [this, file, size, modified]() { indexFile(file, size, modified); });
+    }
+  }
+}
+
+void RomIndex::indexFile(const std::string& path, uintmax_t size,
+                         std::time_t modified) {
+  Byte header[Program::header_end];
+  ssize_t read = -1;
+  int file = ::open(path.c_str(), O_RDONLY);
+  if (file >= 0) {
+    read = ::pread(file, header, sizeof(header), 0);
+    ::close(file);
+  }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (read != static_cast<ssize_t>(sizeof(header))) {
+    entries_.erase(path);
+    stats_.invalid++;
+    return;
+  }
+
+  Entry entry;
+  entry.path = path;
+  entry.size = size;
+  entry.modified = modified;
+  entry.header = Program::parseHeader(header);
+  entry.mbc = MBC::controller(entry.header.type);
+  entries_[path] = entry;
+  stats_.indexed++;
+
+  pool_.submit([this, path]() { hashFile(path); });
+}
+
+void RomIndex::hashFile(const std::string& path) {
+  Rom rom{path};
+  uint64_t hash = hash::bytes(rom.data(), rom.size());
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  auto entry = entries_.find(path);
+  if (entry != entries_.end() && entry->second.size == rom.size()) {
+    entry->second.hash = hash;
+    entry->second.hashed = true;
+  }
+}
+
+void RomIndex::submitScan(ThreadPool::Task task) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    scanning_++;
+  }
+  pool_.submit([this, task]() {
+    task();
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (--scanning_ == 0) {
+      scanned_.notify_all();
+    }
+  });
+}
+
+}  // namespace gb
@@ -0,0 +1,86 @@
+#ifndef GEEBEE_SRC_ROMINDEX_H
+#define GEEBEE_SRC_ROMINDEX_H
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Program.h"
+#include "ThreadPool.h"
+
+namespace gb {
+
+// Persistent catalogue of a ROM collection. Directories are walked in
+// parallel and only the header page of every ROM is read. Whole-file hashes
+// are computed in the background afterwards. Files whose size and
+// modification time did not change since the last scan are skipped.
+class RomIndex {
+ public:
+  struct Entry {
+    std::string path;
+    uintmax_t size{0};
+    std::time_t modified{0};
+    Program::Header header;
+    // As chosen by MBC::controller, -1 for unsupported cartridges
+    int mbc{-1};
+    uint64_t hash{0};
+    bool hashed{false};
+  };
+
+  struct Stats {
+    std::size_t indexed{0};
+    std::size_t unchanged{0};
+    std::size_t removed{0};
+    std::size_t invalid{0};
+  };
+
+  // Loads the index stored in `filename`, if there is one.
+  explicit RomIndex(const std::string& filename, int threads = 0);
+  RomIndex(const RomIndex& index) = delete;
+  RomIndex(RomIndex&& index) = delete;
+  ~RomIndex();
+  RomIndex& operator=(const RomIndex& index) = delete;
+  RomIndex& operator=(const RomIndex&& index) = delete;
+
+  // Returns as soon as all headers are indexed, hashing goes on until wait().
+  Stats scan(const std::vector<std::string>& directories);
+  void wait();
+  // Waits for the hashes and replaces the index file.
+  bool save();
+
+  std::size_t size() const;
+  std::vector<Entry> entries() const;
+  bool find(const std::string& path, Entry& entry) const;
+  std::vector<Entry> findHash(uint64_t hash) const;
+
+ private:
+  static const int version_;
+
+  void load();
+  void scanDirectory(const std::string& directory);
+  void indexFile(const std::string& path, uintmax_t size,
+                 std::time_t modified);
+  void hashFile(const std::string& path);
+  void submitScan(ThreadPool::Task task);
+
+  std::string filename_;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Entry> entries_;
+  std::set<std::string> seen_;
+  Stats stats_;
+
+  int scanning_{0};
+  std::condition_variable scanned_;
+
+  ThreadPool pool_;
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,55 @@
+#include "RunAhead.h"
+
+namespace gb {
+
+RunAhead::RunAhead(CPU& cpu, int frames) : cpu_(cpu), frames_(frames) {}
+
+void RunAhead::cycle() {
+  Clock::time_point start = Clock::now();
+
+  if (frames_ <= 0) {
+    cpu_.cycle();
+    frame_time_ += Clock::now() - start;
+    host_frames_++;
+    return;
+  }
+
+  // The real frame is never shown, only the last predicted one is.
+  cpu_.setRendering(false);
+  cpu_.cycle();
+  Clock::time_point ahead = Clock::now();
+
+  // Only the real frame is heard
+  cpu_.save(state_);
+  cpu_.apu().setSynthesis(false);
+  for (int i = 0; i < frames_; i++) {
+    cpu_.setRendering(i == frames_ - 1);
+    cpu_.cycle();
+  }
+  cpu_.load(state_);
+  cpu_.apu().setSynthesis(true);
+  cpu_.setRendering(true);
+
+  Clock::time_point end = Clock::now();
+  frame_time_ += ahead - start;
+  ahead_time_ += end - ahead;
+  host_frames_++;
+}
+
+double RunAhead::frameCost() const {
+  if (host_frames_ == 0) {
+    return 0.0;
+  }
+  std::chrono::duration<double, std::micro> time = frame_time_;
+  return time.count() / host_frames_;
+}
+
+double RunAhead::aheadCost() const {
+  if (host_frames_ == 0 || frames_ <= 0) {
+    return 0.0;
+  }
+  std::chrono::duration<double, std::micro> time = ahead_time_;
+  return time.count() / (host_frames_ * frames_);
+}
+
+}  // namespace gb
@@ -0,0 +1,40 @@
+#ifndef GEEBEE_SRC_RUNAHEAD_H
+#define GEEBEE_SRC_RUNAHEAD_H
+
+#include <chrono>
+
+#include "CPU.h"
+
+namespace gb {
+
+// Hides the input lag of games that poll the joypad once per frame. Every
+// host frame advances the machine by one frame, then emulates `frames` more
+// frames with the current input, shows the last of them and rolls back.
+class RunAhead {
+ public:
+  RunAhead(CPU& cpu, int frames);
+  ~RunAhead() = default;
+
+  int frames() const { return frames_; }
+  void cycle();
+
+  // Average host time of a plain emulated frame and the extra time every
+  // run-ahead frame adds on top of it, both in microseconds.
+  double frameCost() const;
+  double aheadCost() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  CPU& cpu_;
+  int frames_{0};
+  CPU::State state_;
+
+  long host_frames_{0};
+  Clock::duration frame_time_{0};
+  Clock::duration ahead_time_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,93 @@
+#include "SDLAudio.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <SDL.h>
+
+#include "APU.h"
+
+namespace gb {
+
+namespace {
+
+// The most the sample rate gets stretched or squeezed, small enough for the
+// pitch change to be inaudible
+const double max_adjustment = 0.005;
+
+const std::size_t device_frames = 1024;
+
+}  // namespace
+
+SDLAudio::SDLAudio(int sample_rate)
+    : ring_(sample_rate / 4), scratch_(sample_rate / 4 * 2) {
+  SDL_AudioSpec desired{};
+  desired.freq = sample_rate;
+  desired.format = AUDIO_S16SYS;
+  desired.channels = 2;
+  desired.samples = device_frames;
+  desired.callback = &SDLAudio::callback;
+  desired.userdata = this;
+
+  SDL_AudioSpec obtained{};
+  device_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, 0);
+  if (device_ == 0) {
+    return;
+  }
+
+  sample_rate_ = obtained.freq;
+  // One device buffer being played plus one video frame being produced
+  target_ = obtained.samples + sample_rate_ / 60;
+  SDL_PauseAudioDevice(device_, 0);
+}
+
+SDLAudio::~SDLAudio() {
+  if (device_ != 0) {
+    SDL_CloseAudioDevice(device_);
+  }
+}
+
+void SDLAudio::queue(APU& apu) {
+  std::size_t frames =
+      apu.readSamples(scratch_.data(), scratch_.size() / 2);
+  ring_.write(scratch_.data(), frames);
+
+  // Produce a little more when the ring runs low and a little less when it
+  // fills up
+  double fill = static_cast<double>(ring_.size());
+  double error = (static_cast<double>(target_) - fill) / target_;
+  error = std::max(-1.0, std::min(error, 1.0));
+  apu.tuneSampleRate(sample_rate_ * (1.0 + error * max_adjustment));
+}
+
+void SDLAudio::sync() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  // The timeout covers a notification that slipped past before waiting
+  while (ring_.size() > target_) {
+    played_.wait_for(lock, std::chrono::milliseconds(2));
+  }
+}
+
+void SDLAudio::callback(void* audio, uint8_t* stream, int length) {
+  static_cast<SDLAudio*>(audio)->play(reinterpret_cast<int16_t*>(stream),
+                                      length / (2 * sizeof(int16_t)));
+}
+
+void SDLAudio::play(int16_t* samples, std::size_t frames) {
+  std::size_t read = ring_.read(samples, frames);
+  if (read > 0) {
+    last_[0] = samples[read * 2 - 2];
+    last_[1] = samples[read * 2 - 1];
+  }
+  // Hold the last sample rather than clicking back to zero
+  if (read < frames) {
+    underruns_++;
+    for (std::size_t i = read; i < frames; i++) {
+      samples[i * 2] = last_[0];
+      samples[i * 2 + 1] = last_[1];
+    }
+  }
+  played_.notify_one();
+}
+
+}  // namespace gb
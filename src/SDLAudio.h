@@ -0,0 +1,61 @@
+#ifndef GEEBEE_SRC_SDLAUDIO_H
+#define GEEBEE_SRC_SDLAUDIO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "AudioRing.h"
+#include "types.h"
+
+namespace gb {
+
+class APU;
+
+// Plays APU samples on the default output device. The device pulls samples
+// from a lock-free ring in its own callback, and the emulation is slaved to
+// that: sync() waits for the device to drain the ring, while queue() nudges
+// the APU's sample rate by a fraction of a percent to hold the ring at its
+// target fill, so it neither underruns nor grows latency.
+class SDLAudio {
+ public:
+  // Opens the device, leaving the SDLAudio closed if that fails.
+  explicit SDLAudio(int sample_rate = 48000);
+  SDLAudio(const SDLAudio& audio) = delete;
+  SDLAudio(SDLAudio&& audio) = delete;
+  ~SDLAudio();
+  SDLAudio& operator=(const SDLAudio& audio) = delete;
+  SDLAudio& operator=(const SDLAudio&& audio) = delete;
+
+  bool is_open() const { return device_ != 0; }
+  int sampleRate() const { return sample_rate_; }
+
+  // Moves the APU's finished samples into the ring and retunes its rate.
+  void queue(APU& apu);
+  // Blocks until the device has played the ring down to its target fill.
+  void sync();
+
+  // Callbacks that found fewer samples than they had to play.
+  std::size_t underruns() const { return underruns_; }
+
+ private:
+  static void callback(void* audio, uint8_t* stream, int length);
+  void play(int16_t* samples, std::size_t frames);
+
+  uint32_t device_{0};
+  int sample_rate_{0};
+  std::size_t target_{0};
+
+  AudioRing ring_;
+  std::vector<int16_t> scratch_;
+  int16_t last_[2]{0, 0};
+  std::atomic<std::size_t> underruns_{0};
+
+  std::mutex mutex_;
+  std::condition_variable played_;
+};
+
+}  // namespace gb
+
+#endif
@@ -5,8 +5,8 @@
 namespace gb {
 
 SDLManager::SDLManager() {
-  SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER |
-           SDL_INIT_EVENTS);
+  SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER |
+           SDL_INIT_GAMECONTROLLER | SDL_INIT_EVENTS);
 }
 
 SDLManager::~SDLManager() { SDL_Quit(); }
@@ -1,11 +1,11 @@
 #include "SDLWindow.h"
 
 #include <iostream>
-#include <functional>
 
 #include <SDL.h>
 
 #include "Joypad.h"
+#include "Timeline.h"
 
 namespace gb {
 
@@ -28,10 +28,13 @@ SDLWindow::SDLWindow(const std::string& title)
                SDL_MapRGBA(surface_->format, 255, 255, 255, 255));
 }
 
-void SDLWindow::setPixel(int x, int y, int color) {
+void SDLWindow::setFrame(const Byte* pixels) {
   auto format = surface_->format;
-  auto pixels = reinterpret_cast<uint32_t*>(surface_->pixels);
-  pixels[y * 160 + x] = SDL_MapRGBA(format, color, color, color, 255);
+  auto surface = reinterpret_cast<uint32_t*>(surface_->pixels);
+  for (int i = 0; i < width * height; i++) {
+    Byte color = pixels[i];
+    surface[i] = SDL_MapRGBA(format, color, color, color, 255);
+  }
 }
 
 bool SDLWindow::handleEvents(Joypad& joypad) {
@@ -48,41 +51,37 @@ bool SDLWindow::handleEvents(Joypad& joypad) {
     }
 
     if (e.type == SDL_KEYUP || e.type == SDL_KEYDOWN) {
-      std::function<void(Joypad::Key)> key;
-      if (e.type == SDL_KEYDOWN) {
-        key = std::bind(&Joypad::press, &joypad, std::placeholders::_1);
-      } else {  // (e.type == SDL_KEYUP)
-        key = std::bind(&Joypad::release, &joypad, std::placeholders::_1);
-      }
+      void (Joypad::*key)(Joypad::Key) =
+          e.type == SDL_KEYDOWN ? &Joypad::press : &Joypad::release;
 
       switch (e.key.keysym.scancode) {
         case SDL_SCANCODE_W:
         case SDL_SCANCODE_UP:
-          key(Joypad::Key::Up);
+          (joypad.*key)(Joypad::Key::Up);
           break;
         case SDL_SCANCODE_A:
         case SDL_SCANCODE_LEFT:
-          key(Joypad::Key::Left);
+          (joypad.*key)(Joypad::Key::Left);
           break;
         case SDL_SCANCODE_D:
         case SDL_SCANCODE_RIGHT:
-          key(Joypad::Key::Right);
+          (joypad.*key)(Joypad::Key::Right);
           break;
         case SDL_SCANCODE_S:
         case SDL_SCANCODE_DOWN:
-          key(Joypad::Key::Down);
+          (joypad.*key)(Joypad::Key::Down);
           break;
         case SDL_SCANCODE_RETURN:
-          key(Joypad::Key::Start);
+          (joypad.*key)(Joypad::Key::Start);
           break;
         case SDL_SCANCODE_SPACE:
-          key(Joypad::Key::Select);
+          (joypad.*key)(Joypad::Key::Select);
           break;
         case SDL_SCANCODE_N:
-          key(Joypad::Key::B);
+          (joypad.*key)(Joypad::Key::B);
           break;
         case SDL_SCANCODE_M:
-          key(Joypad::Key::A);
+          (joypad.*key)(Joypad::Key::A);
           break;
         default:
           break;
@@ -94,17 +93,21 @@ bool SDLWindow::handleEvents(Joypad& joypad) {
 }
 
 void SDLWindow::draw() {
-  SDL_UpdateTexture(texture_.get(), NULL, surface_->pixels, surface_->pitch);
-  if (SDL_RenderClear(renderer_.get())) {
-    return;
-  }
-  if (SDL_RenderCopy(renderer_.get(), texture_.get(), &position_, NULL)) {
-    return;
+  {
+    Timeline::Scope scope{Timeline::Present};
+    SDL_UpdateTexture(texture_.get(), NULL, surface_->pixels,
+                      surface_->pitch);
+    if (SDL_RenderClear(renderer_.get())) {
+      return;
+    }
+    if (SDL_RenderCopy(renderer_.get(), texture_.get(), &position_, NULL)) {
+      return;
+    }
+    SDL_RenderPresent(renderer_.get());
   }
-  SDL_RenderPresent(renderer_.get());
 
   uint32_t ticks = SDL_GetTicks() - timer_;
-  if (ticks < ticks_per_frame_) {
+  if (pacing_ && ticks < ticks_per_frame_) {
     SDL_Delay(ticks_per_frame_ - ticks);
   }
 }
@@ -23,10 +23,13 @@ class SDLWindow : public Window {
   explicit SDLWindow(const std::string& title = "GeeBee");
   ~SDLWindow() override = default;
 
-  void setPixel(int x, int y, int color) override;
+  void setFrame(const Byte* pixels) override;
 
   bool handleEvents(Joypad& joypad);
+  // Waits out the rest of the frame's 60Hz tick unless pacing is off,
+  // which it is when the sound card paces the emulation instead.
   void draw();
+  void setPacing(bool pacing) { pacing_ = pacing; }
 
  private:
   static const int frames_per_second_;
@@ -39,6 +42,7 @@ class SDLWindow : public Window {
 
   SDL_Rect position_;
   uint32_t timer_{0};
+  bool pacing_{true};
 };
 }  // namespace gb
 
@@ -0,0 +1,113 @@
+#include "SaveFile.h"
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace fs = boost::filesystem;
+namespace ipc = boost::interprocess;
+
+namespace gb {
+
+const std::size_t SaveFile::page_size;
+
+struct SaveFile::Mapping {
+  ipc::mapped_region region;
+};
+
+SaveFile::SaveFile(const std::string& filename, std::size_t size,
+                   std::chrono::milliseconds period)
+    : size_(size), period_(period) {
+  boost::system::error_code error;
+  if (!fs::exists(filename, error)) {
+    std::ofstream create{filename, std::ios::binary};
+  }
+  if (fs::file_size(filename, error) < size && !error) {
+    fs::resize_file(filename, size, error);
+  }
+  if (error || size == 0) {
+    return;
+  }
+
+  try {
+    ipc::file_mapping file{filename.c_str(), ipc::read_write};
+    mapping_.reset(new Mapping{ipc::mapped_region{file, ipc::read_write, 0,
+                                                  size}});
+  } catch (const ipc::interprocess_exception&) {
+    return;
+  }
+  data_ = static_cast<Byte*>(mapping_->region.get_address());
+
+  std::size_t pages = (size + page_size - 1) / page_size;
+  dirty_words_ = (pages + 63) / 64;
+  dirty_.reset(new std::atomic<uint64_t>[dirty_words_]);
+  for (std::size_t i = 0; i < dirty_words_; i++) {
+    dirty_[i] = 0;
+  }
+
+  thread_ = std::thread{&SaveFile::run, this};
+}
+
+SaveFile::~SaveFile() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+  flush();
+}
+
+void SaveFile::requestFlush() {
+  requested_ = true;
+  wake_.notify_one();
+}
+
+void SaveFile::flush() {
+  std::lock_guard<std::mutex> lock{flush_mutex_};
+
+  // Sync runs of consecutive dirty pages with one call each
+  std::size_t pages = (size_ + page_size - 1) / page_size;
+  std::size_t first = pages;
+  for (std::size_t word = 0; word < dirty_words_; word++) {
+    uint64_t bits = dirty_[word].exchange(0, std::memory_order_relaxed);
+    for (std::size_t bit = 0; bit < 64; bit++) {
+      std::size_t page = word * 64 + bit;
+      bool dirty = (bits >> bit) & 1;
+      if (dirty && first == pages) {
+        first = page;
+      }
+      if ((!dirty || page + 1 >= pages) && first != pages) {
+        std::size_t last = dirty ? page + 1 : page;
+        std::size_t offset = first * page_size;
+        std::size_t length = std::min(last * page_size, size_) - offset;
+        mapping_->region.flush(offset, length, false);
+        flushed_pages_ += last - first;
+        first = pages;
+      }
+      if (page + 1 >= pages) {
+        break;
+      }
+    }
+  }
+}
+
+void SaveFile::run() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (!stopping_) {
+    wake_.wait_for(lock, period_,
+                   [this]() { return stopping_ || requested_; });
+    requested_ = false;
+
+    lock.unlock();
+    flush();
+    lock.lock();
+  }
+}
+
+}  // namespace gb
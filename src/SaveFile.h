@@ -0,0 +1,83 @@
+#ifndef GEEBEE_SRC_SAVEFILE_H
+#define GEEBEE_SRC_SAVEFILE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "types.h"
+
+namespace gb {
+
+// Battery backed cartridge RAM living in a shared mapping of a .sav file.
+// The emulation thread writes straight into the mapping and marks 256 byte
+// pages dirty; a background thread syncs only the dirty pages to disk when
+// asked to, periodically and on destruction. Opening never reads the file.
+class SaveFile {
+ public:
+  static const std::size_t page_size = 0x100;
+
+  // Creates or extends the file to `size` bytes. Leaves the SaveFile invalid
+  // if the file can't be mapped.
+  SaveFile(const std::string& filename, std::size_t size,
+           std::chrono::milliseconds period = std::chrono::seconds(1));
+  SaveFile(const SaveFile& file) = delete;
+  SaveFile(SaveFile&& file) = delete;
+  ~SaveFile();
+  SaveFile& operator=(const SaveFile& file) = delete;
+  SaveFile& operator=(const SaveFile&& file) = delete;
+
+  bool is_valid() const { return data_ != nullptr; }
+  std::size_t size() const { return size_; }
+  const Byte* data() const { return data_; }
+
+  Byte read(std::size_t offset) const { return data_[offset]; }
+  void write(std::size_t offset, Byte byte) {
+    data_[offset] = byte;
+    markDirty(offset);
+  }
+  void markDirty(std::size_t offset) {
+    std::size_t page = offset / page_size;
+    uint64_t bit = uint64_t{1} << (page % 64);
+    std::atomic<uint64_t>& word = dirty_[page / 64];
+    if (!(word.load(std::memory_order_relaxed) & bit)) {
+      word.fetch_or(bit, std::memory_order_relaxed);
+    }
+  }
+
+  // Wakes the background thread without waiting for it.
+  void requestFlush();
+  // Syncs all dirty pages on the calling thread.
+  void flush();
+  // Number of pages synced so far.
+  std::size_t flushedPages() const { return flushed_pages_; }
+
+ private:
+  struct Mapping;
+
+  void run();
+
+  std::unique_ptr<Mapping> mapping_;
+  Byte* data_{nullptr};
+  std::size_t size_{0};
+
+  std::unique_ptr<std::atomic<uint64_t>[]> dirty_;
+  std::size_t dirty_words_{0};
+  std::atomic<std::size_t> flushed_pages_{0};
+
+  std::chrono::milliseconds period_;
+  std::mutex mutex_;
+  std::mutex flush_mutex_;
+  std::condition_variable wake_;
+  std::atomic<bool> requested_{false};
+  bool stopping_{false};
+  std::thread thread_;
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,25 @@
+#include "SharedBytes.h"
+
+#include <algorithm>
+
+namespace gb {
+
+void SharedBytes::assign(std::size_t size, Byte value) {
+  buffer_ = std::make_shared<Bytes>(size, value);
+  data_ = buffer_->data();
+  size_ = size;
+}
+
+bool SharedBytes::operator==(const SharedBytes& other) const {
+  if (data_ == other.data_) {
+    return size_ == other.size_;
+  }
+  return size_ == other.size_ && std::equal(data_, data_ + size_, other.data_);
+}
+
+void SharedBytes::copyBuffer() {
+  buffer_ = std::make_shared<Bytes>(*buffer_);
+  data_ = buffer_->data();
+}
+
+}  // namespace gb
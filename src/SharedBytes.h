@@ -0,0 +1,59 @@
+#ifndef GEEBEE_SRC_SHAREDBYTES_H
+#define GEEBEE_SRC_SHAREDBYTES_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "types.h"
+
+namespace gb {
+
+// A fixed size byte buffer that copies share until one of them writes to it.
+// Copies may be used from different threads: the first write on either side
+// gives that side its own buffer, the other one keeps the original.
+class SharedBytes {
+ public:
+  SharedBytes() = default;
+  ~SharedBytes() = default;
+
+  void assign(std::size_t size, Byte value);
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool shared() const { return buffer_.use_count() > 1; }
+
+  const Byte* data() const { return data_; }
+  Byte* mutableData() {
+    detach();
+    return data_;
+  }
+
+  Byte operator[](std::size_t index) const { return data_[index]; }
+  void set(std::size_t index, Byte byte) {
+    detach();
+    data_[index] = byte;
+  }
+
+  bool operator==(const SharedBytes& other) const;
+  bool operator!=(const SharedBytes& other) const { return !(*this == other); }
+
+ private:
+  void detach() {
+    if (buffer_.use_count() > 1) {
+      copyBuffer();
+    }
+    // Pairs with the release of the last other owner, so its reads of the
+    // buffer happen before our writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  void copyBuffer();
+
+  std::shared_ptr<Bytes> buffer_;
+  Byte* data_{nullptr};
+  std::size_t size_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,138 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gb {
+
+namespace {
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+
+// Keeps the calling thread on the `index`th core, wrapping around if there
+// are fewer
+void pinToCore(int index) {
+#if defined(__linux__)
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(index % cores, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)index;
+#endif
+}
+}  // namespace
+
+ThreadPool::ThreadPool(int threads, bool pin) : pin_(pin) {
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (int i = 0; i < threads; i++) {
+    workers_.emplace_back(new Worker);
+  }
+  for (int i = 0; i < threads; i++) {
+    workers_[i]->thread = std::thread{&ThreadPool::work, this, i};
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stopping_ = true;
+  }
+  wake_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+int ThreadPool::currentWorker() const {
+  return current_pool == this ? current_worker : -1;
+}
+
+void ThreadPool::submit(Task task) {
+  int index = currentWorker();
+  if (index < 0) {
+    index = next_++ % workers_.size();
+  }
+
+  pending_++;
+  {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock{worker.mutex};
+    worker.tasks.push_back(std::move(task));
+  }
+  queued_++;
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+  }
+  wake_.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  idle_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void ThreadPool::work(int index) {
+  current_pool = this;
+  current_worker = index;
+  if (pin_) {
+    pinToCore(index);
+  }
+
+  while (true) {
+    Task task;
+    if (pop(index, task) || steal(index, task)) {
+      queued_--;
+      task();
+      if (--pending_ == 0) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        idle_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{mutex_};
+    wake_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+    if (stopping_ && queued_ == 0) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::pop(int index, Task& task) {
+  Worker& worker = *workers_[index];
+  std::lock_guard<std::mutex> lock{worker.mutex};
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::steal(int index, Task& task) {
+  int size = static_cast<int>(workers_.size());
+  for (int i = 1; i < size; i++) {
+    Worker& victim = *workers_[(index + i) % size];
+    std::lock_guard<std::mutex> lock{victim.mutex};
+    if (victim.tasks.empty()) {
+      continue;
+    }
+    task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+}  // namespace gb
@@ -0,0 +1,66 @@
+#ifndef GEEBEE_SRC_THREADPOOL_H
+#define GEEBEE_SRC_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gb {
+
+// Fixed set of worker threads with one task queue each. Tasks submitted from
+// a worker go to its own queue and run newest first; idle workers steal the
+// oldest tasks of the others.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  // Uses one worker per hardware thread if `threads` is not positive. Pinned
+  // workers each stay on one core, where supported.
+  explicit ThreadPool(int threads = 0, bool pin = false);
+  ThreadPool(const ThreadPool& pool) = delete;
+  ThreadPool(ThreadPool&& pool) = delete;
+  ~ThreadPool();
+  ThreadPool& operator=(const ThreadPool& pool) = delete;
+  ThreadPool& operator=(const ThreadPool&& pool) = delete;
+
+  int size() const { return static_cast<int>(workers_.size()); }
+  // Index of the worker running the calling thread, -1 outside the pool.
+  int currentWorker() const;
+
+  void submit(Task task);
+  // Blocks until every submitted task, including the ones submitted by
+  // other tasks, has finished.
+  void wait();
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+  };
+
+  void work(int index);
+  bool pop(int index, Task& task);
+  bool steal(int index, Task& task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  bool pin_{false};
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+  bool stopping_{false};
+
+  std::atomic<int> queued_{0};
+  std::atomic<int> pending_{0};
+  std::atomic<unsigned> next_{0};
+};
+
+}  // namespace gb
+
+#endif
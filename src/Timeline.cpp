@@ -0,0 +1,147 @@
+#include "Timeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace gb {
+
+namespace {
+
+// Hardware frames last 70224 of 4194304 clocks
+const double frame_seconds = 70224.0 / 4194304.0;
+
+uint64_t nanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int threadId() {
+  static std::atomic<int> next{1};
+  thread_local int id = next++;
+  return id;
+}
+
+// Counters of the calling thread at its previous span
+std::array<uint64_t, Timeline::counters>& lastTotals() {
+  thread_local std::array<uint64_t, Timeline::counters> last{};
+  return last;
+}
+
+}  // namespace
+
+Timeline& Timeline::global() {
+  static Timeline timeline;
+  return timeline;
+}
+
+const char* Timeline::name(Counter counter) {
+  switch (counter) {
+    case Dispatch:
+      return "dispatch";
+    case MemoryIO:
+      return "memory_io";
+    case DrawLine:
+      return "draw_line";
+    case Timer:
+      return "timer";
+    case Present:
+      return "present";
+    case counters:
+      break;
+  }
+  return "";
+}
+
+uint64_t Timeline::ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return nanoseconds();
+#endif
+}
+
+std::array<uint64_t, Timeline::counters>& Timeline::totals() {
+  thread_local std::array<uint64_t, counters> totals{};
+  return totals;
+}
+
+void Timeline::start() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  spans_.clear();
+  start_ticks_ = ticks();
+  start_nanoseconds_ = nanoseconds();
+  recording_ = true;
+}
+
+void Timeline::span(const char* name, uint64_t begin) {
+  Span span{name, threadId(), begin, ticks(), totals()};
+  std::array<uint64_t, counters>& last = lastTotals();
+  for (int i = 0; i < counters; i++) {
+    span.spent[i] -= last[i];
+  }
+  last = totals();
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  spans_.push_back(span);
+}
+
+std::size_t Timeline::size() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return spans_.size();
+}
+
+bool Timeline::writeChromeTrace(const std::string& filename) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  // Calibrate the counter against the clock over the whole recording
+  double elapsed = static_cast<double>(nanoseconds() - start_nanoseconds_);
+  double ticks_per_us =
+      elapsed > 0 ? (ticks() - start_ticks_) / (elapsed / 1000.0) : 1.0;
+  auto us = [this, ticks_per_us](uint64_t ticks) {
+    return (static_cast<double>(ticks) -
+            static_cast<double>(start_ticks_)) /
+           ticks_per_us;
+  };
+
+  std::ofstream out{filename};
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  for (const Span& span : spans_) {
+    double begin = us(span.begin);
+    double duration = (span.end - span.begin) / ticks_per_us;
+    out << (first ? "" : ",\n") << "{\"name\":\"" << span.name
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+        << ",\"ts\":" << begin << ",\"dur\":" << duration << ",\"args\":{";
+    for (int i = 0; i < counters; i++) {
+      out << (i ? "," : "") << "\"" << name(static_cast<Counter>(i))
+          << "_us\":" << span.spent[i] / ticks_per_us;
+    }
+    out << "}}";
+    first = false;
+
+    // Per thread counter tracks show how each frame splits up
+    out << ",\n{\"name\":\"" << span.name << " thread " << span.thread
+        << "\",\"ph\":\"C\",\"pid\":1,\"tid\":" << span.thread
+        << ",\"ts\":" << begin << ",\"args\":{";
+    for (int i = 0; i < counters; i++) {
+      out << (i ? "," : "") << "\"" << name(static_cast<Counter>(i))
+          << "\":" << span.spent[i] / ticks_per_us;
+    }
+    out << "}}";
+
+    if (duration > frame_seconds * 1e6) {
+      out << ",\n{\"name\":\"long " << span.name
+          << "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":" << span.thread
+          << ",\"ts\":" << begin << "}";
+    }
+  }
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+
+}  // namespace gb
@@ -0,0 +1,94 @@
+#ifndef GEEBEE_SRC_TIMELINE_H
+#define GEEBEE_SRC_TIMELINE_H
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace gb {
+
+// Host time spent in the emulator's hot paths, split per frame. Scopes add
+// their time stamp counter ticks to counters of the calling thread, and
+// every finished frame or presentation becomes a span carrying the counters
+// it accumulated. The spans of all threads export as a Chrome trace.
+//
+// Only builds configured with GEEBEE_PERF measure anything; elsewhere
+// scopes are empty and compile away.
+class Timeline {
+ public:
+  enum Counter { Dispatch, MemoryIO, DrawLine, Timer, Present, counters };
+
+#ifdef GEEBEE_PERF
+  static const bool compiled = true;
+
+  // Scopes nest, so each counter includes the time of the ones inside it
+  class Scope {
+   public:
+    explicit Scope(Counter counter) : counter_(counter), begin_(ticks()) {}
+    Scope(const Scope& scope) = delete;
+    Scope(Scope&& scope) = delete;
+    ~Scope() { totals()[counter_] += ticks() - begin_; }
+    Scope& operator=(const Scope& scope) = delete;
+    Scope& operator=(const Scope&& scope) = delete;
+
+   private:
+    Counter counter_;
+    uint64_t begin_;
+  };
+#else
+  static const bool compiled = false;
+
+  class Scope {
+   public:
+    explicit Scope(Counter /*counter*/) {}
+  };
+#endif
+
+  static Timeline& global();
+  static const char* name(Counter counter);
+  // Time stamp counter, or nanoseconds where there is none.
+  static uint64_t ticks();
+
+  Timeline() = default;
+  Timeline(const Timeline& timeline) = delete;
+  Timeline(Timeline&& timeline) = delete;
+  ~Timeline() = default;
+  Timeline& operator=(const Timeline& timeline) = delete;
+  Timeline& operator=(const Timeline&& timeline) = delete;
+
+  // Starts collecting spans, dropping earlier ones.
+  void start();
+  bool recording() const { return recording_; }
+  // Adds a span of the calling thread from `begin` until now.
+  void span(const char* name, uint64_t begin);
+  std::size_t size();
+
+  // Writes all spans as Chrome trace JSON, for chrome://tracing or Perfetto.
+  // Frames longer than a frame of the real hardware are marked.
+  bool writeChromeTrace(const std::string& filename);
+
+ private:
+  struct Span {
+    const char* name;
+    int thread;
+    uint64_t begin;
+    uint64_t end;
+    std::array<uint64_t, counters> spent;
+  };
+
+  static std::array<uint64_t, counters>& totals();
+
+  bool recording_{false};
+  uint64_t start_ticks_{0};
+  uint64_t start_nanoseconds_{0};
+
+  std::mutex mutex_;
+  std::vector<Span> spans_;
+};
+
+}  // namespace gb
+
+#endif
@@ -3,13 +3,15 @@
 #include <iostream>
 
 #include "Memory.h"
+#include "Timeline.h"
 #include "bits.h"
 
 namespace gb {
 
 const std::array<int, 4> Timer::clocks_{1024, 16, 64, 256};
 
-Timer::Timer(Memory& memory) : memory_(memory) {
+Timer::Timer(Memory& memory)
+    : memory_(memory), state_(memory.machine().timer) {
   memory_.registerHandler(this);
 }
 
@@ -18,10 +20,11 @@ Timer::~Timer() {
 }
 
 void Timer::advance(int timing) {
+  Timeline::Scope scope{Timeline::Timer};
   Byte control = memory_.read(Register::Control);
-  divider_ += timing;
-  while (divider_ >= clocks_[0]) {
-    divider_ -= clocks_[0];
+  state_.divider += timing;
+  while (state_.divider >= clocks_[0]) {
+    state_.divider -= clocks_[0];
     Byte divider = memory_.read(Register::Divider);
     divider++;
     memory_.io()[Register::Divider - 0xFF00] = divider;
@@ -31,10 +34,10 @@ void Timer::advance(int timing) {
     return;
   }
 
-  counter_ += timing;
+  state_.counter += timing;
   int current_clock = clocks_[control & 0x03];
-  while (counter_ >= current_clock) {
-    counter_ -= clocks_[control & 0x03];
+  while (state_.counter >= current_clock) {
+    state_.counter -= clocks_[control & 0x03];
     Byte counter = memory_.read(Register::Counter);
     counter++;
     if (counter == 0) {
@@ -4,6 +4,7 @@
 #include <array>
 
 #include "IOHandler.h"
+#include "MachineState.h"
 #include "types.h"
 
 namespace gb {
@@ -35,9 +36,7 @@ class Timer : public IOHandler {
   static const std::array<int, 4> clocks_;
 
   Memory& memory_;
-
-  int divider_{0};
-  int counter_{0};
+  MachineState::Timer& state_;
 };
 
 }  // namespace gb
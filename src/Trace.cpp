@@ -0,0 +1,92 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace gb {
+
+namespace {
+
+const char magic[4] = {'G', 'B', 'T', 'R'};
+const uint32_t version = 1;
+
+}  // namespace
+
+TraceRing::TraceRing(std::size_t records) { setCapacity(records); }
+
+void TraceRing::setCapacity(std::size_t records) {
+  std::size_t capacity = records ? 1 : 0;
+  while (capacity < records) {
+    capacity <<= 1;
+  }
+  records_.assign(capacity, TraceRecord{});
+  records_.shrink_to_fit();
+  mask_ = capacity ? capacity - 1 : 0;
+  recorded_ = 0;
+}
+
+std::size_t TraceRing::size() const {
+  return static_cast<std::size_t>(
+      std::min<uint64_t>(recorded_, records_.size()));
+}
+
+const TraceRecord& TraceRing::operator[](std::size_t index) const {
+  return records_[(recorded_ - size() + index) & mask_];
+}
+
+bool TraceRing::save(const std::string& filename) const {
+  std::ofstream stream{filename, std::ios::binary | std::ios::trunc};
+  uint32_t record_size = sizeof(TraceRecord);
+  uint64_t count = size();
+  stream.write(magic, sizeof(magic));
+  stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  stream.write(reinterpret_cast<const char*>(&record_size),
+               sizeof(record_size));
+  stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+  // At most two contiguous runs: the oldest records, then the wrapped ones
+  std::size_t first = static_cast<std::size_t>(
+      (recorded_ - count) & mask_);
+  std::size_t head = std::min<std::size_t>(count, records_.size() - first);
+  stream.write(reinterpret_cast<const char*>(records_.data() + first),
+               head * sizeof(TraceRecord));
+  stream.write(reinterpret_cast<const char*>(records_.data()),
+               (count - head) * sizeof(TraceRecord));
+  return static_cast<bool>(stream);
+}
+
+bool TraceRing::load(const std::string& filename,
+                     std::vector<TraceRecord>& records) {
+  std::ifstream stream{filename, std::ios::binary};
+  char file_magic[4];
+  uint32_t file_version = 0;
+  uint32_t record_size = 0;
+  uint64_t count = 0;
+  stream.read(file_magic, sizeof(file_magic));
+  stream.read(reinterpret_cast<char*>(&file_version), sizeof(file_version));
+  stream.read(reinterpret_cast<char*>(&record_size), sizeof(record_size));
+  stream.read(reinterpret_cast<char*>(&count), sizeof(count));
+  if (!stream || std::memcmp(file_magic, magic, sizeof(magic)) != 0 ||
+      file_version != version || record_size != sizeof(TraceRecord)) {
+    return false;
+  }
+
+  // The count comes from the file, it must not size anything bigger than
+  // the records that actually follow
+  std::streampos start = stream.tellg();
+  stream.seekg(0, std::ios::end);
+  std::streamoff remaining = stream.tellg() - start;
+  stream.seekg(start);
+  if (!stream || count > static_cast<uint64_t>(remaining) /
+                             sizeof(TraceRecord)) {
+    return false;
+  }
+
+  records.resize(count);
+  stream.read(reinterpret_cast<char*>(records.data()),
+              count * sizeof(TraceRecord));
+  return static_cast<bool>(stream);
+}
+
+}  // namespace gb
@@ -0,0 +1,94 @@
+#ifndef GEEBEE_SRC_TRACE_H
+#define GEEBEE_SRC_TRACE_H
+
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace gb {
+
+// One executed instruction and the registers right before it ran.
+struct TraceRecord {
+  uint64_t cycle;
+  Word pc;
+  // ROM bank mapped at pc, 0 outside of ROM
+  Word bank;
+  Word sp;
+  Byte opcode;
+  // The byte after the opcode, which selects CB prefixed instructions
+  Byte operand;
+  Byte a;
+  Byte f;
+  Byte b;
+  Byte c;
+  Byte d;
+  Byte e;
+  Byte h;
+  Byte l;
+};
+
+static_assert(sizeof(TraceRecord) == 24, "Trace records must stay packed");
+
+// Tracing policy of builds without GEEBEE_TRACE. Every call compiles away.
+class NullTracer {
+ public:
+  static const bool enabled = false;
+
+  bool active() const { return false; }
+  void setCapacity(std::size_t /*records*/) {}
+  void record(const TraceRecord& /*record*/) {}
+  bool save(const std::string& /*filename*/) const { return false; }
+  std::size_t footprint() const { return 0; }
+};
+
+// Flight recorder of the last executed instructions. Recording is a single
+// store into a power of two ring, without locks, allocation or formatting,
+// so whole runs can be traced. The ring belongs to the emulation thread.
+class TraceRing {
+ public:
+  static const bool enabled = true;
+
+  // Rounds `records` up to a power of two. 0 turns recording off.
+  explicit TraceRing(std::size_t records = 0);
+  TraceRing(const TraceRing& ring) = delete;
+  TraceRing(TraceRing&& ring) = delete;
+  ~TraceRing() = default;
+  TraceRing& operator=(const TraceRing& ring) = delete;
+  TraceRing& operator=(const TraceRing&& ring) = delete;
+
+  bool active() const { return !records_.empty(); }
+  // Drops everything recorded so far.
+  void setCapacity(std::size_t records);
+  std::size_t capacity() const { return records_.size(); }
+  // Bytes of records held
+  std::size_t footprint() const {
+    return records_.capacity() * sizeof(TraceRecord);
+  }
+  // Records currently held, at most capacity().
+  std::size_t size() const;
+  // Records ever recorded, including overwritten ones.
+  uint64_t recorded() const { return recorded_; }
+
+  // Only while active()
+  void record(const TraceRecord& record) {
+    records_[recorded_++ & mask_] = record;
+  }
+  // The held records, oldest first.
+  const TraceRecord& operator[](std::size_t index) const;
+
+  // Writes the held records, oldest first, in host byte order.
+  bool save(const std::string& filename) const;
+  // Reads a file written by save(). Returns false if it isn't a trace.
+  static bool load(const std::string& filename,
+                   std::vector<TraceRecord>& records);
+
+ private:
+  std::vector<TraceRecord> records_;
+  std::size_t mask_{0};
+  uint64_t recorded_{0};
+};
+
+}  // namespace gb
+
+#endif
@@ -0,0 +1,102 @@
+#include "VectorEnv.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "Program.h"
+
+namespace gb {
+
+VectorEnv::VectorEnv(std::shared_ptr<const Program> program, std::size_t size,
+                     std::vector<Word> ram_addresses, DoneCheck done,
+                     int threads)
+    : program_(std::move(program)),
+      ram_addresses_(std::move(ram_addresses)),
+      done_(std::move(done)),
+      errors_(size),
+      pool_(threads) {
+  machines_.reserve(size);
+  for (std::size_t i = 0; i < size; i++) {
+    machines_.emplace_back(new CPU{window_, *program_});
+  }
+  if (size > 0) {
+    machines_.front()->save(start_);
+  }
+}
+
+VectorEnv::~VectorEnv() { pool_.wait(); }
+
+void VectorEnv::reset() {
+  for (auto& machine : machines_) {
+    machine->load(start_);
+  }
+}
+
+void VectorEnv::stepBatch(const Byte* actions, int frames,
+                          const Observations& out) {
+  // One contiguous range of machines per worker keeps their output rows
+  // apart in memory.
+  std::size_t workers = static_cast<std::size_t>(pool_.size());
+  std::size_t chunk = (size() + workers - 1) / workers;
+  for (std::size_t begin = 0; begin < size(); begin += chunk) {
+    std::size_t end = std::min(begin + chunk, size());
+    pool_.submit([this, begin, end, actions, frames, &out]() {
+      stepRange(begin, end, actions, frames, out);
+    });
+  }
+  pool_.wait();
+}
+
+void VectorEnv::stepRange(std::size_t begin, std::size_t end,
+                          const Byte* actions, int frames,
+                          const Observations& out) {
+  std::size_t ram_size = ram_addresses_.size();
+  for (std::size_t i = begin; i < end; i++) {
+    CPU& cpu = *machines_[i];
+    cpu.joypad().set(actions ? actions[i] : 0);
+
+    bool done = false;
+    cpu.setRendering(false);
+    if (out.frames) {
+      cpu.lcd().setFramebuffer(out.frames + i * frame_size);
+    }
+    // A machine that fails, e.g. on an invalid opcode, ends its episode
+    // instead of taking down the process with every other machine
+    bool error = false;
+    try {
+      for (int frame = 0; frame < frames && !done; frame++) {
+        // An episode can end on any frame, and its last one has to be the
+        // observation, so with a done check every frame is drawn
+        if (out.frames && (done_ || frame == frames - 1)) {
+          cpu.setRendering(true);
+        }
+        cpu.cycle();
+        done = done_ && done_(cpu);
+      }
+    } catch (const std::exception& exception) {
+      errors_[i] = exception.what();
+      error = true;
+      done = true;
+    }
+    cpu.lcd().setFramebuffer(nullptr);
+    cpu.setRendering(true);
+
+    if (out.ram) {
+      Byte* row = out.ram + i * ram_size;
+      for (std::size_t j = 0; j < ram_size; j++) {
+        row[j] = cpu.memory().peek(ram_addresses_[j]);
+      }
+    }
+    if (out.done) {
+      out.done[i] = done;
+    }
+    if (out.error) {
+      out.error[i] = error;
+    }
+    if (done) {
+      cpu.load(start_);
+    }
+  }
+}
+
+}  // namespace gb
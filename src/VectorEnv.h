@@ -0,0 +1,80 @@
+#ifndef GEEBEE_SRC_VECTORENV_H
+#define GEEBEE_SRC_VECTORENV_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+#include "ThreadPool.h"
+#include "Window.h"
+#include "types.h"
+
+namespace gb {
+
+class Program;
+
+// A pool of identical machines stepped together, as used for reinforcement
+// learning. Observations are written as structure of arrays into buffers
+// owned by the caller, the LCD rendering straight into them.
+class VectorEnv {
+ public:
+  static const int frame_size = Window::width * Window::height;
+
+  // Returns whether an episode has ended. Finished machines restart from the
+  // state they were in when the environment was created.
+  using DoneCheck = std::function<bool(CPU&)>;
+
+  // Caller owned outputs, any of them may be null to skip it.
+  struct Observations {
+    // size() frames of frame_size shades each.
+    Byte* frames{nullptr};
+    // size() rows of the bytes at the configured RAM addresses.
+    Byte* ram{nullptr};
+    // size() flags, 1 if the episode ended during this step.
+    Byte* done{nullptr};
+    // size() flags, 1 if the machine stopped on an error during this step,
+    // which ends its episode as well.
+    Byte* error{nullptr};
+  };
+
+  VectorEnv(std::shared_ptr<const Program> program, std::size_t size,
+            std::vector<Word> ram_addresses, DoneCheck done = nullptr,
+            int threads = 0);
+  VectorEnv(const VectorEnv& env) = delete;
+  VectorEnv(VectorEnv&& env) = delete;
+  ~VectorEnv();
+  VectorEnv& operator=(const VectorEnv& env) = delete;
+  VectorEnv& operator=(const VectorEnv&& env) = delete;
+
+  std::size_t size() const { return machines_.size(); }
+  const std::vector<Word>& ram_addresses() const { return ram_addresses_; }
+  CPU& machine(std::size_t index) { return *machines_[index]; }
+  // Message of the last error machine `index` stopped on, if any
+  const std::string& error(std::size_t index) const { return errors_[index]; }
+
+  // Restarts every machine from its initial state.
+  void reset();
+  // Holds actions[i] (Joypad::set keys) on machine i for `frames` frames.
+  // Only the last frame is rendered.
+  void stepBatch(const Byte* actions, int frames, const Observations& out);
+
+ private:
+  void stepRange(std::size_t begin, std::size_t end, const Byte* actions,
+                 int frames, const Observations& out);
+
+  std::shared_ptr<const Program> program_;
+  std::vector<Word> ram_addresses_;
+  DoneCheck done_;
+
+  Window window_;
+  std::vector<std::unique_ptr<CPU>> machines_;
+  std::vector<std::string> errors_;
+  CPU::State start_;
+  ThreadPool pool_;
+};
+
+}  // namespace gb
+
+#endif
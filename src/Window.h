@@ -1,14 +1,20 @@
 #ifndef GEEBEE_SRC_WINDOW_H
 #define GEEBEE_SRC_WINDOW_H
 
+#include "types.h"
+
 namespace gb {
 
 class Window {
  public:
+  static const int width = 160;
+  static const int height = 144;
+
   Window() = default;
   virtual ~Window() = default;
 
-  virtual void setPixel(int /*x*/, int /*y*/, int /*color*/) {}
+  // Receives every finished frame as width * height shades, row by row.
+  virtual void setFrame(const Byte* /*pixels*/) {}
 };
 
 }  // namespace gb
@@ -0,0 +1,243 @@
+#include "geebee.h"
+
+#include <cstring>
+#include <memory>
+
+#include "CPU.h"
+#include "Program.h"
+#include "Window.h"
+#include "hash.h"
+#include "savestate.h"
+
+struct gb_program {
+  std::shared_ptr<const gb::Program> program;
+  // XXH64 of the ROM, which every state of its machines starts with
+  uint64_t hash{0};
+};
+
+struct gb_machine {
+  explicit gb_machine(const gb_program& program)
+      : program(program.program), hash(program.hash) {}
+
+  // Shared with every other machine of the same program
+  std::shared_ptr<const gb::Program> program;
+  uint64_t hash{0};
+  gb::Window window;
+  std::unique_ptr<gb::CPU> cpu;
+  gb::CPU::State state;
+  // Set when the machine stopped on an error, until a reset or a state load
+  bool halted{false};
+};
+
+namespace {
+
+// States are the ROM hash followed by the savestate encoding. A state fits
+// a machine of the same ROM if its cartridge RAM has the same size too,
+// the rest of the machine always has.
+const size_t hash_size = sizeof(uint64_t);
+
+bool matches(const gb::CPU::State& left, const gb::CPU::State& right) {
+  return left.mbc.ram.size() == right.mbc.ram.size();
+}
+
+// No exception may cross into C. Anything that goes wrong while running a
+// machine, such as an invalid opcode, halts it instead.
+template <typename Run>
+bool guard(gb_machine* machine, Run run) {
+  try {
+    run();
+    return true;
+  } catch (...) {
+    machine->halted = true;
+    return false;
+  }
+}
+
+}  // namespace
+
+uint32_t gb_abi_version(void) { return GEEBEE_ABI_VERSION; }
+
+gb_program* gb_program_create(const uint8_t* rom, size_t rom_size,
+                              const uint8_t* bootrom, size_t bootrom_size) {
+  // The boot ROM is mapped over the first 0x100 bytes in full
+  if (!rom || (bootrom && bootrom_size != 0 && bootrom_size != 0x100)) {
+    return nullptr;
+  }
+
+  try {
+    gb::Bytes bootrom_bytes;
+    if (bootrom) {
+      bootrom_bytes.assign(bootrom, bootrom + bootrom_size);
+    }
+    auto program = std::make_shared<const gb::Program>(
+        gb::Bytes(rom, rom + rom_size), std::move(bootrom_bytes));
+    if (!program->is_valid()) {
+      return nullptr;
+    }
+    uint64_t hash = gb::hash::bytes(rom, rom_size);
+    return new gb_program{std::move(program), hash};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void gb_program_destroy(gb_program* program) { delete program; }
+
+gb_machine* gb_create_from_program(const gb_program* program) {
+  if (!program) {
+    return nullptr;
+  }
+
+  try {
+    std::unique_ptr<gb_machine> machine{new gb_machine{*program}};
+    machine->cpu.reset(new gb::CPU{machine->window, *machine->program});
+    return machine.release();
+  } catch (...) {
+    // Unsupported cartridge types, boot ROMs that crash, or no memory
+    return nullptr;
+  }
+}
+
+gb_machine* gb_create(const uint8_t* rom, size_t rom_size,
+                      const uint8_t* bootrom, size_t bootrom_size) {
+  std::unique_ptr<gb_program> program{
+      gb_program_create(rom, rom_size, bootrom, bootrom_size)};
+  return gb_create_from_program(program.get());
+}
+
+void gb_destroy(gb_machine* machine) { delete machine; }
+
+void gb_reset(gb_machine* machine) {
+  if (guard(machine, [machine]() { machine->cpu->reset(); })) {
+    machine->halted = false;
+  }
+}
+
+int gb_halted(const gb_machine* machine) { return machine->halted ? 1 : 0; }
+
+uint64_t gb_step_cycles(gb_machine* machine, uint64_t cycles) {
+  uint64_t timing = 0;
+  if (!machine->halted) {
+    guard(machine, [machine, cycles, &timing]() {
+      while (timing < cycles) {
+        timing += machine->cpu->step();
+      }
+    });
+  }
+  return timing;
+}
+
+void gb_step_frames(gb_machine* machine, uint32_t frames) {
+  if (!machine->halted) {
+    guard(machine, [machine, frames]() {
+      for (uint32_t i = 0; i < frames; i++) {
+        machine->cpu->cycle();
+      }
+    });
+  }
+}
+
+void gb_set_joypad(gb_machine* machine, uint8_t keys) {
+  machine->cpu->joypad().set(keys);
+}
+
+const uint8_t* gb_framebuffer(const gb_machine* machine) {
+  return machine->cpu->lcd().framebuffer();
+}
+
+const uint8_t* gb_memory(const gb_machine* machine, enum gb_region region,
+                         size_t* size) {
+  const gb::Memory& memory = machine->cpu->memory();
+  const uint8_t* data = nullptr;
+  size_t length = 0;
+
+  switch (region) {
+    case GB_REGION_WRAM:
+      data = memory.ram().data();
+      length = memory.ram().size();
+      break;
+    case GB_REGION_VRAM:
+      data = memory.vram().data();
+      length = memory.vram().size();
+      break;
+    case GB_REGION_OAM:
+      data = memory.sat().data();
+      length = memory.sat().size();
+      break;
+    case GB_REGION_IO:
+      data = memory.io().data();
+      length = memory.io().size();
+      break;
+    case GB_REGION_HRAM:
+      data = memory.hram().data();
+      length = memory.hram().size();
+      break;
+    case GB_REGION_CARTRIDGE_RAM:
+      data = memory.mbc().ramData();
+      length = memory.mbc().ramSize();
+      break;
+  }
+
+  if (length == 0) {
+    data = nullptr;
+  }
+  if (size) {
+    *size = length;
+  }
+  return data;
+}
+
+const char* gb_serial(const gb_machine* machine, size_t* size) {
+  const std::string& serial = machine->cpu->memory().serial_data();
+  if (size) {
+    *size = serial.size();
+  }
+  return serial.c_str();
+}
+
+size_t gb_state_size(gb_machine* machine) {
+  try {
+    machine->cpu->save(machine->state);
+    return hash_size + gb::savestate::size(machine->state);
+  } catch (...) {
+    return 0;
+  }
+}
+
+int gb_save_state(gb_machine* machine, uint8_t* buffer, size_t size) {
+  try {
+    if (size < hash_size) {
+      return -1;
+    }
+    machine->cpu->save(machine->state);
+    std::memcpy(buffer, &machine->hash, hash_size);
+    return gb::savestate::write(machine->state, buffer + hash_size,
+                                size - hash_size)
+               ? 0
+               : -1;
+  } catch (...) {
+    return -1;
+  }
+}
+
+int gb_load_state(gb_machine* machine, const uint8_t* buffer, size_t size) {
+  try {
+    uint64_t hash = 0;
+    if (size < hash_size) {
+      return -1;
+    }
+    std::memcpy(&hash, buffer, hash_size);
+    gb::CPU::State state;
+    machine->cpu->save(machine->state);
+    if (hash != machine->hash ||
+        !gb::savestate::read(state, buffer + hash_size, size - hash_size) ||
+        !matches(state, machine->state)) {
+      return -1;
+    }
+    machine->cpu->load(state);
+    machine->halted = false;
+    return 0;
+  } catch (...) {
+    return -1;
+  }
+}
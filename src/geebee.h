@@ -0,0 +1,112 @@
+#ifndef GEEBEE_SRC_GEEBEE_H
+#define GEEBEE_SRC_GEEBEE_H
+
+/*
+ * Stable C interface of the emulator core, as exported by libgeebee.so.
+ *
+ * Machines are independent of each other and may be driven from different
+ * threads, but every single machine must only be used by one thread at a
+ * time. Pointers into a machine stay valid until the next call that steps,
+ * resets or loads a state into it. Programs never change once created, so
+ * machines on any thread may share one.
+ *
+ * No function lets a C++ exception escape. A machine that runs into an
+ * error, such as an invalid opcode, halts until it is reset or a state is
+ * loaded into it, see gb_halted.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define GEEBEE_API __declspec(dllexport)
+#else
+#define GEEBEE_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GEEBEE_ABI_VERSION 1
+
+#define GEEBEE_SCREEN_WIDTH 160
+#define GEEBEE_SCREEN_HEIGHT 144
+
+typedef struct gb_program gb_program;
+typedef struct gb_machine gb_machine;
+
+/* Joypad bits for gb_set_joypad. */
+enum gb_key {
+  GB_KEY_UP = 1 << 0,
+  GB_KEY_DOWN = 1 << 1,
+  GB_KEY_LEFT = 1 << 2,
+  GB_KEY_RIGHT = 1 << 3,
+  GB_KEY_START = 1 << 4,
+  GB_KEY_SELECT = 1 << 5,
+  GB_KEY_A = 1 << 6,
+  GB_KEY_B = 1 << 7
+};
+
+enum gb_region {
+  GB_REGION_WRAM = 0,
+  GB_REGION_VRAM = 1,
+  GB_REGION_OAM = 2,
+  GB_REGION_IO = 3,
+  GB_REGION_HRAM = 4,
+  GB_REGION_CARTRIDGE_RAM = 5
+};
+
+GEEBEE_API uint32_t gb_abi_version(void);
+
+/* Copies the ROM and optional boot ROM, which has to be 0x100 bytes long.
+ * Returns NULL for invalid ROMs. */
+GEEBEE_API gb_program* gb_program_create(const uint8_t* rom, size_t rom_size,
+                                         const uint8_t* bootrom,
+                                         size_t bootrom_size);
+/* Machines keep their program alive, so it can be destroyed once they are
+ * created. */
+GEEBEE_API void gb_program_destroy(gb_program* program);
+
+/* Creates a machine that shares the program with every other machine of it,
+ * or returns NULL if it can not run. */
+GEEBEE_API gb_machine* gb_create_from_program(const gb_program* program);
+/* Creates a machine with a program of its own, see gb_program_create. */
+GEEBEE_API gb_machine* gb_create(const uint8_t* rom, size_t rom_size,
+                                 const uint8_t* bootrom, size_t bootrom_size);
+GEEBEE_API void gb_destroy(gb_machine* machine);
+GEEBEE_API void gb_reset(gb_machine* machine);
+/* Returns 1 if the machine stopped on an error and steps do nothing, 0 if it
+ * runs. */
+GEEBEE_API int gb_halted(const gb_machine* machine);
+
+/* Runs whole instructions until at least `cycles` clocks have passed and
+ * returns the clocks actually run. */
+GEEBEE_API uint64_t gb_step_cycles(gb_machine* machine, uint64_t cycles);
+GEEBEE_API void gb_step_frames(gb_machine* machine, uint32_t frames);
+
+/* Sets the pressed keys as a combination of gb_key bits. */
+GEEBEE_API void gb_set_joypad(gb_machine* machine, uint8_t keys);
+
+/* GEEBEE_SCREEN_WIDTH * GEEBEE_SCREEN_HEIGHT shades, 0 black to 255 white. */
+GEEBEE_API const uint8_t* gb_framebuffer(const gb_machine* machine);
+/* Returns the region and stores its size, or NULL if it does not exist. */
+GEEBEE_API const uint8_t* gb_memory(const gb_machine* machine,
+                                    enum gb_region region, size_t* size);
+GEEBEE_API const char* gb_serial(const gb_machine* machine, size_t* size);
+
+/* States start with a hash of the ROM and only load into machines of the
+ * same ROM. The save and load
+ * functions return 0 on success and -1 if the buffer is too small or does
+ * not hold a matching state. gb_state_size returns 0 if it fails. */
+GEEBEE_API size_t gb_state_size(gb_machine* machine);
+GEEBEE_API int gb_save_state(gb_machine* machine, uint8_t* buffer,
+                             size_t size);
+GEEBEE_API int gb_load_state(gb_machine* machine, const uint8_t* buffer,
+                             size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
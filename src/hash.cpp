@@ -0,0 +1,95 @@
+#include "hash.h"
+
+#include <cstring>
+
+namespace gb {
+namespace hash {
+
+namespace {
+
+const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t prime3 = 0x165667B19E3779F9ULL;
+const uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+uint64_t rotate(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t read64(const Byte* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t read32(const Byte* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * prime2;
+  accumulator = rotate(accumulator, 31);
+  return accumulator * prime1;
+}
+
+uint64_t merge(uint64_t accumulator, uint64_t value) {
+  accumulator ^= round(0, value);
+  return accumulator * prime1 + prime4;
+}
+
+}  // namespace
+
+uint64_t bytes(const void* data, std::size_t size, uint64_t seed) {
+  const Byte* input = static_cast<const Byte*>(data);
+  const Byte* end = input + size;
+  uint64_t result;
+
+  if (size >= 32) {
+    uint64_t v1 = seed + prime1 + prime2;
+    uint64_t v2 = seed + prime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - prime1;
+    for (; end - input >= 32; input += 32) {
+      v1 = round(v1, read64(input));
+      v2 = round(v2, read64(input + 8));
+      v3 = round(v3, read64(input + 16));
+      v4 = round(v4, read64(input + 24));
+    }
+    result = rotate(v1, 1) + rotate(v2, 7) + rotate(v3, 12) + rotate(v4, 18);
+    result = merge(result, v1);
+    result = merge(result, v2);
+    result = merge(result, v3);
+    result = merge(result, v4);
+  } else {
+    result = seed + prime5;
+  }
+
+  result += size;
+
+  for (; end - input >= 8; input += 8) {
+    result ^= round(0, read64(input));
+    result = rotate(result, 27) * prime1 + prime4;
+  }
+  if (end - input >= 4) {
+    result ^= static_cast<uint64_t>(read32(input)) * prime1;
+    result = rotate(result, 23) * prime2 + prime3;
+    input += 4;
+  }
+  for (; input < end; input++) {
+    result ^= *input * prime5;
+    result = rotate(result, 11) * prime1;
+  }
+
+  result ^= result >> 33;
+  result *= prime2;
+  result ^= result >> 29;
+  result *= prime3;
+  result ^= result >> 32;
+  return result;
+}
+
+}  // namespace hash
+}  // namespace gb
@@ -0,0 +1,18 @@
+#ifndef GEEBEE_SRC_HASH_H
+#define GEEBEE_SRC_HASH_H
+
+#include <cstddef>
+
+#include "types.h"
+
+namespace gb {
+namespace hash {
+
+// 64 bit XXH64 hash of `size` bytes, fast enough to hash whole ROMs and
+// frames on the fly.
+uint64_t bytes(const void* data, std::size_t size, uint64_t seed = 0);
+
+}  // namespace hash
+}  // namespace gb
+
+#endif
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "Batch.h"
+#include "Capture.h"
+#include "FrameHashes.h"
+#include "Movie.h"
+#include "Profiler.h"
+#include "Timeline.h"
+#include "Program.h"
+
+namespace po = boost::program_options;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace {
+
+const char* statusName(gb::Batch::Result::Status status) {
+  switch (status) {
+    case gb::Batch::Result::Status::Pending:
+      return "pending";
+    case gb::Batch::Result::Status::Done:
+      return "done";
+    case gb::Batch::Result::Status::Passed:
+      return "passed";
+    case gb::Batch::Result::Status::Failed:
+      return "failed";
+    case gb::Batch::Result::Status::TimedOut:
+      return "timed out";
+    case gb::Batch::Result::Status::Error:
+      return "error";
+  }
+  return "";
+}
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  po::options_description desc{"Allowed options"};
+  desc.add_options()("help,h", "Show the help message")(
+      "file,f", po::value<vector<string>>(), "The .gb files to run")(
+      "bootrom,b", po::value<string>()->default_value(""),
+      "The .bin file to read for the boot rom")(
+      "threads,j", po::value<int>()->default_value(0),
+      "Worker threads, one per core by default")(
+      "pin", "Keep every worker thread and its machines on one core")(
+      "copies,n", po::value<int>()->default_value(1),
+      "Instances to run of every file")(
+      "frames", po::value<long>()->default_value(0),
+      "Run this many frames")(
+      "until", po::value<string>()->default_value(""),
+      "Run until the serial output contains this text")(
+      "fail", po::value<string>()->default_value("Failed"),
+      "Stop with a failure when the serial output contains this text")(
+      "max-frames", po::value<long>()->default_value(60 * 60 * 10),
+      "Give up on --until after this many frames")(
+      "movie", po::value<string>(), "Replay the joypad input of this file")(
+      "video", po::value<string>()->default_value(""),
+      "Record the frames of a single instance to this .y4m or raw file")(
+      "audio", po::value<string>()->default_value(""),
+      "Record the sound of a single instance to this .wav file")(
+      "capture-every", po::value<int>()->default_value(1),
+      "Record only every Nth frame of video")(
+      "sample-rate", po::value<int>()->default_value(48000),
+      "Sample rate of the recorded sound")(
+      "hashes", po::value<string>()->default_value(""),
+      "Write a hash of every frame of the first instance to this file")(
+      "state-hashes", "Also hash the whole machine state after every frame")(
+      "golden", po::value<string>()->default_value(""),
+      "Compare the frame hashes of every instance to this file")(
+      "profile", po::value<string>()->default_value(""),
+      "Write where a single instance spends its cycles to this file")(
+      "flamegraph", po::value<string>()->default_value(""),
+      "Write the profiled call stacks to this file for flamegraph.pl")(
+      "symbols", po::value<string>()->default_value(""),
+      "Name profiled code after the labels of this RGBDS .sym file")(
+      "timeline", po::value<string>()->default_value(""),
+      "Write the host time of every frame to this Chrome trace file");
+
+  po::positional_options_description pos_desc;
+  pos_desc.add("file", -1);
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv)
+                .options(desc)
+                .positional(pos_desc)
+                .run(),
+            vm);
+  po::notify(vm);
+
+  if (vm.find("help") != vm.end() || vm.find("file") == vm.end()) {
+    cout << desc << endl;
+    return 1;
+  }
+
+  gb::Batch::Job job = gb::Batch::Job::runFrames(vm["frames"].as<long>());
+  if (vm.find("movie") != vm.end()) {
+    auto movie = std::make_shared<gb::Movie>(vm["movie"].as<string>());
+    if (!movie->is_valid()) {
+      cout << "Invalid movie!" << endl;
+      return 2;
+    }
+    job = gb::Batch::Job::replay(movie);
+  } else if (!vm["until"].as<string>().empty()) {
+    job = gb::Batch::Job::runUntilSerial(vm["until"].as<string>(),
+                                         vm["fail"].as<string>(),
+                                         vm["max-frames"].as<long>());
+  }
+
+  bool single = vm["file"].as<vector<string>>().size() == 1 &&
+                vm["copies"].as<int>() == 1;
+  std::unique_ptr<gb::Capture> capture;
+  if (!vm["video"].as<string>().empty() || !vm["audio"].as<string>().empty()) {
+    if (!single) {
+      cout << "Recording needs exactly one instance!" << endl;
+      return 1;
+    }
+    gb::Capture::Options options;
+    options.video = vm["video"].as<string>();
+    options.audio = vm["audio"].as<string>();
+    options.every = vm["capture-every"].as<int>();
+    options.sample_rate = vm["sample-rate"].as<int>();
+    capture.reset(new gb::Capture{options});
+    if (!capture->is_valid()) {
+      cout << "Can't record to the given files!" << endl;
+      return 2;
+    }
+  }
+
+  const string& profile = vm["profile"].as<string>();
+  const string& flamegraph = vm["flamegraph"].as<string>();
+  std::shared_ptr<const gb::Program> profiled;
+  std::unique_ptr<gb::Profiler> profiler;
+  if (!profile.empty() || !flamegraph.empty()) {
+    if (!single) {
+      cout << "Profiling needs exactly one instance!" << endl;
+      return 1;
+    }
+    profiled = std::make_shared<gb::Program>(
+        vm["file"].as<vector<string>>()[0], vm["bootrom"].as<string>());
+    profiler.reset(new gb::Profiler{*profiled});
+    const string& symbols = vm["symbols"].as<string>();
+    if (!symbols.empty() && !profiler->loadSymbols(symbols)) {
+      cout << "Can't read " << symbols << endl;
+      return 2;
+    }
+  }
+
+  const string& timeline = vm["timeline"].as<string>();
+  if (!timeline.empty()) {
+    if (!gb::Timeline::compiled) {
+      cout << "Timelines need a build configured with GEEBEE_PERF" << endl;
+      return 1;
+    }
+    gb::Timeline::global().start();
+  }
+
+  gb::FrameHashes golden;
+  if (!vm["golden"].as<string>().empty()) {
+    golden = gb::FrameHashes{vm["golden"].as<string>()};
+    if (!golden.is_valid()) {
+      cout << "Invalid golden hashes!" << endl;
+      return 2;
+    }
+  }
+  job.hash_frames = golden.is_valid() || !vm["hashes"].as<string>().empty();
+  job.hash_states = vm.find("state-hashes") != vm.end();
+
+  gb::Batch batch{vm["threads"].as<int>(), 30, vm.find("pin") != vm.end()};
+  vector<string> names;
+  std::map<string, std::shared_ptr<const gb::Program>> programs;
+  for (const string& file : vm["file"].as<vector<string>>()) {
+    auto& program = programs[file];
+    if (!program) {
+      program = profiled ? profiled
+                         : std::make_shared<gb::Program>(
+                               file, vm["bootrom"].as<string>());
+    }
+    if (!program->is_valid()) {
+      cout << "Invalid rom: " << file << endl;
+      return 2;
+    }
+
+    for (int i = 0; i < vm["copies"].as<int>(); i++) {
+      batch.add(program, job, capture.get(), profiler.get());
+      names.push_back(file);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  batch.run();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (capture) {
+    capture->finish();
+    cout << "Recorded " << capture->videoFrames() << " frames and "
+         << capture->audioSamples() << " samples, waited for the disk "
+         << capture->stalls() << " times" << endl;
+  }
+
+  if (!timeline.empty() &&
+      !gb::Timeline::global().writeChromeTrace(timeline)) {
+    cout << "Can't write " << timeline << endl;
+  }
+  if (!profile.empty()) {
+    std::ofstream out{profile};
+    profiler->writeReport(out);
+  }
+  if (!flamegraph.empty()) {
+    std::ofstream out{flamegraph};
+    profiler->writeCollapsed(out);
+  }
+
+  bool failed = false;
+  std::size_t footprint = 0;
+  for (std::size_t i = 0; i < batch.size(); i++) {
+    const gb::Batch::Result& result = batch.result(i);
+    footprint = std::max(footprint, result.footprint);
+    cout << names[i] << ": " << statusName(result.status);
+    if (!result.error.empty()) {
+      cout << " (" << result.error << ")";
+    }
+    cout << " after " << result.frames << " frames in " << result.seconds
+         << "s" << endl;
+    failed |= result.status == gb::Batch::Result::Status::Failed ||
+              result.status == gb::Batch::Result::Status::TimedOut ||
+              result.status == gb::Batch::Result::Status::Error;
+    if (golden.is_valid()) {
+      long frame = result.hashes.firstDivergence(golden);
+      if (frame >= 0) {
+        cout << names[i] << ": differs from the golden hashes at frame "
+             << frame << endl;
+        failed = true;
+      }
+    }
+  }
+
+  if (!vm["hashes"].as<string>().empty() && batch.size() > 0 &&
+      !batch.result(0).hashes.save(vm["hashes"].as<string>())) {
+    cout << "Can't write the hashes!" << endl;
+    return 2;
+  }
+
+  cout << batch.size() << " instances on " << batch.threads() << " threads: "
+       << batch.totalFrames() << " frames in " << elapsed.count() << "s ("
+       << batch.totalFrames() / elapsed.count() << " frames/s), up to "
+       << footprint / 1024 << " KB per instance" << endl;
+
+  return failed ? 3 : 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "RomIndex.h"
+
+namespace po = boost::program_options;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+int main(int argc, const char** argv) {
+  po::options_description desc{"Allowed options"};
+  desc.add_options()("help,h", "Show the help message")(
+      "directory,d", po::value<vector<string>>(), "Directories to scan")(
+      "index,i", po::value<string>()->default_value("geebee.index"),
+      "The index file to update")(
+      "threads,j", po::value<int>()->default_value(0),
+      "Worker threads, one per core by default")(
+      "list,l", "Print every indexed ROM");
+
+  po::positional_options_description pos_desc;
+  pos_desc.add("directory", -1);
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv)
+                .options(desc)
+                .positional(pos_desc)
+                .run(),
+            vm);
+  po::notify(vm);
+
+  if (vm.find("help") != vm.end()) {
+    cout << desc << endl;
+    return 1;
+  }
+
+  gb::RomIndex index{vm["index"].as<string>(), vm["threads"].as<int>()};
+  if (vm.find("directory") != vm.end()) {
+    gb::RomIndex::Stats stats =
+        index.scan(vm["directory"].as<vector<string>>());
+    cout << stats.indexed << " indexed, " << stats.unchanged << " unchanged, "
+         << stats.removed << " removed, " << stats.invalid << " invalid"
+         << endl;
+
+    if (!index.save()) {
+      cout << "Could not write " << vm["index"].as<string>() << endl;
+      return 2;
+    }
+  }
+
+  if (vm.find("list") != vm.end()) {
+    for (const gb::RomIndex::Entry& entry : index.entries()) {
+      cout << std::hex << entry.hash << std::dec << " mbc " << entry.mbc
+           << (entry.header.checksum_valid ? " ok  " : " bad ")
+           << entry.header.title.c_str() << " " << entry.path << endl;
+    }
+  }
+
+  return 0;
+}
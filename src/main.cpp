@@ -1,15 +1,21 @@
 #include <iostream>
+#include <memory>
 #include <string>
 
+#include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 #include <SDL.h>
 
 #include "CPU.h"
 #include "LCD.h"
 #include "Program.h"
+#include "RunAhead.h"
+#include "SDLAudio.h"
 #include "SDLManager.h"
 #include "SDLWindow.h"
+#include "Timeline.h"
 
+namespace fs = boost::filesystem;
 namespace po = boost::program_options;
 using std::cout;
 using std::endl;
@@ -21,7 +27,18 @@ int main(int argc, const char** argv) {
   desc.add_options()("help,h", "Show the help message")(
       "file,f", po::value<string>(), "The .gb file to read")(
       "bootrom,b", po::value<string>()->default_value(""),
-      "The .bin file to read for the boot rom");
+      "The .bin file to read for the boot rom")(
+      "runahead,r", po::value<int>()->default_value(0),
+      "Frames to run ahead of the input to hide its latency")(
+      "save,s", po::value<string>(),
+      "The .sav file for battery RAM, next to the .gb file by default")(
+      "mute,m", "Run without sound, paced by the display timer")(
+      "trace", po::value<string>(),
+      "Write the last executed instructions to this file on exit")(
+      "trace-size", po::value<std::size_t>()->default_value(1 << 20),
+      "Instructions to keep for --trace")(
+      "timeline", po::value<string>(),
+      "Write the host time of every frame to this Chrome trace file on exit");
 
   po::positional_options_description pos_desc;
   pos_desc.add("file", -1);
@@ -56,12 +73,88 @@ int main(int argc, const char** argv) {
   gb::SDLManager sdl;
   gb::SDLWindow window;
   gb::CPU cpu{window, program};
+
+  string save = vm.count("save")
+                    ? vm["save"].as<string>()
+                    : fs::path{vm["file"].as<string>()}
+                          .replace_extension(".sav")
+                          .string();
+  if (cpu.memory().mbc().attachSaveFile(save)) {
+    cout << "save file: " << save << endl;
+  }
+
+  if (vm.count("trace")) {
+    if (!gb::CPU::Tracer::enabled) {
+      cout << "Tracing needs a build configured with GEEBEE_TRACE" << endl;
+      return 1;
+    }
+    cpu.tracer().setCapacity(vm["trace-size"].as<std::size_t>());
+  }
+
+  gb::Timeline& timeline = gb::Timeline::global();
+  if (vm.count("timeline")) {
+    if (!gb::Timeline::compiled) {
+      cout << "Timelines need a build configured with GEEBEE_PERF" << endl;
+      return 1;
+    }
+    timeline.start();
+  }
+
+  gb::RunAhead runahead{cpu, vm["runahead"].as<int>()};
+
+  std::unique_ptr<gb::SDLAudio> audio;
+  if (!vm.count("mute")) {
+    audio.reset(new gb::SDLAudio{});
+    if (audio->is_open()) {
+      cpu.apu().setSampleRate(audio->sampleRate());
+      window.setPacing(false);
+    } else {
+      cout << "No audio device, running without sound" << endl;
+      audio.reset();
+    }
+  }
+
   while (true) {
     if (window.handleEvents(cpu.joypad())) {
       break;
     }
-    cpu.cycle();
+    bool timed = gb::Timeline::compiled && timeline.recording();
+    uint64_t begin = timed ? gb::Timeline::ticks() : 0;
+    runahead.cycle();
+    if (audio) {
+      audio->queue(cpu.apu());
+    }
+    if (timed) {
+      timeline.span("frame", begin);
+      begin = gb::Timeline::ticks();
+    }
     window.draw();
+    if (timed) {
+      timeline.span("present", begin);
+      begin = gb::Timeline::ticks();
+    }
+    if (audio) {
+      audio->sync();
+    }
+    if (timed) {
+      timeline.span("sync", begin);
+    }
+  }
+
+  cout << "frame cost: " << runahead.frameCost() << "us" << endl;
+  if (audio) {
+    cout << "audio underruns: " << audio->underruns() << endl;
+  }
+  if (runahead.frames() > 0) {
+    cout << "run-ahead cost: " << runahead.aheadCost() << "us per frame"
+         << endl;
+  }
+  if (vm.count("timeline") &&
+      !timeline.writeChromeTrace(vm["timeline"].as<string>())) {
+    cout << "Could not write " << vm["timeline"].as<string>() << endl;
+  }
+  if (vm.count("trace") && !cpu.tracer().save(vm["trace"].as<string>())) {
+    cout << "Could not write " << vm["trace"].as<string>() << endl;
   }
 
   return 0;
@@ -0,0 +1,248 @@
+#include "savestate.h"
+
+#include <array>
+#include <cstring>
+
+namespace gb {
+namespace savestate {
+
+namespace {
+
+const uint32_t magic = 0x54534247;  // "GBST"
+const uint32_t version = 5;
+
+// Visits every field of a state in a fixed order, so reading, writing and
+// measuring can never disagree on the layout.
+template <typename Archive, typename State>
+bool visit(Archive& archive, State& state) {
+  uint32_t header[2] = {magic, version};
+  archive.value(header[0]);
+  archive.value(header[1]);
+  if (header[0] != magic || header[1] != version) {
+    return false;
+  }
+
+  auto& cpu = state.machine.cpu;
+  archive.value(cpu.a);
+  archive.value(cpu.f);
+  archive.value(cpu.b);
+  archive.value(cpu.c);
+  archive.value(cpu.d);
+  archive.value(cpu.e);
+  archive.value(cpu.h);
+  archive.value(cpu.l);
+  archive.value(cpu.sp);
+  archive.value(cpu.pc);
+  archive.value(cpu.interrupts);
+  archive.value(cpu.halt);
+  archive.value(cpu.zero);
+  archive.value(cpu.add);
+  archive.value(cpu.half_carry);
+  archive.value(cpu.carry);
+
+  auto& memory = state.machine.memory;
+  archive.value(memory.booting);
+  archive.value(memory.oam_access);
+  archive.value(memory.vram_access);
+  archive.bytes(memory.ram);
+  archive.bytes(memory.vram);
+  archive.bytes(memory.sat);
+  archive.bytes(memory.io);
+  archive.bytes(memory.hram);
+  archive.bytes(state.serial_data);
+  archive.value(memory.cycles);
+  archive.value(memory.dma);
+  archive.value(memory.dma_end);
+
+  auto& mbc = state.mbc;
+  archive.value(mbc.ram_enable);
+  archive.value(mbc.rom_bank);
+  archive.value(mbc.ram_bank);
+  archive.value(mbc.ram_banking);
+  archive.bytes(mbc.ram);
+  archive.value(mbc.rtc.registers);
+  archive.value(mbc.rtc.latched);
+  archive.value(mbc.rtc.latch);
+  archive.value(mbc.rtc.subsecond);
+  archive.value(mbc.rtc.last);
+
+  for (auto& key : state.machine.joypad) {
+    archive.value(key);
+  }
+  archive.value(state.machine.timer.divider);
+  archive.value(state.machine.timer.counter);
+  archive.value(state.machine.apu);
+  archive.value(state.machine.lcd.enabled);
+  archive.value(state.machine.lcd.mode);
+  archive.value(state.machine.lcd.mode_timing);
+  archive.value(state.machine.lcd.done_frame);
+
+  return archive.ok();
+}
+
+class Measure {
+ public:
+  template <typename T>
+  void value(const T&) {
+    size_ += sizeof(T);
+  }
+  template <typename Buffer>
+  void bytes(const Buffer& buffer) {
+    size_ += sizeof(uint32_t) + buffer.size();
+  }
+  bool ok() const { return true; }
+  std::size_t size() const { return size_; }
+
+ private:
+  std::size_t size_{0};
+};
+
+class Writer {
+ public:
+  Writer(Byte* data, std::size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  void value(const T& value) {
+    copy(&value, sizeof(T));
+  }
+  template <typename Buffer>
+  void bytes(const Buffer& buffer) {
+    uint32_t size = static_cast<uint32_t>(buffer.size());
+    value(size);
+    copy(buffer.data(), size);
+  }
+  bool ok() const { return ok_; }
+
+ private:
+  void copy(const void* source, std::size_t size) {
+    if (!ok_ || size_ - offset_ < size) {
+      ok_ = false;
+      return;
+    }
+    std::memcpy(data_ + offset_, source, size);
+    offset_ += size;
+  }
+
+  Byte* data_;
+  std::size_t size_;
+  std::size_t offset_{0};
+  bool ok_{true};
+};
+
+class Reader {
+ public:
+  Reader(const Byte* data, std::size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  void value(T& value) {
+    copy(&value, sizeof(T));
+  }
+  // Flags and modes only take the values they can hold, anything else
+  // means the data is not a state
+  void value(bool& flag) {
+    static_assert(sizeof(bool) == 1, "Flags are stored as one byte");
+    Byte byte = 0;
+    copy(&byte, 1);
+    if (byte > 1) {
+      ok_ = false;
+      return;
+    }
+    flag = byte == 1;
+  }
+  void value(MachineState::LcdMode& mode) {
+    int number = 0;
+    copy(&number, sizeof(number));
+    if (number < static_cast<int>(MachineState::LcdMode::HBlank) ||
+        number > static_cast<int>(MachineState::LcdMode::VRAM)) {
+      ok_ = false;
+      return;
+    }
+    mode = static_cast<MachineState::LcdMode>(number);
+  }
+  // The sound channels index their waveforms with these fields
+  void value(MachineState::Apu& apu) {
+    static_assert(sizeof(MachineState::Apu) ==
+                      sizeof(apu.channels) + 2 * sizeof(int),
+                  "The sound state has no padding");
+    copy(&apu, sizeof(apu));
+    const int lengths[4] = {8, 8, 32, 1};
+    for (std::size_t i = 0; i < apu.channels.size(); i++) {
+      const MachineState::Channel& channel = apu.channels[i];
+      if (channel.position < 0 || channel.position >= lengths[i] ||
+          channel.timer < 0 || channel.volume < 0 || channel.volume > 15 ||
+          channel.lfsr < 0 || channel.lfsr > 0x7FFF) {
+        ok_ = false;
+      }
+    }
+    if (apu.sequencer_step < 0 || apu.sequencer_step > 7) {
+      ok_ = false;
+    }
+  }
+  void bytes(Bytes& buffer) {
+    buffer.resize(length());
+    copy(buffer.data(), buffer.size());
+  }
+  // Regions of the state block only take data of their own size
+  template <std::size_t N>
+  void bytes(std::array<Byte, N>& buffer) {
+    if (length() != N) {
+      ok_ = false;
+      return;
+    }
+    copy(buffer.data(), N);
+  }
+  void bytes(SharedBytes& buffer) {
+    buffer.assign(length(), 0);
+    copy(buffer.mutableData(), buffer.size());
+  }
+  void bytes(std::string& buffer) {
+    buffer.resize(length());
+    copy(&buffer[0], buffer.size());
+  }
+  bool ok() const { return ok_; }
+
+ private:
+  uint32_t length() {
+    uint32_t size = 0;
+    value(size);
+    if (size_ - offset_ < size) {
+      ok_ = false;
+      return 0;
+    }
+    return size;
+  }
+  void copy(void* destination, std::size_t size) {
+    if (!ok_ || size_ - offset_ < size) {
+      ok_ = false;
+      return;
+    }
+    std::memcpy(destination, data_ + offset_, size);
+    offset_ += size;
+  }
+
+  const Byte* data_;
+  std::size_t size_;
+  std::size_t offset_{0};
+  bool ok_{true};
+};
+
+}  // namespace
+
+std::size_t size(const CPU::State& state) {
+  Measure measure;
+  visit(measure, state);
+  return measure.size();
+}
+
+bool write(const CPU::State& state, Byte* data, std::size_t size) {
+  Writer writer{data, size};
+  return visit(writer, state);
+}
+
+bool read(CPU::State& state, const Byte* data, std::size_t size) {
+  Reader reader{data, size};
+  return visit(reader, state);
+}
+
+}  // namespace savestate
+}  // namespace gb
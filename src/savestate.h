@@ -0,0 +1,22 @@
+#ifndef GEEBEE_SRC_SAVESTATE_H
+#define GEEBEE_SRC_SAVESTATE_H
+
+#include <cstddef>
+
+#include "CPU.h"
+#include "types.h"
+
+namespace gb {
+namespace savestate {
+
+// Flat binary encoding of a CPU::State, for storing states outside of the
+// process. Machines only accept states of the same program.
+std::size_t size(const CPU::State& state);
+// Both return false if `size` is too small or the data is not a state.
+bool write(const CPU::State& state, Byte* data, std::size_t size);
+bool read(CPU::State& state, const Byte* data, std::size_t size);
+
+}  // namespace savestate
+}  // namespace gb
+
+#endif
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "CPU.h"
+#include "Trace.h"
+
+namespace po = boost::program_options;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+int main(int argc, const char** argv) {
+  po::options_description desc{"Allowed options"};
+  desc.add_options()("help,h", "Show the help message")(
+      "file,f", po::value<string>(), "The trace written by geebee --trace")(
+      "last,n", po::value<std::size_t>()->default_value(0),
+      "Only print this many of the newest instructions");
+
+  po::positional_options_description pos_desc;
+  pos_desc.add("file", -1);
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv)
+                .options(desc)
+                .positional(pos_desc)
+                .run(),
+            vm);
+  po::notify(vm);
+
+  if (vm.find("help") != vm.end() || vm.find("file") == vm.end()) {
+    cout << desc << endl;
+    return 1;
+  }
+
+  vector<gb::TraceRecord> records;
+  if (!gb::TraceRing::load(vm["file"].as<string>(), records)) {
+    cout << "Invalid trace!" << endl;
+    return 2;
+  }
+
+  std::size_t last = vm["last"].as<std::size_t>();
+  std::size_t first =
+      last && last < records.size() ? records.size() - last : 0;
+  for (std::size_t i = first; i < records.size(); i++) {
+    const gb::TraceRecord& r = records[i];
+    std::printf(
+        "%12llu %02X:%04X %-12s AF:%02X%02X BC:%02X%02X DE:%02X%02X "
+        "HL:%02X%02X SP:%04X\n",
+        static_cast<unsigned long long>(r.cycle), r.bank, r.pc,
+        gb::CPU::describe(r.opcode, r.operand).c_str(), r.a, r.f, r.b, r.c,
+        r.d, r.e, r.h, r.l, r.sp);
+  }
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "CPU.h"
+#include "Program.h"
+#include "Window.h"
+#include "support/RomBuilder.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+// Every allocation of the test binary is counted
+atomic<long> allocations{0};
+
+long countAllocations(CPU& cpu, int frames) {
+  long before = allocations;
+  for (int i = 0; i < frames; i++) {
+    cpu.cycle();
+  }
+  return allocations - before;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocations++;
+  void* memory = malloc(size > 0 ? size : 1);
+  if (!memory) {
+    throw bad_alloc{};
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+TEST_CASE("Running frames does not allocate once warmed up",
+          "[allocations]") {
+  Window window;
+  long before = allocations;
+  unique_ptr<int> counted{new int{0}};
+  REQUIRE(allocations - before == 1);
+
+  SECTION("Bundled test ROMs") {
+    for (string name : {"cpu_instrs", "instr_timing", "mem_timing"}) {
+      INFO(name);
+      Program program{"roms/" + name + ".gb"};
+      REQUIRE(program.is_valid());
+      CPU cpu{window, program};
+      countAllocations(cpu, 60);
+      REQUIRE(countAllocations(cpu, 1000) == 0);
+    }
+  }
+
+  SECTION("Stress ROMs") {
+    for (auto build : {stress::sprites, stress::oamDma, stress::timerInterrupt,
+                       stress::bankSwitching, stress::lyPolling}) {
+      auto program = build();
+      CPU cpu{window, *program};
+      countAllocations(cpu, 60);
+      REQUIRE(countAllocations(cpu, 300) == 0);
+    }
+  }
+}
@@ -0,0 +1,208 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "APU.h"
+#include "CPU.h"
+#include "Memory.h"
+#include "Program.h"
+#include "Window.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+void advance(Memory& memory, APU& apu, int clocks) {
+  for (; clocks > 0; clocks -= 4) {
+    memory.advance(4);
+    apu.advance(4);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("The APU follows the sound registers", "[apu]") {
+  Program program{Bytes(0x8000, 0)};
+  Memory memory{program};
+  APU apu{memory};
+
+  SECTION("Registers only take writes while powered on") {
+    memory.write(0xFF12, 0xF0);
+    REQUIRE(memory.read(0xFF12) == 0x00);
+    REQUIRE(memory.read(0xFF26) == 0x70);
+
+    memory.write(0xFF26, 0x80);
+    memory.write(0xFF12, 0xF0);
+    REQUIRE(memory.read(0xFF12) == 0xF0);
+    REQUIRE(memory.read(0xFF11) == 0x3F);
+
+    memory.write(0xFF26, 0x00);
+    REQUIRE(memory.read(0xFF12) == 0x00);
+  }
+
+  SECTION("Triggered channels stop when their length runs out") {
+    memory.write(0xFF26, 0x80);
+    memory.write(0xFF17, 0xF0);
+    memory.write(0xFF16, 0x3E);
+    memory.write(0xFF19, 0xC0);
+    REQUIRE(memory.read(0xFF26) == 0xF2);
+
+    advance(memory, apu, 8192 * 2);
+    REQUIRE(memory.read(0xFF26) == 0xF2);
+    advance(memory, apu, 8192 * 2);
+    REQUIRE(memory.read(0xFF26) == 0xF0);
+  }
+
+  SECTION("Turning the DAC off disables the channel") {
+    memory.write(0xFF26, 0x80);
+    memory.write(0xFF21, 0xF0);
+    memory.write(0xFF23, 0x80);
+    REQUIRE(memory.read(0xFF26) == 0xF8);
+    memory.write(0xFF21, 0x00);
+    REQUIRE(memory.read(0xFF26) == 0xF0);
+  }
+
+  SECTION("The sweep overflows and disables the first square") {
+    memory.write(0xFF26, 0x80);
+    memory.write(0xFF12, 0xF0);
+    memory.write(0xFF10, 0x11);
+    // 0x500 sweeps to 0x780, whose next step overflows
+    memory.write(0xFF13, 0x00);
+    memory.write(0xFF14, 0x85);
+    REQUIRE(memory.read(0xFF26) == 0xF1);
+    advance(memory, apu, 8192 * 8);
+    REQUIRE(memory.read(0xFF26) == 0xF0);
+  }
+}
+
+TEST_CASE("The APU synthesises band-limited samples", "[apu]") {
+  Program program{Bytes(0x8000, 0)};
+  Memory memory{program};
+  APU apu{memory};
+  apu.setSampleRate(48000);
+
+  memory.write(0xFF26, 0x80);
+  memory.write(0xFF24, 0x77);
+  memory.write(0xFF25, 0x22);
+  // A 50% duty 1kHz square, 131072 / (2048 - 1917)
+  memory.write(0xFF16, 0x80);
+  memory.write(0xFF17, 0xF0);
+  memory.write(0xFF18, 1917 & 0xFF);
+  memory.write(0xFF19, 0x80 | (1917 >> 8));
+
+  // A tenth of a second
+  advance(memory, apu, APU::clock_rate / 10);
+  apu.endFrame();
+  REQUIRE(apu.samplesAvailable() >= 4799);
+  REQUIRE(apu.samplesAvailable() <= 4801);
+
+  vector<int16_t> samples(apu.samplesAvailable() * 2);
+  REQUIRE(apu.readSamples(samples.data(), samples.size() / 2) ==
+          samples.size() / 2);
+  REQUIRE(apu.samplesAvailable() == 0);
+
+  vector<int16_t> left, right;
+  for (size_t i = 0; i < samples.size(); i += 2) {
+    left.push_back(samples[i]);
+    right.push_back(samples[i + 1]);
+  }
+  REQUIRE(left == right);
+
+  auto range = minmax_element(left.begin(), left.end());
+  REQUIRE(*range.second - *range.first > 10000);
+  int middle = (*range.first + *range.second) / 2;
+  int edges = 0;
+  for (size_t i = 1; i < left.size(); i++) {
+    edges += (left[i - 1] < middle) != (left[i] < middle);
+  }
+  REQUIRE(edges >= 195);
+  REQUIRE(edges <= 205);
+
+  SECTION("Frames without synthesis produce no samples") {
+    apu.setSynthesis(false);
+    advance(memory, apu, APU::clock_rate / 10);
+    apu.endFrame();
+    REQUIRE(apu.samplesAvailable() == 0);
+  }
+}
+
+TEST_CASE("The channels advance the same with and without sound",
+          "[apu]") {
+  Program program{Bytes(0x8000, 0)};
+  Memory silent_memory{program};
+  APU silent{silent_memory};
+  Memory heard_memory{program};
+  APU heard{heard_memory};
+  heard.setSampleRate(48000);
+
+  for (Memory* memory : {&silent_memory, &heard_memory}) {
+    memory->write(0xFF26, 0x80);
+    memory->write(0xFF24, 0x77);
+    memory->write(0xFF25, 0xFF);
+    // A square, the wave channel and noise, all audible
+    memory->write(0xFF17, 0xF0);
+    memory->write(0xFF18, 0x00);
+    memory->write(0xFF19, 0x87);
+    memory->write(0xFF1A, 0x80);
+    memory->write(0xFF1C, 0x20);
+    memory->write(0xFF1E, 0x87);
+    memory->write(0xFF21, 0xF0);
+    memory->write(0xFF22, 0x21);
+    memory->write(0xFF23, 0x80);
+  }
+
+  for (int frame = 0; frame < 5; frame++) {
+    advance(silent_memory, silent, 70224);
+    silent.endFrame();
+    advance(heard_memory, heard, 70224);
+    heard.endFrame();
+  }
+  const auto& channels = silent_memory.machine().apu.channels;
+  REQUIRE(memcmp(channels.data(), heard_memory.machine().apu.channels.data(),
+                 sizeof(channels)) == 0);
+  REQUIRE(channels[3].lfsr != 0x7FFF);
+}
+
+TEST_CASE("Synthesis does not change how a ROM runs", "[apu]") {
+  // Spins at the entry point, leaving the sound to the registers below
+  Bytes rom(0x8000, 0);
+  rom[0x100] = 0x18;
+  rom[0x101] = 0xFE;
+  Program program{rom};
+  Window window;
+  CPU silent{window, program};
+  CPU heard{window, program};
+  heard.apu().setSampleRate(48000);
+
+  for (CPU* cpu : {&silent, &heard}) {
+    Memory& memory = cpu->memory();
+    memory.write(0xFF26, 0x80);
+    memory.write(0xFF24, 0x77);
+    memory.write(0xFF25, 0xFF);
+    // Every channel audible, at periods that divide a frame unevenly
+    memory.write(0xFF12, 0xF0);
+    memory.write(0xFF14, 0x87);
+    memory.write(0xFF17, 0xF0);
+    memory.write(0xFF18, 0x00);
+    memory.write(0xFF19, 0x87);
+    memory.write(0xFF1A, 0x80);
+    memory.write(0xFF1C, 0x20);
+    memory.write(0xFF1E, 0x87);
+    memory.write(0xFF21, 0xF0);
+    memory.write(0xFF22, 0x21);
+    memory.write(0xFF23, 0x80);
+  }
+
+  vector<int16_t> samples(4096 * 2);
+  for (int frame = 0; frame < 120; frame++) {
+    silent.cycle();
+    heard.cycle();
+    while (heard.apu().readSamples(samples.data(), 4096) > 0) {
+    }
+    REQUIRE(memcmp(&silent.memory().machine(), &heard.memory().machine(),
+                   sizeof(MachineState)) == 0);
+  }
+}
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <memory>
+
+#include "Arena.h"
+#include "CPU.h"
+#include "Program.h"
+#include "Window.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+bool aligned(const void* block, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(block) % alignment == 0;
+}
+
+}  // namespace
+
+TEST_CASE("Arenas hand out aligned blocks back to back", "[arena]") {
+  const size_t chunk = Arena::chunk_size;
+  Arena arena;
+  REQUIRE(Arena::current() == nullptr);
+
+  SECTION("Only while installed") {
+    void* heap = Arena::allocate(100, 64);
+    REQUIRE(aligned(heap, 64));
+    REQUIRE(arena.used() == 0);
+    {
+      Arena::Scope scope{&arena};
+      REQUIRE(Arena::current() == &arena);
+      void* first = Arena::allocate(100, 64);
+      void* second = Arena::allocate(100, 64);
+      REQUIRE(aligned(first, 64));
+      REQUIRE(aligned(second, 64));
+      REQUIRE(static_cast<char*>(second) - static_cast<char*>(first) == 128);
+      Arena::deallocate(first);
+      Arena::deallocate(second);
+      // Freeing from another arena's scope is fine too
+      Arena::deallocate(heap);
+    }
+    REQUIRE(Arena::current() == nullptr);
+    REQUIRE(arena.used() == 200);
+    REQUIRE(arena.reserved() == chunk);
+  }
+
+  SECTION("Blocks larger than a chunk get one of their own") {
+    Arena::Scope scope{&arena};
+    Arena::allocate(16, 16);
+    Arena::allocate(chunk, 16);
+    REQUIRE(arena.reserved() > 2 * chunk);
+  }
+}
+
+TEST_CASE("Machines are small and live in the arena of their thread",
+          "[arena]") {
+  Program program{"roms/cpu_instrs.gb"};
+  REQUIRE(program.is_valid());
+  Window window;
+
+  Arena arena;
+  unique_ptr<CPU> cpu;
+  {
+    Arena::Scope scope{&arena};
+    cpu.reset(new CPU{window, program});
+  }
+  REQUIRE(arena.used() == sizeof(CPU) + sizeof(MachineState));
+  REQUIRE(aligned(cpu.get(), MachineState::cache_line));
+  REQUIRE(aligned(&cpu->memory().machine(), MachineState::cache_line));
+
+  for (int i = 0; i < 60; i++) {
+    cpu->cycle();
+  }
+  // A DMG machine without sound or tracing, ROM not counted
+  REQUIRE(cpu->footprint() < 64 * 1024);
+
+  unique_ptr<CPU> clone = cpu->clone(window);
+  REQUIRE(clone->footprint() <= cpu->footprint());
+
+  cpu->apu().setSampleRate(48000);
+  REQUIRE(cpu->footprint() > clone->footprint());
+}
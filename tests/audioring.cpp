@@ -0,0 +1,55 @@
+#include "catch.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "AudioRing.h"
+
+using namespace gb;
+using namespace std;
+
+TEST_CASE("The audio ring passes samples between two threads", "[audio]") {
+  SECTION("Writes and reads wrap around the end") {
+    AudioRing ring{5};
+    REQUIRE(ring.capacity() == 8);
+
+    vector<int16_t> in{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    vector<int16_t> out(16, 0);
+    REQUIRE(ring.write(in.data(), 6) == 6);
+    REQUIRE(ring.read(out.data(), 4) == 4);
+    REQUIRE(ring.write(in.data(), 6) == 6);
+    REQUIRE(ring.size() == 8);
+    REQUIRE(ring.write(in.data(), 1) == 0);
+
+    REQUIRE(ring.read(out.data(), 8) == 8);
+    REQUIRE(out == vector<int16_t>{9, 10, 11, 12, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                   10, 11, 12});
+    REQUIRE(ring.read(out.data(), 1) == 0);
+  }
+
+  SECTION("A consumer thread sees every frame in order") {
+    AudioRing ring{256};
+    const int16_t frames = 20000;
+
+    thread consumer{[&ring]() {
+      int16_t expected = 0;
+      int16_t buffer[2 * 64];
+      while (expected < frames) {
+        size_t read = ring.read(buffer, 64);
+        for (size_t i = 0; i < read; i++) {
+          if (buffer[i * 2] != expected || buffer[i * 2 + 1] != -expected) {
+            return;
+          }
+          expected++;
+        }
+      }
+    }};
+
+    for (int16_t frame = 0; frame < frames;) {
+      int16_t sample[2] = {frame, static_cast<int16_t>(-frame)};
+      frame += ring.write(sample, 1);
+    }
+    consumer.join();
+    REQUIRE(ring.size() == 0);
+  }
+}
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "Batch.h"
+#include "Program.h"
+#include "ThreadPool.h"
+
+using namespace gb;
+using namespace std;
+
+TEST_CASE("Thread pool runs nested tasks to completion", "[batch]") {
+  ThreadPool pool{4};
+  atomic<int> count{0};
+
+  function<void(int)> spawn = [&](int depth) {
+    count++;
+    if (depth > 0) {
+      pool.submit([&spawn, depth]() { spawn(depth - 1); });
+      pool.submit([&spawn, depth]() { spawn(depth - 1); });
+    }
+  };
+  pool.submit([&spawn]() { spawn(9); });
+  pool.wait();
+
+  REQUIRE(count == 1023);
+}
+
+TEST_CASE("Batch runs several machines at once", "[batch]") {
+  auto cpu_instrs = make_shared<Program>("roms/cpu_instrs.gb");
+  auto instr_timing = make_shared<Program>("roms/instr_timing.gb");
+  auto mem_timing = make_shared<Program>("roms/mem_timing.gb");
+  REQUIRE(cpu_instrs->is_valid());
+  REQUIRE(instr_timing->is_valid());
+  REQUIRE(mem_timing->is_valid());
+
+  Batch batch{2, 10};
+  Batch::Job until = Batch::Job::runUntilSerial("Passed", "Failed");
+  size_t first = batch.add(cpu_instrs, until);
+  size_t second = batch.add(instr_timing, until);
+  size_t third = batch.add(mem_timing, until);
+  size_t frames = batch.add(cpu_instrs, Batch::Job::runFrames(42));
+  batch.run();
+
+  REQUIRE(batch.result(first).status == Batch::Result::Status::Passed);
+  REQUIRE(batch.result(second).status == Batch::Result::Status::Passed);
+  REQUIRE(batch.result(third).status == Batch::Result::Status::Passed);
+  REQUIRE(batch.result(frames).status == Batch::Result::Status::Done);
+  REQUIRE(batch.result(frames).frames == 42);
+  REQUIRE(batch.result(frames).footprint > 0);
+  REQUIRE(batch.result(frames).footprint < 64 * 1024);
+}
+
+TEST_CASE("Batch runs machines on pinned workers", "[batch]") {
+  auto program = make_shared<Program>("roms/cpu_instrs.gb");
+  REQUIRE(program->is_valid());
+
+  Batch batch{2, 10, true};
+  for (int i = 0; i < 8; i++) {
+    batch.add(program, Batch::Job::runFrames(20));
+  }
+  batch.run();
+  REQUIRE(batch.totalFrames() == 8 * 20);
+}
+
+TEST_CASE("Batch stops failing machines and runs the rest", "[batch]") {
+  ifstream stream{"roms/instr_timing.gb", ios::binary};
+  Bytes rom{istreambuf_iterator<char>(stream), istreambuf_iterator<char>()};
+  auto good = make_shared<Program>(rom);
+  REQUIRE(good->is_valid());
+  // An invalid opcode at the entry point, and an unsupported cartridge
+  Bytes bad = rom;
+  bad[0x100] = 0xD3;
+  auto bad_opcode = make_shared<Program>(bad);
+  bad = rom;
+  bad[0x147] = 0x20;
+  auto bad_mbc = make_shared<Program>(bad);
+
+  Batch batch{2, 10};
+  Batch::Job until = Batch::Job::runUntilSerial("Passed", "Failed");
+  size_t first = batch.add(bad_opcode, until);
+  size_t second = batch.add(good, until);
+  size_t third = batch.add(bad_mbc, until);
+  batch.run();
+
+  REQUIRE(batch.result(first).status == Batch::Result::Status::Error);
+  REQUIRE(batch.result(first).error == "Invalid opcode");
+  REQUIRE(batch.result(second).status == Batch::Result::Status::Passed);
+  REQUIRE(batch.result(third).status == Batch::Result::Status::Error);
+  REQUIRE(batch.result(third).error == "Invalid/Unknown MBC");
+}
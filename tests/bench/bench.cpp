@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "CPU.h"
+#include "Memory.h"
+#include "Program.h"
+#include "Timer.h"
+#include "Window.h"
+#include "support/RomBuilder.h"
+
+namespace po = boost::program_options;
+using namespace gb;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the optimizer from dropping the reads being measured
+volatile int sink = 0;
+
+struct Benchmark {
+  string name;
+  // Runs `ops` operations and returns how many it actually ran
+  std::function<long(long ops)> run;
+};
+
+struct Result {
+  string name;
+  double ns_per_op;
+  long ops;
+};
+
+// Median of five timed runs, each long enough to last `min_seconds`.
+Result measure(const Benchmark& benchmark, double min_seconds) {
+  long ops = 1;
+  while (true) {
+    Clock::time_point start = Clock::now();
+    long ran = benchmark.run(ops);
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    if (elapsed.count() >= min_seconds / 5) {
+      ops = ran;
+      break;
+    }
+    ops *= elapsed.count() > 0 ? std::max(2.0, min_seconds / 5 /
+                                                  elapsed.count())
+                               : 10;
+  }
+
+  vector<double> times;
+  for (int i = 0; i < 5; i++) {
+    Clock::time_point start = Clock::now();
+    benchmark.run(ops);
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    times.push_back(elapsed.count() / ops);
+  }
+  std::sort(times.begin(), times.end());
+  return Result{benchmark.name, times[2], ops};
+}
+
+// Opcodes 0x40 + base * 8 + register for the registers outside of HL
+Bytes registerOps(Byte base, int rows) {
+  const int registers[] = {0, 1, 2, 3, 7};
+  Bytes ops;
+  for (int row = 0; row < rows; row++) {
+    for (int reg : registers) {
+      ops.push_back(base + row * 8 + reg);
+    }
+  }
+  return ops;
+}
+
+Benchmark dispatch(const string& name, const Bytes& pattern) {
+  auto program = stress::loop(pattern);
+  auto window = std::make_shared<Window>();
+  auto cpu = std::make_shared<CPU>(*window, *program);
+  return Benchmark{"dispatch/" + name, [program, window, cpu](long ops) {
+                     for (long i = 0; i < ops; i++) {
+                       cpu->step();
+                     }
+                     return ops;
+                   }};
+}
+
+void addDispatch(vector<Benchmark>& benchmarks) {
+  benchmarks.push_back(dispatch("nop", Bytes{0x00}));
+  // LD r,r' and the ALU between registers
+  Bytes loads;
+  for (Byte dest : {0, 1, 2, 3, 7}) {
+    Bytes row = registerOps(0x40 + dest * 8, 1);
+    loads.insert(loads.end(), row.begin(), row.end());
+  }
+  benchmarks.push_back(dispatch("ld_r_r", loads));
+  benchmarks.push_back(dispatch("alu", registerOps(0x80, 8)));
+  benchmarks.push_back(dispatch("ld_hl", Bytes{0x77, 0x7E}));
+  benchmarks.push_back(dispatch("inc16", Bytes{0x03, 0x13, 0x0B, 0x1B}));
+  Bytes prefixed;
+  for (int op = 0; op < 0x100; op++) {
+    if ((op & 0x07) != 0x06) {
+      prefixed.push_back(0xCB);
+      prefixed.push_back(op);
+    }
+  }
+  benchmarks.push_back(dispatch("cb", prefixed));
+  benchmarks.push_back(dispatch("jr", Bytes{0x18, 0x00}));
+  benchmarks.push_back(dispatch("call_ret", Bytes{0xCD, 0x80, 0x3F}));
+}
+
+void addMemory(vector<Benchmark>& benchmarks) {
+  struct Region {
+    const char* name;
+    Word begin;
+  };
+  const Region regions[] = {{"rom0", 0x0000}, {"romx", 0x4000},
+                            {"vram", 0x8000}, {"cart_ram", 0xA000},
+                            {"wram", 0xC000}, {"oam", 0xFE00},
+                            {"io", 0xFF00},   {"hram", 0xFF80}};
+
+  Bytes rom(0x8000, 0);
+  // MBC1 with 8KB of RAM
+  rom[0x0147] = 0x03;
+  rom[0x0149] = 0x02;
+  auto program = std::make_shared<Program>(rom);
+  auto memory = std::make_shared<Memory>(*program);
+  memory->write(Memory::Register::BootMode, 0x01);
+  memory->write(0x0000, 0x0A);
+
+  for (const Region& region : regions) {
+    Word begin = region.begin;
+    // Skips the I/O registers with side effects on writes
+    int size = begin == 0xFF00 ? 0x10 : begin >= 0xFE00 ? 0x60 : 0x1000;
+    benchmarks.push_back(Benchmark{
+        string{"memory/read/"} + region.name,
+        [program, memory, begin, size](long ops) {
+          int sum = 0;
+          for (long i = 0; i < ops; i++) {
+            sum += memory->read(begin + (i % size));
+          }
+          sink = sum;
+          return ops;
+        }});
+    if (begin < 0x8000) {
+      continue;
+    }
+    benchmarks.push_back(Benchmark{
+        string{"memory/write/"} + region.name,
+        [program, memory, begin, size](long ops) {
+          for (long i = 0; i < ops; i++) {
+            Word address = begin + (i % size);
+            if (address != Memory::Register::SerialTransferControl) {
+              memory->write(address, i & 0xFF);
+            }
+          }
+          return ops;
+        }});
+  }
+}
+
+// A whole frame of the LCD alone, one scanline per operation
+Benchmark lcd(const string& name, Byte lcdc, bool sprites, bool rendering) {
+  Bytes rom(0x8000, 0);
+  auto program = std::make_shared<Program>(rom);
+  auto window = std::make_shared<Window>();
+  auto cpu = std::make_shared<CPU>(*window, *program);
+  Memory& memory = cpu->memory();
+  memory.write(0xFF40, 0x00);
+  for (Word address = 0x8000; address < 0xA000; address++) {
+    memory.write(address, address * 7);
+  }
+  for (int i = 0; i < 40; i++) {
+    // Ten sprites on every line, spread over the screen
+    memory.sat()[i * 4 + 0] = 16 + (i / 10) * 36;
+    memory.sat()[i * 4 + 1] = 8 + (i % 10) * 16;
+    memory.sat()[i * 4 + 2] = i;
+    memory.sat()[i * 4 + 3] = (i & 3) << 5;
+  }
+  memory.write(0xFF4A, 0x20);
+  memory.write(0xFF4B, 0x40);
+  memory.write(0xFF40, sprites ? lcdc | 0x06 : lcdc);
+  cpu->setRendering(rendering);
+
+  return Benchmark{"lcd/" + name, [program, window, cpu](long ops) {
+                     for (long i = 0; i < ops; i++) {
+                       // 456 clocks per line in steps of one M-cycle
+                       for (int clock = 0; clock < 456; clock += 4) {
+                         cpu->lcd().advance(4);
+                       }
+                     }
+                     return ops;
+                   }};
+}
+
+void addLcd(vector<Benchmark>& benchmarks) {
+  benchmarks.push_back(lcd("off", 0x91, false, false));
+  benchmarks.push_back(lcd("bg", 0x91, false, true));
+  benchmarks.push_back(lcd("bg_window", 0xB1, false, true));
+  benchmarks.push_back(lcd("bg_window_sprites", 0xB1, true, true));
+}
+
+void addTimer(vector<Benchmark>& benchmarks) {
+  Bytes rom(0x8000, 0);
+  auto program = std::make_shared<Program>(rom);
+  auto memory = std::make_shared<Memory>(*program);
+  auto timer = std::make_shared<Timer>(*memory);
+  // Enabled at the fastest rate, 16 clocks per increment
+  memory->write(0xFF07, 0x05);
+  benchmarks.push_back(
+      Benchmark{"timer/advance", [program, memory, timer](long ops) {
+                  for (long i = 0; i < ops; i++) {
+                    timer->advance(4);
+                  }
+                  return ops;
+                }});
+}
+
+void addFrames(vector<Benchmark>& benchmarks, const string& roms) {
+  for (const char* name : {"cpu_instrs", "instr_timing", "mem_timing"}) {
+    auto program =
+        std::make_shared<Program>(roms + "/" + string{name} + ".gb");
+    if (!program->is_valid()) {
+      cout << "Skipping missing " << name << endl;
+      continue;
+    }
+    auto window = std::make_shared<Window>();
+    auto cpu = std::make_shared<CPU>(*window, *program);
+    benchmarks.push_back(
+        Benchmark{string{"frame/"} + name, [program, window, cpu](long ops) {
+                    for (long i = 0; i < ops; i++) {
+                      cpu->cycle();
+                    }
+                    return ops;
+                  }});
+  }
+}
+
+// Episode starts: resetting a machine, and building a new one
+void addReset(vector<Benchmark>& benchmarks, const string& roms) {
+  auto program = std::make_shared<Program>(roms + "/cpu_instrs.gb");
+  if (!program->is_valid()) {
+    cout << "Skipping missing cpu_instrs" << endl;
+    return;
+  }
+  auto window = std::make_shared<Window>();
+  auto cpu = std::make_shared<CPU>(*window, *program);
+  benchmarks.push_back(
+      Benchmark{"reset/reset", [program, window, cpu](long ops) {
+                  for (long i = 0; i < ops; i++) {
+                    cpu->reset();
+                  }
+                  return ops;
+                }});
+  benchmarks.push_back(Benchmark{"reset/new", [program, window](long ops) {
+                                   for (long i = 0; i < ops; i++) {
+                                     std::unique_ptr<CPU> cpu{
+                                         new CPU{*window, *program}};
+                                     sink = cpu->registers().pc;
+                                   }
+                                   return ops;
+                                 }});
+}
+
+// Whole frames of the ROMs that stress one subsystem each
+void addStress(vector<Benchmark>& benchmarks) {
+  struct Scenario {
+    const char* name;
+    std::shared_ptr<Program> (*build)();
+  };
+  const Scenario scenarios[] = {{"sprites", stress::sprites},
+                                {"oam_dma", stress::oamDma},
+                                {"timer_interrupt", stress::timerInterrupt},
+                                {"bank_switching", stress::bankSwitching},
+                                {"ly_polling", stress::lyPolling}};
+  for (const Scenario& scenario : scenarios) {
+    auto program = scenario.build();
+    auto window = std::make_shared<Window>();
+    auto cpu = std::make_shared<CPU>(*window, *program);
+    benchmarks.push_back(Benchmark{string{"stress/"} + scenario.name,
+                                   [program, window, cpu](long ops) {
+                                     for (long i = 0; i < ops; i++) {
+                                       cpu->cycle();
+                                     }
+                                     return ops;
+                                   }});
+  }
+}
+
+void writeJson(const string& filename, const vector<Result>& results) {
+  std::ofstream out{filename};
+  out << "{\n  \"compiler\": \"" << __VERSION__ << "\",\n"
+      << "  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    out << "    {\"name\": \"" << results[i].name
+        << "\", \"ns_per_op\": " << results[i].ns_per_op
+        << ", \"ops\": " << results[i].ops << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  po::options_description desc{"Allowed options"};
+  desc.add_options()("help,h", "Show the help message")(
+      "filter", po::value<string>()->default_value(""),
+      "Only run benchmarks whose name contains this")(
+      "json", po::value<string>()->default_value(""),
+      "Write the results to this file, for compare.py")(
+      "min-time", po::value<double>()->default_value(0.5),
+      "Seconds to spend on every benchmark")(
+      "roms", po::value<string>()->default_value("roms"),
+      "Directory of the bundled test ROMs");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+  if (vm.find("help") != vm.end()) {
+    cout << desc << endl;
+    return 1;
+  }
+
+  vector<Benchmark> benchmarks;
+  addDispatch(benchmarks);
+  addMemory(benchmarks);
+  addLcd(benchmarks);
+  addTimer(benchmarks);
+  addStress(benchmarks);
+  addFrames(benchmarks, vm["roms"].as<string>());
+  addReset(benchmarks, vm["roms"].as<string>());
+
+  const string& filter = vm["filter"].as<string>();
+  vector<Result> results;
+  for (const Benchmark& benchmark : benchmarks) {
+    if (benchmark.name.find(filter) == string::npos) {
+      continue;
+    }
+    Result result = measure(benchmark, vm["min-time"].as<double>());
+    cout << result.name << ": " << result.ns_per_op << " ns" << endl;
+    results.push_back(result);
+  }
+
+  if (!vm["json"].as<string>().empty()) {
+    writeJson(vm["json"].as<string>(), results);
+  }
+  return 0;
+}
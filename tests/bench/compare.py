@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Compares two result files of geebee_bench --json.
+
+    compare.py before.json after.json [--threshold 5]
+
+Prints the change of every benchmark in both files and exits with 1 if any
+got slower by more than the threshold in percent.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        return {b["name"]: b["ns_per_op"] for b in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="Percent slowdown reported as a regression")
+    args = parser.parse_args()
+
+    before = load(args.before)
+    after = load(args.after)
+    width = max(len(name) for name in list(before) + list(after))
+
+    regressed = False
+    print("%-*s %12s %12s %8s" % (width, "benchmark", "before ns", "after ns",
+                                  "change"))
+    for name in sorted(set(before) | set(after)):
+        if name not in before or name not in after:
+            print("%-*s %12s %12s" % (width, name,
+                                      before.get(name, "-"),
+                                      after.get(name, "-")))
+            continue
+        change = (after[name] / before[name] - 1) * 100
+        mark = ""
+        if change > args.threshold:
+            mark = " slower"
+            regressed = True
+        elif change < -args.threshold:
+            mark = " faster"
+        print("%-*s %12.2f %12.2f %+7.1f%%%s" % (width, name, before[name],
+                                                after[name], change, mark))
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
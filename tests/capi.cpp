@@ -0,0 +1,146 @@
+#include "catch.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "geebee.h"
+#include "types.h"
+
+using namespace gb;
+using namespace std;
+
+TEST_CASE("Machines can be driven through the C interface", "[capi]") {
+  ifstream stream{"roms/instr_timing.gb", ios::binary};
+  Bytes rom{istreambuf_iterator<char>(stream), istreambuf_iterator<char>()};
+  REQUIRE(rom.size() > 0);
+
+  REQUIRE(gb_abi_version() == GEEBEE_ABI_VERSION);
+  REQUIRE(gb_create(rom.data(), 0x100, nullptr, 0) == nullptr);
+  Bytes bootrom(0x100, 0x00);
+  REQUIRE(gb_create(rom.data(), rom.size(), bootrom.data(), 0x80) == nullptr);
+
+  gb_machine* machine = gb_create(rom.data(), rom.size(), nullptr, 0);
+  REQUIRE(machine != nullptr);
+
+  SECTION("Memory regions point into the machine") {
+    size_t size = 0;
+    REQUIRE(gb_memory(machine, GB_REGION_WRAM, &size) != nullptr);
+    REQUIRE(size == 0x2000);
+    REQUIRE(gb_memory(machine, GB_REGION_HRAM, &size) != nullptr);
+    REQUIRE(gb_memory(machine, GB_REGION_CARTRIDGE_RAM, &size) == nullptr);
+    REQUIRE(size == 0);
+
+    REQUIRE(gb_step_cycles(machine, 100) >= 100);
+    gb_step_frames(machine, 2);
+    const uint8_t* io = gb_memory(machine, GB_REGION_IO, &size);
+    REQUIRE(io[0x44] == 144);
+    REQUIRE(gb_framebuffer(machine) != nullptr);
+  }
+
+  SECTION("States round trip through caller buffers") {
+    gb_step_frames(machine, 10);
+    Bytes state(gb_state_size(machine), 0);
+    REQUIRE(gb_save_state(machine, state.data(), state.size() - 1) == -1);
+    REQUIRE(gb_save_state(machine, state.data(), state.size()) == 0);
+
+    gb_step_frames(machine, 40);
+    size_t size = 0;
+    string serial{gb_serial(machine, &size)};
+    REQUIRE(serial.find("Passed") != string::npos);
+
+    REQUIRE(gb_load_state(machine, state.data(), state.size() / 2) == -1);
+    // The interrupt flag after the ROM hash and the registers, and the LCD
+    // mode near the end
+    Bytes corrupt = state;
+    corrupt[28] = 2;
+    REQUIRE(gb_load_state(machine, corrupt.data(), corrupt.size()) == -1);
+    corrupt = state;
+    corrupt[corrupt.size() - 9] = 4;
+    REQUIRE(gb_load_state(machine, corrupt.data(), corrupt.size()) == -1);
+    // Sound fields that index waveforms, counted in ints from the first of
+    // the four channels of ten fields each, before the LCD
+    size_t apu = state.size() - 10 - 42 * sizeof(int);
+    auto corrupted = [&](int channel, int field, int value) {
+      Bytes bytes = state;
+      memcpy(&bytes[apu + (channel * 10 + field) * sizeof(int)], &value,
+             sizeof(value));
+      return gb_load_state(machine, bytes.data(), bytes.size());
+    };
+    const int volume = 2, timer = 4, position = 5, lfsr = 6;
+    REQUIRE(corrupted(0, position, 8) == -1);
+    REQUIRE(corrupted(2, position, 32) == -1);
+    REQUIRE(corrupted(0, timer, -1) == -1);
+    REQUIRE(corrupted(1, volume, 16) == -1);
+    REQUIRE(corrupted(3, lfsr, 0x8000) == -1);
+    // The sequencer step follows the channels
+    REQUIRE(corrupted(4, 0, 8) == -1);
+    REQUIRE(corrupted(4, 0, 7) == 0);
+
+    // A machine of another ROM, with just as little cartridge RAM
+    ifstream other_stream{"roms/mem_timing.gb", ios::binary};
+    Bytes other_rom{istreambuf_iterator<char>(other_stream),
+                    istreambuf_iterator<char>()};
+    gb_machine* other =
+        gb_create(other_rom.data(), other_rom.size(), nullptr, 0);
+    REQUIRE(other != nullptr);
+    REQUIRE(gb_memory(other, GB_REGION_CARTRIDGE_RAM, &size) == nullptr);
+    REQUIRE(gb_load_state(other, state.data(), state.size()) == -1);
+    gb_destroy(other);
+    REQUIRE(gb_load_state(machine, state.data(), state.size()) == 0);
+    REQUIRE(string{gb_serial(machine, &size)} != serial);
+    gb_step_frames(machine, 40);
+    REQUIRE(string{gb_serial(machine, &size)} == serial);
+  }
+
+  SECTION("Machines of a program share it and outlive the handle") {
+    REQUIRE(gb_program_create(rom.data(), 0x100, nullptr, 0) == nullptr);
+    REQUIRE(gb_create_from_program(nullptr) == nullptr);
+    gb_program* program = gb_program_create(rom.data(), rom.size(), nullptr, 0);
+    REQUIRE(program != nullptr);
+    gb_machine* first = gb_create_from_program(program);
+    gb_machine* second = gb_create_from_program(program);
+    gb_program_destroy(program);
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+
+    gb_step_frames(machine, 50);
+    gb_step_frames(first, 50);
+    gb_step_frames(second, 50);
+    size_t size = 0;
+    string serial{gb_serial(machine, &size)};
+    REQUIRE(serial.find("Passed") != string::npos);
+    REQUIRE(string{gb_serial(first, &size)} == serial);
+    REQUIRE(string{gb_serial(second, &size)} == serial);
+
+    gb_destroy(first);
+    gb_destroy(second);
+  }
+
+  gb_destroy(machine);
+}
+
+TEST_CASE("Errors halt machines instead of leaving the C interface",
+          "[capi]") {
+  ifstream stream{"roms/instr_timing.gb", ios::binary};
+  Bytes rom{istreambuf_iterator<char>(stream), istreambuf_iterator<char>()};
+  REQUIRE(rom.size() > 0);
+  // An invalid opcode at the entry point
+  rom[0x100] = 0xD3;
+
+  gb_machine* machine = gb_create(rom.data(), rom.size(), nullptr, 0);
+  REQUIRE(machine != nullptr);
+  REQUIRE(gb_halted(machine) == 0);
+
+  gb_step_frames(machine, 1);
+  REQUIRE(gb_halted(machine) == 1);
+  REQUIRE(gb_step_cycles(machine, 100) == 0);
+
+  gb_reset(machine);
+  REQUIRE(gb_halted(machine) == 0);
+  REQUIRE(gb_step_cycles(machine, 100) < 100);
+  REQUIRE(gb_halted(machine) == 1);
+
+  gb_destroy(machine);
+}
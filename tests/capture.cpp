@@ -0,0 +1,80 @@
+#include "catch.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "Batch.h"
+#include "Capture.h"
+#include "Program.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+string contents(const fs::path& path) {
+  ifstream file{path.string(), ios::binary};
+  return string{istreambuf_iterator<char>{file}, istreambuf_iterator<char>{}};
+}
+
+uint32_t little(const string& data, size_t offset) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; i--) {
+    value = (value << 8) | static_cast<Byte>(data[offset + i]);
+  }
+  return value;
+}
+
+}  // namespace
+
+TEST_CASE("Headless runs are recorded to video and sound files",
+          "[capture]") {
+  auto program = make_shared<Program>("roms/cpu_instrs.gb");
+  REQUIRE(program->is_valid());
+  fs::path video = fs::temp_directory_path() / fs::unique_path("%%%%.y4m");
+  fs::path audio = fs::temp_directory_path() / fs::unique_path("%%%%.wav");
+
+  Capture::Options options;
+  options.video = video.string();
+  options.audio = audio.string();
+  options.every = 3;
+  options.queue = 4;
+  Capture capture{options};
+  REQUIRE(capture.is_valid());
+  REQUIRE(capture.sampleRate() == 48000);
+
+  Batch batch{1};
+  batch.add(program, Batch::Job::runFrames(60), &capture);
+  batch.run();
+  capture.finish();
+  REQUIRE(capture.videoFrames() == 20);
+
+  SECTION("Video is Y4M with one luma frame per captured frame") {
+    string data = contents(video);
+    string header = "YUV4MPEG2 W160 H144 F4194304:210672 Ip A1:1 C420jpeg\n";
+    REQUIRE(data.compare(0, header.size(), header) == 0);
+    size_t frame = 6 + 160 * 144 * 3 / 2;
+    REQUIRE(data.size() == header.size() + 20 * frame);
+    REQUIRE(data.compare(header.size(), 6, "FRAME\n") == 0);
+  }
+
+  SECTION("Sound is a complete 16 bit stereo WAV file") {
+    string data = contents(audio);
+    REQUIRE(data.compare(0, 4, "RIFF") == 0);
+    REQUIRE(little(data, 24) == 48000);
+    REQUIRE(little(data, 40) == capture.audioSamples() * 4);
+    size_t samples = static_cast<size_t>(capture.audioSamples());
+    REQUIRE(data.size() == 44 + samples * 4);
+    // A second of sound, give or take the block synthesis latency
+    REQUIRE(capture.audioSamples() > 47000);
+    REQUIRE(capture.audioSamples() < 49000);
+  }
+
+  fs::remove(video);
+  fs::remove(audio);
+}
@@ -0,0 +1,55 @@
+#include "catch.hpp"
+
+#include "Memory.h"
+#include "Program.h"
+
+using namespace gb;
+using namespace std;
+
+TEST_CASE("OAM DMA copies a page and holds the bus", "[dma]") {
+  Bytes rom(0x8000, 0);
+  for (int i = 0; i < 0xA0; i++) {
+    rom[0x4100 + i] = 0xA0 - i;
+  }
+  Program program{rom};
+  Memory memory{program};
+  memory.write(Memory::Register::BootMode, 0x01);
+
+  SECTION("From work RAM") {
+    for (Word i = 0; i < 0xA0; i++) {
+      memory.write(0xC200 + i, i);
+    }
+    memory.startDma(0xC2);
+    REQUIRE(memory.sat()[0x00] == 0x00);
+    REQUIRE(memory.sat()[0x9F] == 0x9F);
+  }
+
+  SECTION("From banked ROM") {
+    memory.startDma(0x41);
+    REQUIRE(memory.sat()[0x00] == 0xA0);
+    REQUIRE(memory.sat()[0x9F] == 0x01);
+  }
+
+  SECTION("The CPU only reaches HRAM and I/O during the transfer") {
+    memory.write(0xC000, 0x12);
+    memory.write(0xFF80, 0x34);
+    memory.startDma(0xC0);
+
+    REQUIRE(memory.read(0xC000) == 0xFF);
+    REQUIRE(memory.peek(0xC000) == 0x12);
+    REQUIRE(memory.read(0xFF80) == 0x34);
+    // Dropped writes leave no trace in the write hash either
+    memory.setWriteHashing(true);
+    uint64_t hash = memory.writeHash();
+    memory.write(0xC000, 0x56);
+    REQUIRE(memory.writeHash() == hash);
+    memory.write(0xFF81, 0x78);
+    REQUIRE(memory.read(0xFF81) == 0x78);
+
+    memory.advance(159 * 4);
+    REQUIRE(memory.dma());
+    memory.advance(4);
+    REQUIRE_FALSE(memory.dma());
+    REQUIRE(memory.read(0xC000) == 0x12);
+  }
+}
@@ -0,0 +1,21 @@
+# Fails unless every dynamic symbol LIBRARY defines is part of the C
+# interface. Run with cmake -DNM=nm -DLIBRARY=libgeebee.so -P exports.cmake
+execute_process(COMMAND ${NM} -D --defined-only ${LIBRARY}
+                OUTPUT_VARIABLE SYMBOLS RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL 0)
+  message(FATAL_ERROR "Can't list the symbols of ${LIBRARY}")
+endif()
+
+string(REPLACE "\n" ";" SYMBOLS "${SYMBOLS}")
+set(EXPORTED 0)
+foreach(LINE ${SYMBOLS})
+  string(REGEX REPLACE "^.* " "" SYMBOL "${LINE}")
+  if(NOT SYMBOL MATCHES "^gb_")
+    message(FATAL_ERROR "${LIBRARY} exports ${SYMBOL}")
+  endif()
+  math(EXPR EXPORTED "${EXPORTED} + 1")
+endforeach()
+if(NOT SYMBOLS MATCHES "gb_create")
+  message(FATAL_ERROR "${LIBRARY} does not export the C interface")
+endif()
+message(STATUS "${LIBRARY} exports ${EXPORTED} symbols")
@@ -0,0 +1,72 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <string>
+
+#include "Batch.h"
+#include "FrameHashes.h"
+#include "Program.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+Batch::Job hashedFrames(long frames, bool states) {
+  Batch::Job job = Batch::Job::runFrames(frames);
+  job.hash_frames = true;
+  job.hash_states = states;
+  return job;
+}
+
+}  // namespace
+
+TEST_CASE("Test ROMs render the golden frames", "[framehashes]") {
+  Batch batch{2};
+  vector<string> names{"cpu_instrs", "instr_timing", "mem_timing"};
+  for (const string& name : names) {
+    auto program = make_shared<Program>("roms/" + name + ".gb");
+    REQUIRE(program->is_valid());
+    batch.add(program, hashedFrames(300, false));
+  }
+  batch.run();
+
+  for (size_t i = 0; i < names.size(); i++) {
+    FrameHashes golden{"golden/" + names[i] + ".hashes"};
+    REQUIRE(golden.size() == 300);
+    INFO(names[i]);
+    REQUIRE(batch.result(i).hashes.firstDivergence(golden) == -1);
+  }
+}
+
+TEST_CASE("Frame hashes find the first divergent frame", "[framehashes]") {
+  auto program = make_shared<Program>("roms/cpu_instrs.gb");
+  REQUIRE(program->is_valid());
+
+  Batch batch{1};
+  size_t first = batch.add(program, hashedFrames(60, true));
+  size_t second = batch.add(program, hashedFrames(60, true));
+  batch.run();
+  const FrameHashes& hashes = batch.result(first).hashes;
+  REQUIRE(hashes.size() == 60);
+  REQUIRE(hashes[59].state != 0);
+  REQUIRE(hashes.firstDivergence(batch.result(second).hashes) == -1);
+
+  SECTION("A changed state is found even if the frame matches") {
+    FrameHashes changed;
+    for (size_t i = 0; i < hashes.size(); i++) {
+      FrameHashes::Entry entry = hashes[i];
+      if (i >= 42) {
+        entry.state++;
+      }
+      changed.add(entry);
+    }
+    REQUIRE(changed.firstDivergence(hashes) == 42);
+  }
+
+  SECTION("Frames missing from a shorter run count as divergent") {
+    FrameHashes shorter;
+    shorter.add(hashes[0]);
+    REQUIRE(shorter.firstDivergence(hashes) == 1);
+  }
+}
@@ -0,0 +1,74 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <string>
+
+#include "CPU.h"
+#include "Lockstep.h"
+#include "Program.h"
+#include "Window.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+// Lets `reference` run into the test before candidates are split off
+void warmUp(CPU& reference) {
+  for (int i = 0; i < 30; i++) {
+    reference.cycle();
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Clones and snapshots run in lockstep with the original",
+          "[lockstep]") {
+  for (string name : {"cpu_instrs", "instr_timing", "mem_timing"}) {
+    INFO(name);
+    Program program{"roms/" + name + ".gb"};
+    REQUIRE(program.is_valid());
+    Window window;
+
+    // A clone that doesn't render, compared after every instruction
+    CPU reference{window, program};
+    warmUp(reference);
+    unique_ptr<CPU> clone = reference.clone(window);
+    clone->setRendering(false);
+    Lockstep lockstep{reference, *clone};
+    lockstep.run(500000);
+    INFO(lockstep.divergence());
+    REQUIRE_FALSE(lockstep.diverged());
+
+    // A machine restored from a snapshot, compared in blocks
+    CPU original{window, program};
+    warmUp(original);
+    CPU::State state;
+    original.save(state);
+    CPU restored{window, program};
+    restored.load(state);
+    Lockstep blocks{original, restored, 64};
+    blocks.run(500000);
+    INFO(blocks.divergence());
+    REQUIRE_FALSE(blocks.diverged());
+    // The last block is cut short, 500000 is no multiple of 64
+    REQUIRE(blocks.instructions() == 500000);
+  }
+}
+
+TEST_CASE("Lockstep reports the first divergence", "[lockstep]") {
+  Program program{"roms/cpu_instrs.gb"};
+  REQUIRE(program.is_valid());
+  Window window;
+  CPU reference{window, program};
+  reference.cycle();
+  unique_ptr<CPU> clone = reference.clone(window);
+
+  Lockstep lockstep{reference, *clone};
+  REQUIRE(lockstep.run(1000));
+  clone->memory().write(0xC000, reference.memory().read(0xC000) ^ 0xFF);
+  REQUIRE_FALSE(lockstep.run(1000));
+  REQUIRE(lockstep.instructions() == 1001);
+  REQUIRE(lockstep.divergence().find("write hash") != string::npos);
+  REQUIRE(lockstep.divergence().find("memory c000") != string::npos);
+}
@@ -0,0 +1,129 @@
+#include "catch.hpp"
+
+#include "MBC.h"
+#include "Program.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+// Every bank starts with its own number, low byte first
+Program cartridge(Byte type, int banks, Byte ram_size = 0x00) {
+  Bytes rom(banks * 0x4000, 0);
+  for (int bank = 0; bank < banks; bank++) {
+    rom[bank * 0x4000] = bank & 0xFF;
+    rom[bank * 0x4000 + 1] = bank >> 8;
+  }
+  rom[0x0147] = type;
+  rom[0x0149] = ram_size;
+  return Program{rom};
+}
+
+int bankAt(const MBC& mbc, Word address) {
+  return mbc.read(address) | (mbc.read(address + 1) << 8);
+}
+
+}  // namespace
+
+TEST_CASE("Memory bank controllers map ROM and RAM banks", "[mbc]") {
+  SECTION("MBC1 skips bank 0 and uses the upper bits in both modes") {
+    Program program = cartridge(0x03, 128, 0x03);
+    MBC mbc{program};
+    REQUIRE(bankAt(mbc, 0x4000) == 1);
+
+    mbc.write(0x2000, 0x00);
+    REQUIRE(bankAt(mbc, 0x4000) == 1);
+    mbc.write(0x2000, 0x05);
+    REQUIRE(bankAt(mbc, 0x4000) == 5);
+
+    mbc.write(0x2000, 0x00);
+    mbc.write(0x4000, 0x01);
+    REQUIRE(bankAt(mbc, 0x4000) == 0x21);
+    REQUIRE(bankAt(mbc, 0x0000) == 0);
+
+    mbc.write(0x6000, 0x01);
+    REQUIRE(bankAt(mbc, 0x0000) == 0x20);
+
+    mbc.write(0x0000, 0x0A);
+    mbc.write(0xA000, 0x11);
+    mbc.write(0x4000, 0x02);
+    mbc.write(0xA000, 0x22);
+    REQUIRE(mbc.read(0xA000) == 0x22);
+    mbc.write(0x4000, 0x01);
+    REQUIRE(mbc.read(0xA000) == 0x11);
+    REQUIRE(mbc.ram()[0x2000] == 0x11);
+
+    mbc.write(0x0000, 0x00);
+    REQUIRE(mbc.read(0xA000) == 0xFF);
+  }
+
+  SECTION("MBC2 has half byte RAM and selects with address bit 8") {
+    Program program = cartridge(0x06, 16);
+    MBC mbc{program};
+    mbc.write(0x2100, 0x07);
+    REQUIRE(bankAt(mbc, 0x4000) == 7);
+
+    mbc.write(0xA000, 0xAB);
+    REQUIRE(mbc.read(0xA000) == 0xFF);
+    mbc.write(0x2000, 0x0A);
+    REQUIRE(bankAt(mbc, 0x4000) == 7);
+    mbc.write(0xA000, 0xAB);
+    REQUIRE(mbc.read(0xA000) == 0xFB);
+    REQUIRE(mbc.read(0xA200) == 0xFB);
+  }
+
+  SECTION("MBC3 uses 7 bit ROM banks") {
+    Program program = cartridge(0x13, 128, 0x03);
+    MBC mbc{program};
+    mbc.write(0x2000, 0x7F);
+    REQUIRE(bankAt(mbc, 0x4000) == 0x7F);
+    mbc.write(0x2000, 0x00);
+    REQUIRE(bankAt(mbc, 0x4000) == 1);
+
+    mbc.write(0x0000, 0x0A);
+    mbc.write(0x4000, 0x03);
+    mbc.write(0xA000, 0x33);
+    REQUIRE(mbc.ram()[0x6000] == 0x33);
+  }
+
+  SECTION("MBC5 uses 9 bit ROM banks including bank 0") {
+    Program program = cartridge(0x19, 512);
+    MBC mbc{program};
+    mbc.write(0x2000, 0x00);
+    REQUIRE(bankAt(mbc, 0x4000) == 0);
+    mbc.write(0x2000, 0x23);
+    mbc.write(0x3000, 0x01);
+    REQUIRE(bankAt(mbc, 0x4000) == 0x123);
+
+    MBC::State state;
+    mbc.save(state);
+    MBC other{program};
+    other.load(state);
+    REQUIRE(bankAt(other, 0x4000) == 0x123);
+  }
+
+  SECTION("MBC5 rumble carts drive the motor with RAM bank bit 3") {
+    Program program = cartridge(0x1E, 4, 0x03);
+    MBC mbc{program};
+    REQUIRE_FALSE(mbc.rumble());
+    mbc.write(0x4000, 0x09);
+    REQUIRE(mbc.rumble());
+
+    mbc.write(0x0000, 0x0A);
+    mbc.write(0xA000, 0x44);
+    REQUIRE(mbc.ram()[0x2000] == 0x44);
+  }
+
+  SECTION("Banks past the end wrap and short ROMs are padded") {
+    Program program = cartridge(0x01, 4);
+    MBC mbc{program};
+    mbc.write(0x2000, 0x06);
+    REQUIRE(bankAt(mbc, 0x4000) == 2);
+
+    Program tiny{Bytes(0x0150, 0)};
+    MBC padded{tiny};
+    REQUIRE(padded.read(0x3FFF) == 0xFF);
+    REQUIRE(padded.read(0x7FFF) == 0xFF);
+  }
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "CPU.h"
+#include "Profiler.h"
+#include "Program.h"
+#include "Window.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+TEST_CASE("Profiler attributes every cycle", "[profiler]") {
+  Program program{"roms/cpu_instrs.gb"};
+  REQUIRE(program.is_valid());
+  Window window;
+  CPU cpu{window, program};
+  Profiler profiler{program};
+
+  fs::path symbols = fs::temp_directory_path() / fs::unique_path();
+  {
+    ofstream file{symbols.string()};
+    file << "; File generated by rgblink\n"
+         << "00:0200 Start\n"
+         << "00:0213 Loop\n"
+         << "00:0213 Loop.inner\n"
+         << "01:4000 Banked\n";
+  }
+  REQUIRE(profiler.loadSymbols(symbols.string()));
+  REQUIRE(profiler.symbols() == 3);
+  fs::remove(symbols);
+
+  uint64_t start = cpu.memory().cycles();
+  for (int i = 0; i < 60; i++) {
+    profiler.cycle(cpu);
+  }
+  REQUIRE(profiler.cycles() == cpu.memory().cycles() - start);
+
+  SECTION("Addresses and opcodes add up to the total") {
+    uint64_t instructions = 0;
+    int banks = static_cast<int>(program.rom().size() / 0x4000);
+    for (int bank = 0; bank < banks; bank++) {
+      for (int offset = 0; offset < 0x4000; offset++) {
+        instructions += profiler.at(bank, 0x4000 + offset).instructions;
+      }
+    }
+    for (int address = 0x8000; address < 0x10000; address++) {
+      instructions += profiler.at(0, address).instructions;
+    }
+    REQUIRE(instructions == profiler.instructions());
+
+    uint64_t by_opcode = 0;
+    for (int op = 0; op < 0x100; op++) {
+      if (op != 0xCB) {
+        by_opcode += profiler.opcode(op).instructions;
+      }
+      by_opcode += profiler.opcode(0xCB, op).instructions;
+    }
+    REQUIRE(by_opcode == profiler.instructions());
+  }
+
+  SECTION("Symbols name the code at and after them") {
+    REQUIRE(profiler.name(0, 0x0213) == "Loop");
+    REQUIRE(profiler.name(0, 0x0215) == "Loop+2");
+    REQUIRE(profiler.name(1, 0x4001) == "Banked+1");
+    REQUIRE(profiler.name(2, 0x4001) == "02:4001");
+
+    ostringstream report;
+    profiler.writeReport(report);
+    REQUIRE(report.str().find("Loop") != string::npos);
+  }
+
+  SECTION("Collapsed stacks hold every cycle once") {
+    ostringstream collapsed;
+    profiler.writeCollapsed(collapsed);
+    istringstream lines{collapsed.str()};
+    string stack;
+    uint64_t cycles = 0;
+    uint64_t total = 0;
+    while (lines >> stack >> cycles) {
+      REQUIRE(stack.compare(0, 6, "(root)") == 0);
+      total += cycles;
+    }
+    REQUIRE(total == profiler.cycles());
+  }
+}
+
+TEST_CASE("Profiler tells instructions from interrupt dispatches",
+          "[profiler]") {
+  // ADD SP,-2 and a jump back to it, which drop SP like a dispatch does
+  Bytes rom(0x8000, 0);
+  rom[0x100] = 0xE8;
+  rom[0x101] = 0xFE;
+  rom[0x102] = 0x18;
+  rom[0x103] = 0xFC;
+  Program program{rom};
+  Window window;
+  CPU cpu{window, program};
+  Profiler profiler{program};
+
+  for (int i = 0; i < 100; i++) {
+    profiler.step(cpu);
+  }
+  REQUIRE(profiler.instructions() == 100);
+  REQUIRE(profiler.opcode(0xE8).instructions == 50);
+  REQUIRE(profiler.at(0, 0x100).instructions == 50);
+}
@@ -0,0 +1,42 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "Program.h"
+#include "RomCache.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+TEST_CASE("ROMs are mapped once and shared", "[rom]") {
+  SECTION("Programs of the same file share one mapping") {
+    Program first{"roms/cpu_instrs.gb"};
+    Program second{"roms/cpu_instrs.gb"};
+
+    REQUIRE(first.rom().mapped());
+    REQUIRE(&first.rom() == &second.rom());
+    REQUIRE(first.title() == second.title());
+  }
+
+  SECTION("Copies of a file share one mapping") {
+    fs::path copy = fs::temp_directory_path() / fs::unique_path();
+    fs::copy_file("roms/instr_timing.gb", copy);
+    {
+      Program original{"roms/instr_timing.gb"};
+      Program duplicate{copy.string()};
+      REQUIRE(&original.rom() == &duplicate.rom());
+    }
+    fs::remove(copy);
+  }
+
+  SECTION("Missing and truncated files are invalid") {
+    Program missing{"roms/missing.gb"};
+    REQUIRE_FALSE(missing.is_valid());
+
+    Program truncated{Bytes(0x100, 0)};
+    REQUIRE_FALSE(truncated.is_valid());
+  }
+}
@@ -0,0 +1,60 @@
+#include "catch.hpp"
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include "RomIndex.h"
+#include "hash.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+TEST_CASE("ROM collections can be indexed", "[romindex]") {
+  fs::path root = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(root / "nested");
+  fs::copy_file("roms/cpu_instrs.gb", root / "cpu_instrs.gb");
+  fs::copy_file("roms/instr_timing.gb", root / "nested" / "instr_timing.gb");
+  fs::copy_file("roms/mem_timing.gb", root / "nested" / "mem_timing.gb");
+  fs::copy_file("roms/mem_timing.gb", root / "nested" / "notes.txt");
+  string filename = (root / "geebee.index").string();
+
+  {
+    RomIndex index{filename, 2};
+    RomIndex::Stats stats = index.scan({root.string()});
+    REQUIRE(stats.indexed == 3);
+    REQUIRE(index.size() == 3);
+    REQUIRE(index.save());
+
+    RomIndex::Entry entry;
+    REQUIRE(index.find((root / "nested" / "instr_timing.gb").string(), entry));
+    REQUIRE(entry.header.checksum_valid);
+    REQUIRE(entry.header.type == 0x01);
+    REQUIRE(entry.mbc == 1);
+    REQUIRE(entry.hashed);
+    REQUIRE(index.findHash(entry.hash).size() == 1);
+  }
+
+  SECTION("Unchanged files are skipped on the next scan") {
+    RomIndex index{filename, 2};
+    REQUIRE(index.size() == 3);
+
+    fs::remove(root / "cpu_instrs.gb");
+    RomIndex::Stats stats = index.scan({root.string()});
+    REQUIRE(stats.indexed == 0);
+    REQUIRE(stats.unchanged == 2);
+    REQUIRE(stats.removed == 1);
+    REQUIRE(index.size() == 2);
+  }
+
+  SECTION("Links back up the tree are not followed") {
+    fs::create_directory_symlink(root, root / "nested" / "up");
+    RomIndex index{filename, 2};
+    RomIndex::Stats stats = index.scan({root.string()});
+    REQUIRE(stats.unchanged == 3);
+    REQUIRE(index.size() == 3);
+  }
+
+  fs::remove_all(root);
+}
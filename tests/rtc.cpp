@@ -0,0 +1,103 @@
+#include "catch.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include "MBC.h"
+#include "Program.h"
+#include "RTC.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+const uint64_t second = RTC::cycles_per_second;
+
+Byte latched(RTC& rtc, Byte select, uint64_t now) {
+  rtc.latch(0x00, now);
+  rtc.latch(0x01, now);
+  return rtc.read(select);
+}
+
+}  // namespace
+
+TEST_CASE("The MBC3 clock counts emulated cycles", "[rtc]") {
+  RTC rtc;
+
+  SECTION("Time advances in whole seconds from the cycle count") {
+    REQUIRE(latched(rtc, 0x08, second - 1) == 0);
+    REQUIRE(latched(rtc, 0x08, second) == 1);
+
+    uint64_t now = second * (3 * 86400 + 2 * 3600 + 61);
+    REQUIRE(latched(rtc, 0x08, now) == 1);
+    REQUIRE(rtc.read(0x09) == 1);
+    REQUIRE(rtc.read(0x0A) == 2);
+    REQUIRE(rtc.read(0x0B) == 3);
+  }
+
+  SECTION("Reads return the latched time") {
+    REQUIRE(latched(rtc, 0x08, 5 * second) == 5);
+    rtc.advance(9 * second);
+    REQUIRE(rtc.read(0x08) == 5);
+    rtc.latch(0x01, 9 * second);
+    REQUIRE(rtc.read(0x08) == 5);
+  }
+
+  SECTION("The halt flag stops the clock") {
+    rtc.write(0x0C, 0x40, 0);
+    REQUIRE(latched(rtc, 0x08, 100 * second) == 0);
+    rtc.write(0x0C, 0x00, 100 * second);
+    REQUIRE(latched(rtc, 0x08, 102 * second) == 2);
+  }
+
+  SECTION("Days carry past 511") {
+    rtc.write(0x0B, 0xFF, 0);
+    rtc.write(0x0C, 0x01, 0);
+    rtc.write(0x0A, 23, 0);
+    rtc.write(0x09, 59, 0);
+    rtc.write(0x08, 59, 0);
+    REQUIRE(latched(rtc, 0x0C, second) == 0x80);
+    REQUIRE(rtc.read(0x0B) == 0);
+  }
+
+  SECTION("Out of range seconds wrap without carrying") {
+    rtc.write(0x08, 62, 0);
+    REQUIRE(latched(rtc, 0x08, 2 * second) == 0);
+    REQUIRE(rtc.read(0x09) == 0);
+  }
+}
+
+TEST_CASE("The MBC3 clock is kept in the save file footer", "[rtc]") {
+  Bytes rom(0x8000, 0);
+  rom[0x0147] = 0x10;
+  rom[0x0149] = 0x02;
+  Program program{rom};
+  fs::path path = fs::temp_directory_path() / fs::unique_path();
+  uint64_t cycles = 0;
+
+  {
+    MBC mbc{program};
+    mbc.setClock(&cycles);
+    REQUIRE(mbc.attachSaveFile(path.string()));
+    mbc.write(0x0000, 0x0A);
+    mbc.write(0x4000, 0x09);
+    mbc.write(0xA000, 42);
+    cycles = 5 * second;
+  }
+  REQUIRE(fs::file_size(path) == 0x2000 + RTC::footer_size);
+
+  cycles = 0;
+  MBC mbc{program};
+  mbc.setClock(&cycles);
+  REQUIRE(mbc.attachSaveFile(path.string()));
+  mbc.write(0x0000, 0x0A);
+  mbc.write(0x4000, 0x08);
+  mbc.write(0x6000, 0x00);
+  mbc.write(0x6000, 0x01);
+  REQUIRE(mbc.read(0xA000) == 5);
+  mbc.write(0x4000, 0x09);
+  REQUIRE(mbc.read(0xA000) == 42);
+
+  fs::remove(path);
+}
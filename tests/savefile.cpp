@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include "MBC.h"
+#include "Program.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+// An MBC1+RAM+BATTERY cartridge with 8KB of RAM
+Program batteryProgram() {
+  Bytes rom(0x8000, 0);
+  rom[0x0147] = 0x03;
+  rom[0x0149] = 0x02;
+  return Program{rom};
+}
+
+}  // namespace
+
+TEST_CASE("Battery RAM is persisted to a save file", "[savefile]") {
+  Program program = batteryProgram();
+  fs::path path = fs::temp_directory_path() / fs::unique_path();
+
+  SECTION("Writes survive a new session") {
+    {
+      MBC mbc{program};
+      REQUIRE(mbc.attachSaveFile(path.string()));
+      mbc.write(0x0000, 0x0A);
+      mbc.write(0xA000, 0x12);
+      mbc.write(0xBFFF, 0x34);
+      mbc.write(0x0000, 0x00);
+    }
+    REQUIRE(fs::file_size(path) == 0x2000);
+
+    MBC mbc{program};
+    REQUIRE(mbc.attachSaveFile(path.string()));
+    mbc.write(0x0000, 0x0A);
+    REQUIRE(mbc.read(0xA000) == 0x12);
+    REQUIRE(mbc.read(0xBFFF) == 0x34);
+  }
+
+  SECTION("Only dirty pages are flushed") {
+    MBC mbc{program};
+    REQUIRE(mbc.attachSaveFile(path.string()));
+    mbc.write(0x0000, 0x0A);
+    for (Word address = 0xA100; address < 0xA300; address++) {
+      mbc.write(address, 0xFF);
+    }
+    mbc.write(0xB000, 0x01);
+
+    SaveFile* file = mbc.saveFile();
+    file->flush();
+    REQUIRE(file->flushedPages() == 3);
+  }
+
+  SECTION("Copies and snapshots don't write to the file") {
+    MBC mbc{program};
+    REQUIRE(mbc.attachSaveFile(path.string()));
+    mbc.write(0x0000, 0x0A);
+    mbc.write(0xA000, 0x01);
+
+    MBC::State state;
+    mbc.save(state);
+    MBC copy{mbc};
+    REQUIRE(copy.saveFile() == nullptr);
+    copy.write(0xA000, 0x02);
+    REQUIRE(mbc.read(0xA000) == 0x01);
+
+    mbc.write(0xA000, 0x03);
+    mbc.load(state);
+    REQUIRE(mbc.read(0xA000) == 0x01);
+    REQUIRE(state.ram[0] == 0x01);
+  }
+
+  SECTION("Cartridges without a battery have no save file") {
+    Bytes rom(0x8000, 0);
+    rom[0x0147] = 0x02;
+    rom[0x0149] = 0x02;
+    Program volatile_ram{rom};
+    MBC mbc{volatile_ram};
+    REQUIRE_FALSE(mbc.attachSaveFile(path.string()));
+  }
+
+  fs::remove(path);
+}
@@ -0,0 +1,152 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "CPU.h"
+#include "Program.h"
+#include "RunAhead.h"
+#include "Window.h"
+
+using namespace gb;
+using namespace std;
+
+TEST_CASE("Machine state can be saved and restored", "[state]") {
+  Window window;
+  Program program{"roms/cpu_instrs.gb"};
+  REQUIRE(program.rom().size() > 0);
+
+  CPU cpu{window, program};
+  for (int i = 0; i < 30; i++) {
+    cpu.cycle();
+  }
+
+  SECTION("Restoring a snapshot replays the same execution") {
+    CPU::State state;
+    cpu.save(state);
+
+    for (int i = 0; i < 60; i++) {
+      cpu.cycle();
+    }
+    string serial = cpu.memory().serial_data();
+    auto ram = cpu.memory().ram();
+
+    cpu.load(state);
+    for (int i = 0; i < 60; i++) {
+      cpu.cycle();
+    }
+    REQUIRE(cpu.memory().serial_data() == serial);
+    REQUIRE(cpu.memory().ram() == ram);
+  }
+
+  SECTION("Running ahead does not change the emulated result") {
+    RunAhead runahead{cpu, 2};
+    const string& data = cpu.memory().serial_data();
+    while (data.find("Passed") == string::npos &&
+           data.find("Failed") == string::npos) {
+      runahead.cycle();
+    }
+
+    REQUIRE(data.find("Passed") != string::npos);
+    REQUIRE(runahead.aheadCost() > 0.0);
+  }
+}
+
+TEST_CASE("Machines can be cloned", "[state]") {
+  Window window;
+  Program program{"roms/cpu_instrs.gb"};
+  REQUIRE(program.rom().size() > 0);
+
+  CPU cpu{window, program};
+  for (int i = 0; i < 30; i++) {
+    cpu.cycle();
+  }
+
+  unique_ptr<CPU> clone = cpu.clone(window);
+
+  SECTION("Clones get a copy of the state block") {
+    REQUIRE(&clone->memory().machine() != &cpu.memory().machine());
+    REQUIRE(clone->memory().ram() == cpu.memory().ram());
+    REQUIRE(clone->memory().vram() == cpu.memory().vram());
+    REQUIRE(clone->registers().pc == cpu.registers().pc);
+
+    Byte byte = cpu.memory().read(0xC000);
+    clone->memory().write(0xC000, ~byte);
+    REQUIRE(cpu.memory().read(0xC000) == byte);
+  }
+
+  SECTION("Clones run independently on other threads") {
+    auto run_until_done = [](CPU& cpu) {
+      const string& data = cpu.memory().serial_data();
+      while (data.find("Passed") == string::npos &&
+             data.find("Failed") == string::npos) {
+        cpu.cycle();
+      }
+    };
+
+    thread worker{[&]() { run_until_done(*clone); }};
+    run_until_done(cpu);
+    worker.join();
+
+    REQUIRE(cpu.memory().serial_data().find("Passed") != string::npos);
+    REQUIRE(clone->memory().serial_data() == cpu.memory().serial_data());
+  }
+}
+
+TEST_CASE("Machines start from the state their program boots into",
+          "[state]") {
+  Window window;
+
+  SECTION("Without a boot ROM") {
+    Program program{"roms/cpu_instrs.gb"};
+    CPU cpu{window, program};
+    REQUIRE(cpu.registers().pc == 0x0100);
+    REQUIRE(cpu.memory().read(0xFF40) == 0x91);
+
+    CPU::State fresh;
+    cpu.save(fresh);
+    for (int i = 0; i < 30; i++) {
+      cpu.cycle();
+    }
+    REQUIRE_FALSE(cpu.memory().serial_data().empty());
+    // Enable RAM, switch to banking mode 1 and map other banks
+    cpu.memory().write(0x0000, 0x0A);
+    cpu.memory().write(0x2000, 0x03);
+    cpu.memory().write(0x4000, 0x01);
+    cpu.memory().write(0x6000, 0x01);
+
+    cpu.reset();
+    CPU::State reset;
+    cpu.save(reset);
+    REQUIRE(memcmp(&reset.machine, &fresh.machine, sizeof(MachineState)) == 0);
+    REQUIRE(reset.serial_data == fresh.serial_data);
+    REQUIRE(reset.mbc.ram_enable == fresh.mbc.ram_enable);
+    REQUIRE(reset.mbc.rom_bank == fresh.mbc.rom_bank);
+    REQUIRE(reset.mbc.ram_bank == fresh.mbc.ram_bank);
+    REQUIRE(reset.mbc.ram_banking == fresh.mbc.ram_banking);
+    REQUIRE(reset.mbc.ram == fresh.mbc.ram);
+    REQUIRE(cpu.memory().read(0x4000) == program.rom()[0x4000]);
+  }
+
+  SECTION("Through a boot ROM, run once for every copy of the program") {
+    // Sets A and SP, then unmaps itself and falls through into the cartridge
+    Bytes bootrom(0x100, 0x00);
+    Bytes code{0x31, 0xFE, 0xFF, 0x3E, 0x2A, 0xE0, 0x50};
+    copy(code.begin(), code.end(), bootrom.begin());
+    Program program{Bytes(0x8000, 0x00), bootrom};
+
+    CPU cpu{window, program};
+    REQUIRE_FALSE(cpu.memory().booting());
+    REQUIRE(cpu.registers().pc == 0x0007);
+    REQUIRE(cpu.registers().a == 0x2A);
+    REQUIRE(cpu.registers().sp == 0xFFFE);
+
+    Program copied = program;
+    CPU other{window, copied};
+    REQUIRE(memcmp(&other.memory().machine(), &cpu.memory().machine(),
+                   sizeof(MachineState)) == 0);
+  }
+}
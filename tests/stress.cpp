@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include <memory>
+#include <set>
+
+#include "CPU.h"
+#include "Program.h"
+#include "Window.h"
+#include "support/RomBuilder.h"
+
+using namespace gb;
+using namespace std;
+
+namespace {
+
+void runFrames(CPU& cpu, int frames) {
+  for (int i = 0; i < frames; i++) {
+    cpu.cycle();
+  }
+}
+
+// Runs through the setup, which fills VRAM with the LCD off
+void warmUp(CPU& cpu) {
+  while (cpu.memory().read(0xFF40) != 0x93) {
+    cpu.cycle();
+  }
+  runFrames(cpu, 2);
+}
+
+}  // namespace
+
+TEST_CASE("Stress ROMs keep their subsystem busy", "[stress]") {
+  Window window;
+
+  SECTION("Sprites are in OAM, ten to a line") {
+    auto program = stress::sprites();
+    CPU cpu{window, *program};
+    warmUp(cpu);
+    const auto& sat = cpu.memory().sat();
+    for (int i = 0; i < 40; i++) {
+      REQUIRE(sat[i * 4] == 16 + (i / 10) * 36);
+      REQUIRE(sat[i * 4 + 2] == i);
+    }
+  }
+
+  SECTION("OAM DMA moves every sprite once a frame") {
+    auto program = stress::oamDma();
+    CPU cpu{window, *program};
+    warmUp(cpu);
+    Byte x = cpu.memory().sat()[1];
+    runFrames(cpu, 10);
+    REQUIRE(cpu.memory().sat()[1] == static_cast<Byte>(x + 10));
+    REQUIRE(cpu.memory().sat()[39 * 4 + 1] ==
+            static_cast<Byte>(cpu.memory().read(0xC100 + 39 * 4 + 1) - 1));
+  }
+
+  SECTION("The timer interrupt fires as often as it can be served") {
+    auto program = stress::timerInterrupt();
+    CPU cpu{window, *program};
+    runFrames(cpu, 10);
+    CPU::Registers registers = cpu.registers();
+    int count = (registers.d << 8) | registers.e;
+    // Dispatch, INC DE and RETI take 36 clocks per interrupt
+    REQUIRE(count > 10 * 70224 / 40);
+    REQUIRE(count < 10 * 70224 / 32);
+  }
+
+  SECTION("Every upper bank of the cartridge gets mapped in turn") {
+    auto program = stress::bankSwitching();
+    CPU cpu{window, *program};
+    set<Word> banks;
+    for (int i = 0; i < 2000; i++) {
+      cpu.step();
+      Word bank = cpu.memory().mbc().romBank(0x4000);
+      REQUIRE(cpu.memory().read(0x4000) == bank);
+      banks.insert(bank);
+    }
+    REQUIRE(banks.size() == 31);
+    REQUIRE(cpu.memory().read(0xC000) != 0);
+  }
+
+  SECTION("Polling LY sees every frame") {
+    auto program = stress::lyPolling();
+    CPU cpu{window, *program};
+    runFrames(cpu, 20);
+    int frames = cpu.memory().read(0xC000);
+    REQUIRE(frames >= 19);
+    REQUIRE(frames <= 21);
+  }
+}
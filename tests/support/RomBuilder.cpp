@@ -0,0 +1,204 @@
+#include "RomBuilder.h"
+
+#include <algorithm>
+
+namespace gb {
+
+RomBuilder::RomBuilder(Byte type, int banks, Byte ram_size)
+    : rom_(banks * 0x4000, 0), at_(Program::header_end) {
+  // The entry point jumps over the header
+  Bytes entry{0x00, 0xC3, 0x50, 0x01};
+  std::copy(entry.begin(), entry.end(), rom_.begin() + 0x0100);
+  Byte size = 0;
+  while ((2 << size) < banks) {
+    size++;
+  }
+  rom_[0x0147] = type;
+  rom_[0x0148] = size;
+  rom_[0x0149] = ram_size;
+}
+
+RomBuilder& RomBuilder::org(std::size_t offset) {
+  at_ = offset;
+  return *this;
+}
+
+Word RomBuilder::here() const {
+  return at_ < 0x4000 ? at_ : 0x4000 + at_ % 0x4000;
+}
+
+RomBuilder& RomBuilder::emit(std::initializer_list<Byte> bytes) {
+  std::copy(bytes.begin(), bytes.end(), rom_.begin() + at_);
+  at_ += bytes.size();
+  return *this;
+}
+
+RomBuilder& RomBuilder::emit(const Bytes& bytes) {
+  std::copy(bytes.begin(), bytes.end(), rom_.begin() + at_);
+  at_ += bytes.size();
+  return *this;
+}
+
+RomBuilder& RomBuilder::emitWord(Word word) {
+  return emit({static_cast<Byte>(word & 0xFF), static_cast<Byte>(word >> 8)});
+}
+
+RomBuilder& RomBuilder::jumpRelative(Byte opcode, Word target) {
+  int offset = target - (here() + 2);
+  return emit({opcode, static_cast<Byte>(offset)});
+}
+
+std::shared_ptr<Program> RomBuilder::program() const {
+  return std::make_shared<Program>(rom_);
+}
+
+namespace stress {
+
+namespace {
+
+const Word dma_routine = 0xFF80;
+const Byte sprite_page = 0x41;
+
+// Interrupts off and the stack at the top of HRAM
+void start(RomBuilder& rom) { rom.emit({0xF3, 0x31}).emitWord(0xFFFE); }
+
+// Enables the interrupts in `enable` and halts until each of them forever
+void haltLoop(RomBuilder& rom, Byte enable) {
+  rom.emit({0x3E, enable, 0xE0, 0xFF, 0xFB});
+  Word loop = rom.here();
+  rom.emit({0x76});
+  rom.jumpRelative(0x18, loop);
+}
+
+// Copies a routine to HRAM that starts a DMA from the page in A and waits
+// the 160 M-cycles it takes there, as the rest of the bus is off limits.
+void installDma(RomBuilder& rom) {
+  Bytes routine{0xE0, 0x46, 0x3E, 0x28, 0x3D, 0x20, 0xFD, 0xC9};
+  Word code = rom.here();
+  rom.org(0x3F00).emit(routine).org(code);
+
+  rom.emit({0x21}).emitWord(0x3F00);
+  rom.emit({0x0E, dma_routine & 0xFF, 0x06, static_cast<Byte>(routine.size())});
+  Word copy = rom.here();
+  rom.emit({0x2A, 0xE2, 0x0C, 0x05});
+  rom.jumpRelative(0x20, copy);
+}
+
+// Turns the LCD off, fills the tiles and maps with a pattern and puts the
+// sprite table in ROM at sprite_page. Ends with the DMA routine installed.
+void spriteScene(RomBuilder& rom) {
+  Bytes& data = rom.data();
+  for (int i = 0; i < 40; i++) {
+    // Four rows of ten sprites, eight lines high each
+    std::size_t sprite = sprite_page * 0x100 + i * 4;
+    data[sprite + 0] = 16 + (i / 10) * 36;
+    data[sprite + 1] = 8 + (i % 10) * 16;
+    data[sprite + 2] = i;
+    data[sprite + 3] = (i & 3) << 5;
+  }
+
+  start(rom);
+  rom.emit({0xAF, 0xE0, 0x40});
+  rom.emit({0x21, 0x00, 0x80, 0x01, 0x00, 0x20});
+  Word fill = rom.here();
+  rom.emit({0x7D, 0x22, 0x0B, 0x78, 0xB1});
+  rom.jumpRelative(0x20, fill);
+  installDma(rom);
+}
+
+void lcdOn(RomBuilder& rom) {
+  // Background and 8x8 sprites from the tiles at 0x8000
+  rom.emit({0x3E, 0x93, 0xE0, 0x40});
+}
+
+}  // namespace
+
+std::shared_ptr<Program> loop(const Bytes& pattern) {
+  RomBuilder rom;
+  rom.emit({0x21, 0x00, 0xC0});
+  Word begin = rom.here();
+  while (rom.here() + pattern.size() < 0x3F00) {
+    rom.emit(pattern);
+  }
+  rom.emit({0xC3}).emitWord(begin);
+  rom.org(0x3F80).emit({0xC9});
+  return rom.program();
+}
+
+std::shared_ptr<Program> sprites() {
+  RomBuilder rom;
+  rom.org(0x40).emit({0xD9}).org(Program::header_end);
+  spriteScene(rom);
+  rom.emit({0x3E, sprite_page}).emit({0xCD}).emitWord(dma_routine);
+  lcdOn(rom);
+  haltLoop(rom, 0x01);
+  return rom.program();
+}
+
+std::shared_ptr<Program> oamDma() {
+  RomBuilder rom;
+  rom.org(0x40).emit({0xD9}).org(Program::header_end);
+  spriteScene(rom);
+  // The sprite table goes to 0xC100, where every frame moves it
+  rom.emit({0x21, 0x00, sprite_page, 0x11, 0x00, 0xC1, 0x06, 0xA0});
+  Word copy = rom.here();
+  rom.emit({0x2A, 0x12, 0x13, 0x05});
+  rom.jumpRelative(0x20, copy);
+  lcdOn(rom);
+
+  rom.emit({0x3E, 0x01, 0xE0, 0xFF, 0xFB});
+  Word frame = rom.here();
+  rom.emit({0x76, 0x3E, 0xC1, 0xCD}).emitWord(dma_routine);
+  rom.emit({0x21, 0x01, 0xC1, 0x06, 0x28});
+  Word move = rom.here();
+  rom.emit({0x34, 0x2C, 0x2C, 0x2C, 0x2C, 0x05});
+  rom.jumpRelative(0x20, move);
+  rom.jumpRelative(0x18, frame);
+  return rom.program();
+}
+
+std::shared_ptr<Program> timerInterrupt() {
+  RomBuilder rom;
+  rom.org(0x50).emit({0x13, 0xD9}).org(Program::header_end);
+  start(rom);
+  rom.emit({0x11, 0x00, 0x00});
+  rom.emit({0x3E, 0xFF, 0xE0, 0x06, 0xE0, 0x05});
+  rom.emit({0x3E, 0x05, 0xE0, 0x07});
+  haltLoop(rom, 0x04);
+  return rom.program();
+}
+
+std::shared_ptr<Program> bankSwitching() {
+  RomBuilder rom{0x01, 32};
+  for (int bank = 1; bank < 32; bank++) {
+    rom.data()[bank * 0x4000] = bank;
+  }
+  start(rom);
+  rom.emit({0x06, 0x01});
+  Word loop = rom.here();
+  rom.emit({0x78, 0xEA, 0x00, 0x20, 0xFA, 0x00, 0x40, 0xEA, 0x00, 0xC0});
+  rom.emit({0x04, 0x78, 0xFE, 0x20});
+  rom.jumpRelative(0x20, loop);
+  rom.emit({0x06, 0x01});
+  rom.jumpRelative(0x18, loop);
+  return rom.program();
+}
+
+std::shared_ptr<Program> lyPolling() {
+  RomBuilder rom;
+  start(rom);
+  rom.emit({0x21, 0x00, 0xC0, 0x36, 0x00});
+  Word wait = rom.here();
+  rom.emit({0xF0, 0x44, 0xFE, 0x90});
+  rom.jumpRelative(0x20, wait);
+  rom.emit({0x34});
+  Word leave = rom.here();
+  rom.emit({0xF0, 0x44, 0xFE, 0x90});
+  rom.jumpRelative(0x28, leave);
+  rom.jumpRelative(0x18, wait);
+  return rom.program();
+}
+
+}  // namespace stress
+
+}  // namespace gb
@@ -0,0 +1,65 @@
+#ifndef GEEBEE_TESTS_SUPPORT_ROMBUILDER_H
+#define GEEBEE_TESTS_SUPPORT_ROMBUILDER_H
+
+#include <initializer_list>
+#include <memory>
+
+#include "Program.h"
+#include "types.h"
+
+namespace gb {
+
+// Assembles small cartridge images in memory. Code is emitted as raw
+// opcodes at a write position that starts right after the header, where
+// the entry point jumps to.
+class RomBuilder {
+ public:
+  // A cartridge of MBC `type` with `banks` banks of 16KB.
+  explicit RomBuilder(Byte type = 0x00, int banks = 2, Byte ram_size = 0x00);
+  ~RomBuilder() = default;
+
+  // Moves the write position to the ROM offset `offset`.
+  RomBuilder& org(std::size_t offset);
+  // The address the CPU sees the write position at, in bank 0 or 1.
+  Word here() const;
+
+  RomBuilder& emit(std::initializer_list<Byte> bytes);
+  RomBuilder& emit(const Bytes& bytes);
+  RomBuilder& emitWord(Word word);
+  // A relative jump, JR with `opcode` 0x18 or one of its conditional forms,
+  // back or forth to `target`.
+  RomBuilder& jumpRelative(Byte opcode, Word target);
+
+  Bytes& data() { return rom_; }
+  std::shared_ptr<Program> program() const;
+
+ private:
+  Bytes rom_;
+  std::size_t at_;
+};
+
+// Purpose-built programs that each keep one part of the machine busy, for
+// benchmarks and tests that need it in isolation.
+namespace stress {
+
+// Repeats `pattern` from 0x0150 on and jumps back at the end, with HL
+// pointing to work RAM. A subroutine that only returns is at 0x3F80.
+std::shared_ptr<Program> loop(const Bytes& pattern);
+// 40 sprites on screen, ten on every line they cover, while the CPU halts.
+std::shared_ptr<Program> sprites();
+// The sprites of sprites(), all moved and copied by OAM DMA every frame.
+std::shared_ptr<Program> oamDma();
+// TIMA at the fastest clock and reloading to 0xFF, so the timer interrupt
+// is always pending. The handler counts interrupts in DE.
+std::shared_ptr<Program> timerInterrupt();
+// Switches through the 31 upper banks of an MBC1 cartridge, one per few
+// instructions, and copies the number every bank starts with to 0xC000.
+std::shared_ptr<Program> bankSwitching();
+// Polls LY for the start of VBlank and counts frames at 0xC000.
+std::shared_ptr<Program> lyPolling();
+
+}  // namespace stress
+
+}  // namespace gb
+
+#endif
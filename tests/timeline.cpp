@@ -0,0 +1,63 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include "Timeline.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+size_t occurrences(const string& text, const string& pattern) {
+  size_t count = 0;
+  for (size_t at = text.find(pattern); at != string::npos;
+       at = text.find(pattern, at + 1)) {
+    count++;
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST_CASE("Timeline exports the spans of every thread", "[timeline]") {
+  Timeline timeline;
+  REQUIRE_FALSE(timeline.recording());
+  timeline.start();
+  REQUIRE(timeline.recording());
+
+  uint64_t begin = Timeline::ticks();
+  {
+    Timeline::Scope scope{Timeline::Dispatch};
+  }
+  timeline.span("frame", begin);
+  thread other{[&timeline]() {
+    uint64_t begin = Timeline::ticks();
+    this_thread::sleep_for(chrono::milliseconds(20));
+    timeline.span("frame", begin);
+  }};
+  other.join();
+  REQUIRE(timeline.size() == 2);
+
+  fs::path path = fs::temp_directory_path() / fs::unique_path();
+  REQUIRE(timeline.writeChromeTrace(path.string()));
+  ifstream file{path.string()};
+  string json{istreambuf_iterator<char>{file}, istreambuf_iterator<char>{}};
+  fs::remove(path);
+
+  REQUIRE(json.find("\"traceEvents\"") != string::npos);
+  REQUIRE(occurrences(json, "\"ph\":\"X\"") == 2);
+  REQUIRE(occurrences(json, "\"dispatch_us\"") == 2);
+  // Only the sleeping frame took longer than a hardware frame
+  REQUIRE(occurrences(json, "\"long frame\"") == 1);
+
+  timeline.start();
+  REQUIRE(timeline.size() == 0);
+}
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "CPU.h"
+#include "Program.h"
+#include "Trace.h"
+#include "Window.h"
+
+using namespace gb;
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace {
+
+TraceRecord instruction(Word pc) {
+  TraceRecord record{};
+  record.pc = pc;
+  record.cycle = pc * 4;
+  return record;
+}
+
+}  // namespace
+
+TEST_CASE("Trace ring keeps the newest instructions", "[trace]") {
+  TraceRing ring{5};
+  REQUIRE(ring.capacity() == 8);
+  for (Word pc = 0; pc < 20; pc++) {
+    ring.record(instruction(pc));
+  }
+  REQUIRE(ring.recorded() == 20);
+  REQUIRE(ring.size() == 8);
+  REQUIRE(ring[0].pc == 12);
+  REQUIRE(ring[7].pc == 19);
+
+  SECTION("Saved traces load oldest first") {
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    REQUIRE(ring.save(path.string()));
+    vector<TraceRecord> records;
+    REQUIRE(TraceRing::load(path.string(), records));
+    REQUIRE(records.size() == 8);
+    for (size_t i = 0; i < records.size(); i++) {
+      REQUIRE(records[i].pc == 12 + i);
+      REQUIRE(records[i].cycle == records[i].pc * 4);
+    }
+    fs::remove(path);
+  }
+
+  SECTION("Traces with fewer records than counted do not load") {
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    REQUIRE(ring.save(path.string()));
+    vector<TraceRecord> records;
+    fs::resize_file(path, fs::file_size(path) - 1);
+    REQUIRE_FALSE(TraceRing::load(path.string(), records));
+
+    // A count far beyond the file, right after magic, version and size
+    {
+      fstream file{path.string(), ios::in | ios::out | ios::binary};
+      file.seekp(12);
+      uint64_t count = uint64_t{1} << 60;
+      file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    REQUIRE_FALSE(TraceRing::load(path.string(), records));
+    REQUIRE(records.empty());
+    fs::remove(path);
+  }
+
+  SECTION("Instructions are described with or without prefix") {
+    REQUIRE(CPU::describe(0x00, 0x37) == "NOP");
+    REQUIRE(CPU::describe(0xCB, 0x37) == "SWAP A");
+  }
+}
+
+#ifdef GEEBEE_TRACE
+TEST_CASE("Traced machines record every instruction", "[trace]") {
+  Program program{"roms/cpu_instrs.gb"};
+  REQUIRE(program.is_valid());
+  Window window;
+  CPU cpu{window, program};
+  cpu.tracer().setCapacity(1 << 16);
+  cpu.cycle();
+
+  const TraceRing& ring = cpu.tracer();
+  REQUIRE(ring.recorded() > 1000);
+  REQUIRE(ring[0].pc == 0x0100);
+  REQUIRE(ring[0].bank == 0);
+  REQUIRE(ring[0].a == 0x01);
+  for (size_t i = 1; i < ring.size(); i++) {
+    REQUIRE(ring[i].cycle > ring[i - 1].cycle);
+  }
+}
+#endif
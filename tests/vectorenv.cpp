@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "CPU.h"
+#include "Program.h"
+#include "VectorEnv.h"
+
+using namespace gb;
+using namespace std;
+
+TEST_CASE("Vectorised environments write observations in place",
+          "[vectorenv]") {
+  auto program = make_shared<Program>("roms/instr_timing.gb");
+  REQUIRE(program->is_valid());
+
+  auto passed = [](CPU& cpu) {
+    return cpu.memory().serial_data().find("Passed") != string::npos;
+  };
+  VectorEnv env{program, 4, {0xFF44, 0xFF40}, passed, 2};
+
+  Bytes actions(env.size(), 0);
+  Bytes frames(env.size() * VectorEnv::frame_size, 0);
+  Bytes ram(env.size() * env.ram_addresses().size(), 0);
+  Bytes done(env.size(), 0);
+  Bytes error(env.size(), 0);
+  VectorEnv::Observations out{frames.data(), ram.data(), done.data(),
+                              error.data()};
+
+  SECTION("Every machine renders into its own frame") {
+    env.stepBatch(actions.data(), 4, out);
+
+    for (size_t i = 0; i < env.size(); i++) {
+      auto begin = frames.begin() + i * VectorEnv::frame_size;
+      auto end = begin + VectorEnv::frame_size;
+      REQUIRE(any_of(begin, end, [](Byte pixel) { return pixel != 0; }));
+      // The frame ends at the start of VBlank, with LCD enabled
+      REQUIRE(ram[i * 2] == 144);
+      REQUIRE(ram[i * 2 + 1] & 0x80);
+      REQUIRE(done[i] == 0);
+      REQUIRE(error[i] == 0);
+    }
+  }
+
+  SECTION("A machine that fails ends its episode and the others run on") {
+    // Jump into an invalid opcode in work RAM
+    CPU::State state;
+    env.machine(1).save(state);
+    state.machine.memory.ram[0] = 0xD3;
+    state.machine.cpu.pc = 0xC000;
+    env.machine(1).load(state);
+
+    env.stepBatch(actions.data(), 4, out);
+    for (size_t i = 0; i < env.size(); i++) {
+      REQUIRE(done[i] == (i == 1));
+      REQUIRE(error[i] == (i == 1));
+    }
+    REQUIRE(env.error(1) == "Invalid opcode");
+    REQUIRE(env.error(0).empty());
+
+    env.stepBatch(actions.data(), 4, out);
+    REQUIRE(error[1] == 0);
+    REQUIRE(ram[1 * 2] == ram[0]);
+  }
+
+  SECTION("Finished episodes are flagged and restarted") {
+    int steps = 0;
+    while (done[0] == 0 && steps < 100) {
+      fill(frames.begin(), frames.end(), 0);
+      env.stepBatch(actions.data(), 5, out);
+      steps++;
+    }
+
+    REQUIRE(all_of(done.begin(), done.end(), [](Byte d) { return d == 1; }));
+    // The episode ends before the last frame of the step, and the frame it
+    // ended on is still the observation
+    REQUIRE(any_of(frames.begin(), frames.begin() + VectorEnv::frame_size,
+                   [](Byte pixel) { return pixel != 0; }));
+    REQUIRE(env.machine(0).memory().serial_data().empty());
+  }
+}